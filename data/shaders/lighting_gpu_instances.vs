@@ -0,0 +1,43 @@
+#version 430
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec3 vertexNormal;
+
+// Instances appended by instance_list.comp: position in xyz, neighbor count in w
+layout(std430, binding = 1) readonly buffer Instances
+{
+    vec4 instances[];
+};
+
+// Input uniform values
+uniform mat4 mvp;
+uniform vec4 neighborColors[15];
+uniform int capacity;
+
+// Output vertex attributes (to fragment shader)
+out vec3 fragPosition;
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out vec3 fragNormal;
+
+void main()
+{
+    // The compute pass keeps counting past a full buffer; those instances were never written
+    if (gl_InstanceID >= capacity)
+    {
+        gl_Position = vec4(0.0);
+        return;
+    }
+
+    vec4 instance = instances[gl_InstanceID];
+
+    // Instances are translations only, so normals need no transform
+    fragPosition = instance.xyz + vertexPosition;
+    fragTexCoord = vertexTexCoord;
+    fragColor = neighborColors[int(instance.w)];
+    fragNormal = normalize(vertexNormal);
+
+    gl_Position = mvp*vec4(fragPosition, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec3 vertexNormal;
+
+// Where this instance sits; cells are only ever translated, so this replaces a full instance matrix. Placed past
+// raylib's default attribute locations so it never lands on one the mesh's vertex array already uses.
+layout(location = 10) in vec3 instanceOffset;
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec3 fragPosition;
+out vec3 fragNormal;
+
+void main()
+{
+    // A translation leaves normals as they are, so no normal matrix is needed
+    fragPosition = vertexPosition + instanceOffset;
+    fragNormal = vertexNormal;
+
+    gl_Position = mvp*vec4(fragPosition, 1.0);
+}
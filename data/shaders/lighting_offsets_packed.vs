@@ -0,0 +1,40 @@
+#version 330
+
+// lighting_offsets.vs for MeshGenerator::genPackedTruncatedOctahedron's vertices
+
+// Input vertex attributes: int16 positions in multiples of sqrt(2), and normals octahedral-encoded as two signed
+// normalized int16s
+in vec3 vertexPosition;
+in vec2 vertexNormal;
+
+// Where this instance sits. Placed past raylib's default attribute locations so it never lands on one the mesh's
+// vertex array already uses.
+layout(location = 10) in vec3 instanceOffset;
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec3 fragPosition;
+out vec3 fragNormal;
+
+const float POSITION_UNIT = 1.41421356; // TruncatedOctahedron::UNIT
+
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0)
+    {
+        vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+        normal.xy = (1.0 - abs(normal.yx))*signs;
+    }
+    return normalize(normal);
+}
+
+void main()
+{
+    fragPosition = vertexPosition*POSITION_UNIT + instanceOffset;
+    fragNormal = decodeOctahedral(vertexNormal);
+
+    gl_Position = mvp*vec4(fragPosition, 1.0);
+}
@@ -0,0 +1,242 @@
+#version 330
+
+// Ray-marches the lattice uploaded by VolumeRenderer.h. Each ray walks the truncated octahedra it passes through,
+// leaving a cell through the face it hits first, until it enters an occupied site. Sites and layers follow
+// OctahedronGrid: site (x, y, z) sits at (x, y/2, z) site spacings, half a spacing further along x and z on odd
+// layers.
+
+// Input vertex attributes (from vertex shader)
+in vec3 fragPosition;
+
+// Input uniform values
+// One 64x64 tile per 16x16x16 brick, layer ly of the brick in slice (ly & 3, ly >> 2) of the tile. 0 for an empty
+// site, 1 + its neighbor count for an occupied one.
+uniform sampler2D sites;
+// One texel per brick, the largest value among its sites
+uniform sampler2D bricks;
+// firstColumn, length (x), width (z), height (y) in sites
+uniform ivec4 gridLayout;
+uniform ivec3 brickCounts;
+uniform int tilesPerRow;
+uniform float siteSpacing;
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+uniform vec4 neighborColors[15];
+uniform mat4 mvp;
+
+// Output fragment color
+out vec4 finalColor;
+
+#define     MAX_LIGHTS              4
+#define     LIGHT_DIRECTIONAL       0
+#define     LIGHT_POINT             1
+
+struct Light {
+    int enabled;
+    int type;
+    vec3 position;
+    vec3 target;
+    vec4 color;
+};
+
+// Input lighting values
+uniform Light lights[MAX_LIGHTS];
+uniform vec4 ambient;
+uniform vec3 viewPos;
+
+// Enough for a ray across the largest atlas with every brick on the way skipped
+#define     MAX_STEPS               4096
+
+// Offsets to the 14 cells sharing a face, in site spacings: 6 square faces, then 8 hexagonal ones on the diagonals
+const vec3 FACE_OFFSETS[14] = vec3[14](
+    vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0),
+    vec3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0),
+    vec3(0.5, 0.5, 0.5), vec3(-0.5, 0.5, 0.5), vec3(0.5, 0.5, -0.5), vec3(-0.5, 0.5, -0.5),
+    vec3(0.5, -0.5, 0.5), vec3(-0.5, -0.5, 0.5), vec3(0.5, -0.5, -0.5), vec3(-0.5, -0.5, -0.5)
+);
+
+// A cell's corners reach sqrt(5)/4 site spacings from its center
+const float CELL_REACH = 0.56;
+
+vec3 siteCenter(ivec3 site)
+{
+    float odd = float(site.y & 1);
+    return vec3(float(site.x) + 0.5*odd, 0.5*float(site.y), float(site.z) + 0.5*odd)*siteSpacing;
+}
+
+// The site whose cell contains p: the nearer of the closest even-layer and the closest odd-layer site
+ivec3 siteAt(vec3 p)
+{
+    vec3 q = p/siteSpacing;
+    ivec3 even = ivec3(int(round(q.x)), 2*int(round(q.y)), int(round(q.z)));
+    vec3 below = floor(q);
+    ivec3 odd = ivec3(int(below.x), 2*int(below.y) + 1, int(below.z));
+    return distance(p, siteCenter(even)) <= distance(p, siteCenter(odd)) ? even : odd;
+}
+
+// The neighbor across face; diagonal neighbors sit half a site towards -x and -z from even layers, +x and +z from odd
+ivec3 neighborAcross(ivec3 site, int face)
+{
+    vec3 offset = FACE_OFFSETS[face];
+    if (face < 6) return site + ivec3(int(offset.x), 2*int(offset.y), int(offset.z));
+    int odd = site.y & 1;
+    return site + ivec3(offset.x > 0.0 ? odd : odd - 1, offset.y > 0.0 ? 1 : -1, offset.z > 0.0 ? odd : odd - 1);
+}
+
+bool inGrid(ivec3 site)
+{
+    return site.x >= gridLayout.x && site.x < gridLayout.x + gridLayout.y && site.y >= 0 && site.y < gridLayout.w &&
+           site.z >= 0 && site.z < gridLayout.z;
+}
+
+ivec3 brickOf(ivec3 site)
+{
+    return ivec3(site.x - gridLayout.x, site.y, site.z) >> 4;
+}
+
+int brickIndex(ivec3 brick)
+{
+    return (brick.y*brickCounts.z + brick.z)*brickCounts.x + brick.x;
+}
+
+ivec2 tileTexel(int brick)
+{
+    return ivec2(brick % tilesPerRow, brick/tilesPerRow);
+}
+
+int siteValue(ivec3 site, int brick)
+{
+    ivec3 local = ivec3(site.x - gridLayout.x, site.y, site.z) & 15;
+    ivec2 texel = tileTexel(brick)*64 + ivec2((local.y & 3)*16 + local.x, (local.y >> 2)*16 + local.z);
+    return int(texelFetch(sites, texel, 0).r*255.0 + 0.5);
+}
+
+bool isBrickEmpty(int brick)
+{
+    return texelFetch(bricks, tileTexel(brick), 0).r == 0.0;
+}
+
+// Entry and exit distances of the ray through a box; entry past exit when it misses
+vec2 intersectBox(vec3 origin, vec3 direction, vec3 low, vec3 high)
+{
+    vec3 reciprocal = 1.0/direction;
+    vec3 t0 = (low - origin)*reciprocal;
+    vec3 t1 = (high - origin)*reciprocal;
+    vec3 entries = min(t0, t1);
+    vec3 exits = max(t0, t1);
+    return vec2(max(max(entries.x, entries.y), entries.z), min(min(exits.x, exits.y), exits.z));
+}
+
+// Within this box every point's cell belongs to the brick: it keeps a cell's reach away from every other brick's sites
+vec2 intersectBrickInterior(vec3 origin, vec3 direction, ivec3 brick)
+{
+    vec3 first = vec3(float(gridLayout.x + brick.x*16), 0.5*float(brick.y*16), float(brick.z*16));
+    vec3 low = (first + vec3(-0.5, -0.5, -0.5) + CELL_REACH)*siteSpacing;
+    vec3 high = (first + vec3(16.0, 8.0, 16.0) - CELL_REACH)*siteSpacing;
+    return intersectBox(origin, direction, low, high);
+}
+
+vec4 shade(vec3 position, vec3 normal, vec4 tint)
+{
+    vec3 lightDot = vec3(0.0);
+    vec3 viewD = normalize(viewPos - position);
+    vec3 specular = vec3(0.0);
+
+    for (int i = 0; i < MAX_LIGHTS; i++)
+    {
+        if (lights[i].enabled == 1)
+        {
+            vec3 light = vec3(0.0);
+
+            if (lights[i].type == LIGHT_DIRECTIONAL)
+            {
+                light = -normalize(lights[i].target - lights[i].position);
+            }
+
+            if (lights[i].type == LIGHT_POINT)
+            {
+                light = normalize(lights[i].position - position);
+            }
+
+            float NdotL = max(dot(normal, light), 0.0);
+            lightDot += lights[i].color.rgb*NdotL;
+
+            float specCo = 0.0;
+            if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0); // 16 refers to shine
+            specular += specCo;
+        }
+    }
+
+    vec4 color = (tint + vec4(specular, 1.0))*vec4(lightDot, 1.0);
+    color += (ambient/10.0)*tint;
+
+    // Gamma correction
+    return pow(color, vec4(1.0/2.2));
+}
+
+void main()
+{
+    vec3 origin = viewPos;
+    vec3 direction = normalize(fragPosition - viewPos);
+    vec2 span = intersectBox(origin, direction, boxMin, boxMax);
+    float t = max(span.x, 0.0);
+    if (t >= span.y) discard;
+
+    ivec3 site = siteAt(origin + direction*t);
+    // Only seen when the camera starts inside a cell; every other hit comes through a face
+    vec3 normal = -direction;
+
+    for (int steps = 0; steps < MAX_STEPS && t <= span.y; steps++)
+    {
+        if (inGrid(site))
+        {
+            ivec3 brick = brickOf(site);
+            int index = brickIndex(brick);
+            if (isBrickEmpty(index))
+            {
+                // Jump to where the ray leaves the brick's interior, then walk out of its last cells
+                vec2 interior = intersectBrickInterior(origin, direction, brick);
+                if (t >= interior.x && interior.y > t + 0.01*siteSpacing)
+                {
+                    t = interior.y;
+                    site = siteAt(origin + direction*t);
+                    continue;
+                }
+            }
+            else
+            {
+                int value = siteValue(site, index);
+                if (value > 0)
+                {
+                    vec3 position = origin + direction*t;
+                    finalColor = shade(position, normal, neighborColors[min(value - 1, 14)]);
+                    vec4 clip = mvp*vec4(position, 1.0);
+                    gl_FragDepth = 0.5*(clip.z/clip.w) + 0.5;
+                    return;
+                }
+            }
+        }
+
+        // Leave through the face the ray reaches first: the plane halfway to that neighbor
+        vec3 toOrigin = origin - siteCenter(site);
+        float exit = 1e30;
+        int face = 0;
+        for (int i = 0; i < 14; i++)
+        {
+            vec3 offset = FACE_OFFSETS[i]*siteSpacing;
+            float along = dot(direction, offset);
+            if (along <= 0.0) continue;
+            float reach = (0.5*dot(offset, offset) - dot(toOrigin, offset))/along;
+            if (reach < exit)
+            {
+                exit = reach;
+                face = i;
+            }
+        }
+        t = max(t, exit);
+        site = neighborAcross(site, face);
+        normal = -normalize(FACE_OFFSETS[face]);
+    }
+
+    discard;
+}
@@ -0,0 +1,19 @@
+#version 330
+
+// Input vertex attributes: a unit cube centered on the origin
+in vec3 vertexPosition;
+
+// Input uniform values
+uniform mat4 mvp;
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+
+// Output vertex attributes (to fragment shader)
+out vec3 fragPosition;
+
+void main()
+{
+    // Stretch the cube over the lattice's box; mvp is the view-projection, the box is already in world space
+    fragPosition = mix(boxMin, boxMax, vertexPosition + 0.5);
+    gl_Position = mvp*vec4(fragPosition, 1.0);
+}
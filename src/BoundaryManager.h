@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include "raylib.h"
+#include "BoundaryShapes.h"
 
 class RectangleBoundary {
 public:
@@ -68,6 +71,16 @@ private:
     bool isResizable;
 };
 
+// Shapes that can be fitted to the resizable rectangle from the GUI. Custom covers anything set directly through
+// setCustomShape, such as an imported voxel mask.
+enum class BoundaryPreset {
+    Box,
+    RoundWell,
+    HangingDrop,
+    Channel,
+    Custom
+};
+
 class BoundaryManager {
 public:
     BoundaryManager()
@@ -90,13 +103,51 @@ public:
             return true;
         }
 
-        return boundary->contains(point);
+        return shape ? shape->contains(point) : boundary->contains(point);
     }
 
     void draw() const {
         if (boundary && showBoundary && boundaryEnabled) {
-            boundary->drawWireframe(boundaryColor);
+            if (shape) {
+                shape->drawWireframe(boundaryColor);
+            } else {
+                boundary->drawWireframe(boundaryColor);
+            }
+        }
+    }
+
+    void setBoundaryPreset(const BoundaryPreset newPreset) {
+        if (!boundary || !boundary->canResize() || newPreset == BoundaryPreset::Custom) return;
+        preset = newPreset;
+        fitPresetShape();
+    }
+
+    [[nodiscard]] BoundaryPreset getBoundaryPreset() const {
+        return preset;
+    }
+
+    // Replaces the boundary with an arbitrary shape. The rectangle is kept for the GUI dimensions, but containment
+    // and the lattice mask come from the shape.
+    void setCustomShape(std::shared_ptr<const BoundaryShape> customShape) {
+        if (!boundary || !boundary->canResize() || !customShape) return;
+        preset = BoundaryPreset::Custom;
+        shape = std::move(customShape);
+        revision++;
+    }
+
+    // Region the lattice has to cover: the shape's bounds, or the rectangle when no shape is set
+    [[nodiscard]] BoundingBox getBounds() const {
+        if (shape) {
+            return shape->getBounds();
         }
+        const Vector3 center = getBoundaryCenter();
+        const float width = getBoundaryWidth();
+        const float depth = getBoundaryDepth();
+        const float height = getBoundaryHeight();
+        return {
+            {center.x - width / 2, center.y - height / 2, center.z - depth / 2},
+            {center.x + width / 2, center.y + height / 2, center.z + depth / 2}
+        };
     }
 
     void toggleVisibility() {
@@ -104,11 +155,18 @@ public:
     }
 
     void setBoundaryEnabled(const bool enabled) {
+        if (enabled != boundaryEnabled) revision++;
         boundaryEnabled = enabled;
     }
 
     void toggleBoundaryEnabled() {
         boundaryEnabled = !boundaryEnabled;
+        revision++;
+    }
+
+    // Bumped whenever the region the boundary admits may have changed, so dependents can cache against it
+    [[nodiscard]] uint64_t getRevision() const {
+        return revision;
     }
 
     [[nodiscard]] bool isBoundaryEnabled() const {
@@ -131,6 +189,7 @@ public:
                 boundary->getDepth(),
                 boundary->getHeight()
             );
+            fitPresetShape();
         }
     }
     
@@ -142,6 +201,7 @@ public:
                 depth,
                 boundary->getHeight()
             );
+            fitPresetShape();
         }
     }
     
@@ -153,10 +213,23 @@ public:
                 boundary->getDepth(),
                 height
             );
+            fitPresetShape();
+        }
+    }
+
+    void setBoundaryCenter(const Vector3 &center) {
+        if (boundary && boundary->canResize()) {
+            boundary = std::make_shared<RectangleBoundary>(
+                center,
+                boundary->getWidth(),
+                boundary->getDepth(),
+                boundary->getHeight()
+            );
+            fitPresetShape();
         }
     }
 
-    void handleResizing() const {
+    void handleResizing() {
         if (!boundary || !boundary->canResize()) return;
         const bool right = IsKeyDown(KEY_RIGHT);
         const bool left = IsKeyDown(KEY_LEFT);
@@ -165,6 +238,7 @@ public:
 
         if (right || left || up || down) {
             boundary->resize(right, left, up, down);
+            fitPresetShape();
         }
     }
 
@@ -191,7 +265,48 @@ public:
     }
 
 private:
+    // Rebuilds the preset shape so it fills the current rectangle. Every change to the rectangle ends up here.
+    void fitPresetShape() {
+        revision++;
+        const Vector3 center = boundary->getCenter();
+        const float width = boundary->getWidth();
+        const float depth = boundary->getDepth();
+        const float height = boundary->getHeight();
+        const float radius = std::min(width, depth) / 2;
+        const auto box = std::make_shared<BoxShape>(center, width, depth, height);
+
+        switch (preset) {
+            case BoundaryPreset::Box:
+                shape = nullptr;
+                break;
+            case BoundaryPreset::RoundWell:
+                shape = std::make_shared<CylinderShape>(center, radius, height);
+                break;
+            case BoundaryPreset::HangingDrop: {
+                // Spherical cap whose rim spans the rectangle at the top and whose apex touches its floor
+                const float capRadius = (radius * radius + height * height) / (2 * height);
+                const Vector3 sphereCenter = {center.x, center.y - height / 2 + capRadius, center.z};
+                shape = std::make_shared<IntersectionShape>(std::make_shared<SphereShape>(sphereCenter, capRadius), box);
+                break;
+            }
+            case BoundaryPreset::Channel: {
+                // Flat channel with rounded ends running along the length of the rectangle
+                const float channelRadius = depth / 4;
+                const Vector3 start = {center.x - width / 2 + channelRadius, center.y, center.z};
+                const Vector3 end = {center.x + width / 2 - channelRadius, center.y, center.z};
+                shape = std::make_shared<IntersectionShape>(
+                    std::make_shared<CapsuleShape>(start, end, channelRadius), box);
+                break;
+            }
+            case BoundaryPreset::Custom:
+                break;
+        }
+    }
+
     std::shared_ptr<RectangleBoundary> boundary;
+    std::shared_ptr<const BoundaryShape> shape;
+    BoundaryPreset preset = BoundaryPreset::Box;
+    uint64_t revision = 0;
     bool showBoundary;
     bool boundaryEnabled;
     Color boundaryColor;
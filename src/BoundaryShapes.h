@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+// Boundary shapes described by signed distance functions: negative inside, positive outside. Shapes are only
+// evaluated when the boundary is baked into the lattice (and while previewing starting positions), never per spawn
+// attempt, so composing many primitives does not change the per-tick cost of the simulation.
+class BoundaryShape {
+public:
+    virtual ~BoundaryShape() = default;
+
+    [[nodiscard]] virtual float signedDistance(const Vector3 &point) const = 0;
+
+    [[nodiscard]] virtual BoundingBox getBounds() const = 0;
+
+    virtual void drawWireframe(const Color &color) const {
+        DrawBoundingBox(getBounds(), color);
+    }
+
+    [[nodiscard]] bool contains(const Vector3 &point) const {
+        return signedDistance(point) <= 0.0f;
+    }
+
+protected:
+    static float length(const float x, const float y) {
+        return sqrtf(x * x + y * y);
+    }
+
+    static float length(const float x, const float y, const float z) {
+        return sqrtf(x * x + y * y + z * z);
+    }
+};
+
+class BoxShape final : public BoundaryShape {
+public:
+    BoxShape(const Vector3 &center, const float width, const float depth, const float height)
+        : center(center), halfExtents{width / 2, height / 2, depth / 2} {
+    }
+
+    [[nodiscard]] float signedDistance(const Vector3 &point) const override {
+        const float qx = std::abs(point.x - center.x) - halfExtents.x;
+        const float qy = std::abs(point.y - center.y) - halfExtents.y;
+        const float qz = std::abs(point.z - center.z) - halfExtents.z;
+        const float outside = length(std::max(qx, 0.0f), std::max(qy, 0.0f), std::max(qz, 0.0f));
+        const float inside = std::min(std::max(qx, std::max(qy, qz)), 0.0f);
+        return outside + inside;
+    }
+
+    [[nodiscard]] BoundingBox getBounds() const override {
+        return {
+            {center.x - halfExtents.x, center.y - halfExtents.y, center.z - halfExtents.z},
+            {center.x + halfExtents.x, center.y + halfExtents.y, center.z + halfExtents.z}
+        };
+    }
+
+private:
+    Vector3 center;
+    Vector3 halfExtents;
+};
+
+class SphereShape final : public BoundaryShape {
+public:
+    SphereShape(const Vector3 &center, const float radius)
+        : center(center), radius(radius) {
+    }
+
+    [[nodiscard]] float signedDistance(const Vector3 &point) const override {
+        return length(point.x - center.x, point.y - center.y, point.z - center.z) - radius;
+    }
+
+    [[nodiscard]] BoundingBox getBounds() const override {
+        return {
+            {center.x - radius, center.y - radius, center.z - radius},
+            {center.x + radius, center.y + radius, center.z + radius}
+        };
+    }
+
+    void drawWireframe(const Color &color) const override {
+        DrawSphereWires(center, radius, 8, 16, color);
+    }
+
+private:
+    Vector3 center;
+    float radius;
+};
+
+// Upright cylinder (axis along y), the shape of a round well or a disc
+class CylinderShape final : public BoundaryShape {
+public:
+    CylinderShape(const Vector3 &center, const float radius, const float height)
+        : center(center), radius(radius), height(height) {
+    }
+
+    [[nodiscard]] float signedDistance(const Vector3 &point) const override {
+        const float dRadial = length(point.x - center.x, point.z - center.z) - radius;
+        const float dAxial = std::abs(point.y - center.y) - height / 2;
+        return std::min(std::max(dRadial, dAxial), 0.0f) + length(std::max(dRadial, 0.0f), std::max(dAxial, 0.0f));
+    }
+
+    [[nodiscard]] BoundingBox getBounds() const override {
+        return {
+            {center.x - radius, center.y - height / 2, center.z - radius},
+            {center.x + radius, center.y + height / 2, center.z + radius}
+        };
+    }
+
+    void drawWireframe(const Color &color) const override {
+        DrawCylinderWires({center.x, center.y - height / 2, center.z}, radius, radius, height, 32, color);
+    }
+
+private:
+    Vector3 center;
+    float radius;
+    float height;
+};
+
+// Segment from start to end swept by a sphere, e.g. a microfluidic channel
+class CapsuleShape final : public BoundaryShape {
+public:
+    CapsuleShape(const Vector3 &start, const Vector3 &end, const float radius)
+        : start(start), end(end), radius(radius) {
+    }
+
+    [[nodiscard]] float signedDistance(const Vector3 &point) const override {
+        const Vector3 pa = {point.x - start.x, point.y - start.y, point.z - start.z};
+        const Vector3 ba = {end.x - start.x, end.y - start.y, end.z - start.z};
+        const float baLengthSqr = ba.x * ba.x + ba.y * ba.y + ba.z * ba.z;
+        const float h = baLengthSqr > 0.0f
+                            ? std::clamp((pa.x * ba.x + pa.y * ba.y + pa.z * ba.z) / baLengthSqr, 0.0f, 1.0f)
+                            : 0.0f;
+        return length(pa.x - ba.x * h, pa.y - ba.y * h, pa.z - ba.z * h) - radius;
+    }
+
+    [[nodiscard]] BoundingBox getBounds() const override {
+        return {
+            {std::min(start.x, end.x) - radius, std::min(start.y, end.y) - radius, std::min(start.z, end.z) - radius},
+            {std::max(start.x, end.x) + radius, std::max(start.y, end.y) + radius, std::max(start.z, end.z) + radius}
+        };
+    }
+
+    void drawWireframe(const Color &color) const override {
+        DrawCapsuleWires(start, end, radius, 16, 4, color);
+    }
+
+private:
+    Vector3 start;
+    Vector3 end;
+    float radius;
+};
+
+class UnionShape final : public BoundaryShape {
+public:
+    UnionShape(std::shared_ptr<const BoundaryShape> a, std::shared_ptr<const BoundaryShape> b)
+        : a(std::move(a)), b(std::move(b)) {
+    }
+
+    [[nodiscard]] float signedDistance(const Vector3 &point) const override {
+        return std::min(a->signedDistance(point), b->signedDistance(point));
+    }
+
+    [[nodiscard]] BoundingBox getBounds() const override {
+        const BoundingBox boundsA = a->getBounds();
+        const BoundingBox boundsB = b->getBounds();
+        return {
+            {
+                std::min(boundsA.min.x, boundsB.min.x), std::min(boundsA.min.y, boundsB.min.y),
+                std::min(boundsA.min.z, boundsB.min.z)
+            },
+            {
+                std::max(boundsA.max.x, boundsB.max.x), std::max(boundsA.max.y, boundsB.max.y),
+                std::max(boundsA.max.z, boundsB.max.z)
+            }
+        };
+    }
+
+    void drawWireframe(const Color &color) const override {
+        a->drawWireframe(color);
+        b->drawWireframe(color);
+    }
+
+private:
+    std::shared_ptr<const BoundaryShape> a;
+    std::shared_ptr<const BoundaryShape> b;
+};
+
+class IntersectionShape final : public BoundaryShape {
+public:
+    IntersectionShape(std::shared_ptr<const BoundaryShape> a, std::shared_ptr<const BoundaryShape> b)
+        : a(std::move(a)), b(std::move(b)) {
+    }
+
+    [[nodiscard]] float signedDistance(const Vector3 &point) const override {
+        return std::max(a->signedDistance(point), b->signedDistance(point));
+    }
+
+    [[nodiscard]] BoundingBox getBounds() const override {
+        const BoundingBox boundsA = a->getBounds();
+        const BoundingBox boundsB = b->getBounds();
+        return {
+            {
+                std::max(boundsA.min.x, boundsB.min.x), std::max(boundsA.min.y, boundsB.min.y),
+                std::max(boundsA.min.z, boundsB.min.z)
+            },
+            {
+                std::min(boundsA.max.x, boundsB.max.x), std::min(boundsA.max.y, boundsB.max.y),
+                std::min(boundsA.max.z, boundsB.max.z)
+            }
+        };
+    }
+
+    void drawWireframe(const Color &color) const override {
+        a->drawWireframe(color);
+        b->drawWireframe(color);
+    }
+
+private:
+    std::shared_ptr<const BoundaryShape> a;
+    std::shared_ptr<const BoundaryShape> b;
+};
+
+// A shape with b carved out of a
+class DifferenceShape final : public BoundaryShape {
+public:
+    DifferenceShape(std::shared_ptr<const BoundaryShape> a, std::shared_ptr<const BoundaryShape> b)
+        : a(std::move(a)), b(std::move(b)) {
+    }
+
+    [[nodiscard]] float signedDistance(const Vector3 &point) const override {
+        return std::max(a->signedDistance(point), -b->signedDistance(point));
+    }
+
+    [[nodiscard]] BoundingBox getBounds() const override {
+        return a->getBounds();
+    }
+
+    void drawWireframe(const Color &color) const override {
+        a->drawWireframe(color);
+        b->drawWireframe(color);
+    }
+
+private:
+    std::shared_ptr<const BoundaryShape> a;
+    std::shared_ptr<const BoundaryShape> b;
+};
+
+// Boundary imported from a voxel mask. The distance is only exact in sign (half a voxel either side of the mask
+// surface), which is all the lattice rasterization needs.
+//
+// File format: a text header line
+//     CELLMASK <sizeX> <sizeY> <sizeZ> <voxelSize> <originX> <originY> <originZ>
+// followed by sizeX * sizeY * sizeZ bytes (x fastest, then z, then y), non-zero meaning inside. Sizes and the
+// origin are in world units.
+class VoxelMaskShape final : public BoundaryShape {
+public:
+    VoxelMaskShape(const int sizeX, const int sizeY, const int sizeZ, const float voxelSize, const Vector3 &origin,
+                   std::vector<uint8_t> voxels)
+        : sizeX(sizeX), sizeY(sizeY), sizeZ(sizeZ), voxelSize(voxelSize), origin(origin), voxels(std::move(voxels)) {
+    }
+
+    static std::shared_ptr<VoxelMaskShape> loadFromFile(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Could not open boundary mask " << path << std::endl;
+            return nullptr;
+        }
+
+        std::string magic;
+        int sizeX = 0, sizeY = 0, sizeZ = 0;
+        float voxelSize = 0.0f;
+        Vector3 origin = {0, 0, 0};
+        file >> magic >> sizeX >> sizeY >> sizeZ >> voxelSize >> origin.x >> origin.y >> origin.z;
+        if (!file || magic != "CELLMASK" || sizeX <= 0 || sizeY <= 0 || sizeZ <= 0 || voxelSize <= 0.0f) {
+            std::cerr << "Invalid boundary mask header in " << path << std::endl;
+            return nullptr;
+        }
+        file.get(); // single whitespace character terminating the header
+
+        std::vector<uint8_t> voxels(static_cast<size_t>(sizeX) * sizeY * sizeZ);
+        file.read(reinterpret_cast<char *>(voxels.data()), static_cast<std::streamsize>(voxels.size()));
+        if (file.gcount() != static_cast<std::streamsize>(voxels.size())) {
+            std::cerr << "Boundary mask " << path << " is truncated" << std::endl;
+            return nullptr;
+        }
+
+        return std::make_shared<VoxelMaskShape>(sizeX, sizeY, sizeZ, voxelSize, origin, std::move(voxels));
+    }
+
+    [[nodiscard]] float signedDistance(const Vector3 &point) const override {
+        const BoundingBox bounds = getBounds();
+        const float dx = std::max(bounds.min.x - point.x, point.x - bounds.max.x);
+        const float dy = std::max(bounds.min.y - point.y, point.y - bounds.max.y);
+        const float dz = std::max(bounds.min.z - point.z, point.z - bounds.max.z);
+        if (dx > 0.0f || dy > 0.0f || dz > 0.0f) {
+            return length(std::max(dx, 0.0f), std::max(dy, 0.0f), std::max(dz, 0.0f)) + voxelSize / 2;
+        }
+
+        const int x = std::min(static_cast<int>((point.x - origin.x) / voxelSize), sizeX - 1);
+        const int y = std::min(static_cast<int>((point.y - origin.y) / voxelSize), sizeY - 1);
+        const int z = std::min(static_cast<int>((point.z - origin.z) / voxelSize), sizeZ - 1);
+        const bool inside = voxels[(static_cast<size_t>(y) * sizeZ + z) * sizeX + x] != 0;
+        return inside ? -voxelSize / 2 : voxelSize / 2;
+    }
+
+    [[nodiscard]] BoundingBox getBounds() const override {
+        return {
+            origin,
+            {origin.x + sizeX * voxelSize, origin.y + sizeY * voxelSize, origin.z + sizeZ * voxelSize}
+        };
+    }
+
+private:
+    int sizeX;
+    int sizeY;
+    int sizeZ;
+    float voxelSize;
+    Vector3 origin;
+    std::vector<uint8_t> voxels;
+};
@@ -0,0 +1,772 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/task_arena.h>
+
+#include "raylib.h"
+#include "OctahedronGrid.h"
+
+#include "BoundaryManager.h"
+#include "NumaPartitioner.h"
+#include "SeedPatterns.h"
+#include "TransformData.h"
+#include "Units.h"
+
+// The colony itself: lattice, per-cell attributes, starting positions and the division step. It has no rendering or
+// threads of its own, so the GUI manager drives it from its generation thread and the headless tools drive it
+// directly, one simulation per worker. Its parallel loops run in the caller's task arena unless given a thread count.
+template<typename Index = CellIndex>
+class BasicColonySimulation {
+public:
+    using Grid = BasicOctahedronGrid<Index>;
+    using Transforms = BasicTransformData<Index>;
+
+    explicit BasicColonySimulation(std::shared_ptr<BoundaryManager> boundary = std::make_shared<BoundaryManager>(),
+                                   const uint64_t seed = std::random_device()())
+        : boundaryManager(std::move(boundary)),
+          seed(seed) {
+        transforms.reserve(1000);
+        startingPositions.reserve(1000);
+        generateStartingPositions();
+    }
+
+    // Lays out the starting cells with the current seeding strategy. Only recomputed when the spacing, the layer
+    // count, the seeding options, the seed or the boundary changed since the last call, so the GUI can call it every
+    // frame; returns whether it recomputed.
+    bool generateStartingPositions() {
+        const SeedingInputs inputs{
+            boundaryManager->getRevision(), seedingRevision, seed, octahedraSpacing, octahedraLayers
+        };
+        if (seedingInputs == inputs) return false;
+        seedingInputs = inputs;
+
+        inArena([&] {
+            if (seedingOptions.strategy == SeedingStrategy::Hexagonal) {
+                generateHexagonalPositions();
+            } else {
+                generateScatteredPositions();
+            }
+        });
+
+        // If no positions were generated, add center position as a fallback
+        if (startingPositions.empty()) {
+            startingPositions.push_back(Grid::snapToGridPosition(boundaryManager->getBoundaryCenter()));
+        }
+        return true;
+    }
+
+    // Locks the boundary and builds the lattice for it: sized to the boundary's bounds with the boundary baked in, or
+    // unbounded when the boundary is disabled. Then places the starting cells. Does nothing on later calls.
+    void initializeLattice() {
+        if (latticeInitialized) return;
+
+        boundaryManager->lockBoundarySize();
+        if (!boundaryManager->isBoundaryEnabled()) {
+            // Without a boundary there is nothing to size the lattice from, so let it grow on demand
+            grid.makeUnbounded();
+            capacity = 0;
+            reservedCells = UNBOUNDED_CELL_RESERVE;
+            grid.reserveCells(reservedCells);
+            transforms.reserve(reservedCells);
+        } else {
+            auto [gridLength, gridDepth, gridHeight] = latticeSizeFor(boundaryManager->getBounds());
+            int firstColumn = 0;
+            if (ownedColumns) {
+                // The owned columns plus one halo column on either side, which is as far as a division reaches
+                firstColumn = std::max(0, ownedColumns->first - 1);
+                const int endColumn = std::min(static_cast<int>(gridLength), ownedColumns->second + 1);
+                gridLength = static_cast<size_t>(std::max(0, endColumn - firstColumn));
+            }
+
+            inArena([&] {
+                grid.resizeGrid(gridLength, gridDepth, gridHeight, firstColumn);
+                bakeBoundaryMask();
+            });
+            reservedCells = gridLength * gridHeight * gridDepth;
+            transforms.reserve(reservedCells);
+        }
+        latticeInitialized = true;
+
+        createInitialOctahedra();
+    }
+
+    [[nodiscard]] bool isLatticeInitialized() const {
+        return latticeInitialized;
+    }
+
+    // Sites along x, z and y of the bounded lattice for a boundary with these bounds. It starts at the world origin,
+    // so it has to reach the far corner of the bounds (for shaped boundaries these are the shape's bounds, not the GUI
+    // rectangle).
+    [[nodiscard]] static std::array<size_t, 3> latticeSizeFor(const BoundingBox &bounds) {
+        constexpr float gridMargin = 1.2f; // 20% margin
+        return {
+            static_cast<size_t>(bounds.max.x * gridMargin / Grid::SQUARE_DISTANCE) + 10,
+            static_cast<size_t>(bounds.max.z * gridMargin / Grid::SQUARE_DISTANCE) + 10,
+            static_cast<size_t>(bounds.max.y * gridMargin / (Grid::SQUARE_DISTANCE / 2)) + 10
+        };
+    }
+
+    // Makes this simulation one slab of a domain-decomposed colony: it only holds lattice columns firstX to endX - 1
+    // (plus a halo column on either side), only those columns accept cells, and the capacity counts only them.
+    // Division targets in the halo are left to the caller, which forwards them to the slab that owns them and copies
+    // that slab's edge back with insertGhosts. Must be called before initializeLattice; ignored by unbounded lattices.
+    void setOwnedColumns(const int firstX, const int endX) {
+        ownedColumns = {firstX, endX};
+    }
+
+    [[nodiscard]] bool isOwnedSite(const Vector3 &pos) const {
+        if (!ownedColumns || grid.isUnbounded()) return true;
+        const int x = std::get<0>(Grid::getSiteCoordinates(pos));
+        return x >= ownedColumns->first && x < ownedColumns->second;
+    }
+
+    // Create octahedra based on the precomputed starting positions
+    void createInitialOctahedra() {
+        inArena([&] {
+            if (transforms.size() > 0) {
+                grid.clear();
+                transforms = Transforms();
+                // As much as the lattice was sized for, so each well of a plate only reserves its own sites
+                transforms.reserve(reservedCells);
+            }
+            tickCount = 0;
+
+            generateStartingPositions();
+            insertOctahedra(startingPositions);
+
+            updateVisibility();
+        });
+    }
+
+    // The boundary is baked into the grid when the simulation starts, so availability already covers it
+    void addOctahedron(const Vector3 &pos) {
+        if (const Vector3 snappedPos = Grid::snapToGridPosition(pos); grid.isAvailable(snappedPos)) {
+            const Index index = static_cast<Index>(transforms.size());
+            transforms.add();
+            grid.insert(snappedPos, index);
+            grid.addVisibleCell(snappedPos, 1);
+            latticeRevision++;
+        }
+    }
+
+    // Bulk version of addOctahedron: grid slots and per-cell attributes are written in parallel, and the result
+    // reports which positions were rejected (occupied, duplicated within the batch, or outside the boundary).
+    typename Grid::BatchInsertResult insertOctahedra(const std::vector<Vector3> &positions) {
+        return inArena([&] {
+            latticeRevision++;
+            const size_t firstIndex = transforms.size();
+            transforms.resize(firstIndex + positions.size());
+
+            auto result = grid.insertBatch(
+                positions,
+                [this](const Vector3 &sitePos) { return isOwnedSite(sitePos); },
+                [this](const Index cellIndex, const Vector3 &sitePos) {
+                    transforms.initialize(cellIndex);
+                    grid.addVisibleCell(sitePos, 1);
+                }
+            );
+
+            transforms.resize(firstIndex + result.insertedCount);
+            return result;
+        });
+    }
+
+    [[nodiscard]] bool isWithinBoundary(const Vector3 &pos) const {
+        return boundaryManager->isPointWithinBoundary(pos);
+    }
+
+    // Sites outside the boundary are pre-marked as blocked in the grid, so no per-candidate boundary test is needed
+    [[nodiscard]] std::vector<Vector3> getAvailableNeighborPositions(const Vector3 &pos) const {
+        return grid.getAvailableNeighbors(pos);
+    }
+
+    // Rasterizes the current boundary into the grid. Runs once when the boundary is locked, and again only if the
+    // boundary is switched on or off afterwards.
+    void bakeBoundaryMask() {
+        latticeRevision++;
+        if (!boundaryManager->isBoundaryEnabled()) {
+            grid.clearBoundary();
+        } else {
+            grid.bakeBoundary([this](const Vector3 &sitePos) {
+                return boundaryManager->isPointWithinBoundary(sitePos);
+            });
+        }
+        capacity = ownedColumns ? grid.countUnblockedSites(ownedColumns->first, ownedColumns->second)
+                                : grid.countUnblockedSites();
+    }
+
+    // Once a run has started the lattice kind is fixed: a bounded grid re-bakes its mask, while a grid that started
+    // unbounded keeps growing freely.
+    void toggleBoundaryEnabled() {
+        boundaryManager->toggleBoundaryEnabled();
+        if (latticeInitialized) {
+            inArena([&] { bakeBoundaryMask(); });
+        }
+    }
+
+    // One division round: every cell divides with probability spawnChance into a random free neighboring site.
+    // Random draws are a hash of (seed, round, site) rather than a shared generator, so a seed reproduces the same
+    // colony however the work is split across threads. Returns the number of cells added.
+    size_t spawnNewOctahedra() {
+        return insertDivisions(chooseDivisionSites()).insertedCount;
+    }
+
+    // First half of a division round: the site each dividing cell divides into, in cell order. A division only
+    // depends on the cell's site and the occupancy before the round, so slabs of a decomposed colony choose exactly
+    // what the whole colony would.
+    std::vector<Vector3> chooseDivisionSites() {
+        return inArena([&] {
+            std::vector<Vector3> sites = selectDivisionSites(tickCount + 1);
+            tickCount++;
+            return sites;
+        });
+    }
+
+    // Second half: places the new cells. Sites claimed twice get one cell, and sites outside the owned columns of a
+    // slab are refused.
+    typename Grid::BatchInsertResult insertDivisions(const std::vector<Vector3> &newPositions) {
+        return inArena([&] {
+            auto result = insertOctahedra(newPositions);
+
+            if (!newPositions.empty()) {
+                updateVisibilityForNewCells(newPositions);
+            }
+            return result;
+        });
+    }
+
+    // Copies cells of a neighboring slab into the halo, so divisions here see them and neighbor counts include them
+    void insertGhosts(const std::vector<Vector3> &positions) {
+        inArena([&] {
+            grid.insertGhosts(positions);
+            latticeRevision++;
+            updateVisibilityForNewCells(positions);
+        });
+    }
+
+    // A full tick: one division round, then a visibility update for the new cells and their neighbors. Placing the
+    // cells is the only step that changes occupancy, and the visibility update only writes per-cell attributes, so
+    // the next round's divisions are chosen alongside it and the next tick starts straight with placing them. The
+    // early choice is redone if the lattice, the seed or the spawn chance changed in between.
+    size_t tick() {
+        return inArena([&] {
+            const std::vector<Vector3> divisions = takeDivisionSites();
+            tickCount++;
+            const size_t inserted = insertOctahedra(divisions).insertedCount;
+
+            const DivisionInputs nextInputs{tickCount + 1, seed, spawnChance, latticeRevision};
+            tbb::parallel_invoke(
+                [&] { updateVisibilityForNewCells(divisions); },
+                [&] { nextDivisions = selectDivisionSites(nextInputs.round); }
+            );
+            nextDivisionInputs = nextInputs;
+            return inserted;
+        });
+    }
+
+    void updateVisibility() {
+        inArena([&] {
+            NumaPartitioner::instance().parallelForCells(
+                transforms.size(), grainSize,
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t idx = range.begin(); idx != range.end(); ++idx) {
+                        updateCellVisibility(static_cast<Index>(idx));
+                    }
+                }
+            );
+        });
+    }
+
+    void updateCellVisibility(const Index idx) {
+        const Vector3 pos = grid.getPositionForIndex(idx);
+        const int neighborCount = grid.countOccupiedNeighbors(pos);
+        const bool isVisible = neighborCount < 14;
+        if (isVisible != transforms.isVisible(idx)) {
+            grid.addVisibleCell(pos, isVisible ? 1 : -1);
+        }
+        transforms.setVisibility(idx, isVisible);
+        transforms.setNeighborCount(idx, neighborCount);
+    }
+
+    // Only the new cells and the cells that count them as neighbors can change visibility. Each new cell lists those
+    // in its own slots, and the list is sorted to update every affected cell once.
+    void updateVisibilityForNewCells(const std::vector<Vector3> &newPositions) {
+        constexpr size_t SLOTS = 15; // the cell and up to 14 cells next to it
+        std::vector<Index> affected(newPositions.size() * SLOTS, Grid::INVALID_INDEX);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, newPositions.size(), NEIGHBOR_GRAIN_SIZE),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    affected[i * SLOTS] = grid.findCellIndex(newPositions[i]);
+                    std::ranges::copy(grid.findCellsNeighboring(newPositions[i]), affected.begin() + i * SLOTS + 1);
+                }
+            }
+        );
+
+        // INVALID_INDEX is the largest index, so empty slots sort to the end
+        tbb::parallel_sort(affected.begin(), affected.end());
+        const auto last = std::unique(affected.begin(), std::lower_bound(affected.begin(), affected.end(),
+                                                                         Grid::INVALID_INDEX));
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, static_cast<size_t>(last - affected.begin()), NEIGHBOR_GRAIN_SIZE),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    updateCellVisibility(affected[i]);
+                }
+            }
+        );
+    }
+
+    [[nodiscard]] std::shared_ptr<BoundaryManager> getBoundaryManager() const {
+        return boundaryManager;
+    }
+
+    [[nodiscard]] const Grid &getGrid() const {
+        return grid;
+    }
+
+    [[nodiscard]] const Transforms &getTransforms() const {
+        return transforms;
+    }
+
+    [[nodiscard]] const std::vector<Vector3> &getStartingPositions() const {
+        return startingPositions;
+    }
+
+    [[nodiscard]] size_t getCount() const {
+        return transforms.size();
+    }
+
+    // Number of cells with each neighbor count (0-14)
+    [[nodiscard]] std::array<size_t, 15> getNeighborCountHistogram() const {
+        std::array<size_t, 15> histogram{};
+        for (Index i = 0; i < transforms.size(); i++) {
+            histogram[std::clamp(transforms.getNeighborCount(i), 0, 14)]++;
+        }
+        return histogram;
+    }
+
+    [[nodiscard]] uint64_t getTickCount() const {
+        return tickCount;
+    }
+
+    // Sites the colony can fill inside the baked boundary; 0 for an unbounded lattice. Counted when the boundary is
+    // baked, so this is cheap to poll every tick.
+    [[nodiscard]] size_t getCapacity() const {
+        return capacity;
+    }
+
+    // Filled share of the capacity in percent; 0 for an unbounded lattice
+    [[nodiscard]] float getConfluence() const {
+        return capacity > 0 ? 100.0f * static_cast<float>(getCount()) / static_cast<float>(capacity) : 0.0f;
+    }
+
+    void setOctahedraSpacing(const float spacing) {
+        if (spacing > 0.0f) {
+            octahedraSpacing = spacing;
+        }
+    }
+
+    [[nodiscard]] float getOctahedraSpacing() const {
+        return octahedraSpacing;
+    }
+
+    void setOctahedraLayers(const int layers) {
+        if (layers > 0) {
+            octahedraLayers = layers;
+        }
+    }
+
+    [[nodiscard]] int getOctahedraLayers() const {
+        return octahedraLayers;
+    }
+
+    void setSpawnChance(float chance) {
+        spawnChance = std::max(0.01f, std::min(1.0f, chance));
+    }
+
+    [[nodiscard]] float getSpawnChance() const {
+        return spawnChance;
+    }
+
+    void setSeed(const uint64_t newSeed) {
+        seed = newSeed;
+    }
+
+    [[nodiscard]] uint64_t getSeed() const {
+        return seed;
+    }
+
+    // Takes effect on the next generateStartingPositions
+    void setSeedingOptions(SeedingOptions options) {
+        seedingOptions = std::move(options);
+        seedingRevision++;
+    }
+
+    [[nodiscard]] const SeedingOptions &getSeedingOptions() const {
+        return seedingOptions;
+    }
+
+    // Runs the simulation's parallel work in an arena of its own with this many threads, so it can share the process
+    // with a render thread or other simulations without taking every core. 0 runs it in the caller's arena, which is
+    // the default and what the ensemble, sweep and plate runners rely on. Not to be changed while a tick runs.
+    void setThreadCount(const int threads) {
+        arena = threads > 0 ? std::make_unique<tbb::task_arena>(threads) : nullptr;
+    }
+
+    [[nodiscard]] int getThreadCount() const {
+        return arena ? arena->max_concurrency() : 0;
+    }
+
+    // Cells per task in the per-cell loops. Smaller grains balance better, larger ones schedule less.
+    void setGrainSize(const size_t cells) {
+        grainSize = std::max<size_t>(1, cells);
+    }
+
+    [[nodiscard]] size_t getGrainSize() const {
+        return grainSize;
+    }
+
+private:
+    // Per-cell arrays are read by the render thread while the simulation appends to them, so an unbounded run
+    // reserves enough up front that typical colonies never reallocate them mid-frame
+    static constexpr size_t UNBOUNDED_CELL_RESERVE = 5000000;
+    static constexpr size_t DEFAULT_GRAIN_SIZE = 2048;
+    // Visibility updates touch only the cells around a tick's new ones, so they are split finer than full passes
+    static constexpr size_t NEIGHBOR_GRAIN_SIZE = 256;
+
+    // The sites cells divide into in the given round, in cell order. Only reads the lattice.
+    [[nodiscard]] std::vector<Vector3> selectDivisionSites(const uint64_t round) const {
+        const size_t totalSize = transforms.size();
+        const uint64_t roundKey = mix(seed ^ mix(round));
+
+        // Cells are split into fixed blocks that each collect their own candidates, so concatenating the blocks
+        // keeps cell order whatever thread ran them. Blocks are a power of two, so each lies within one of the chunks
+        // the per-cell arrays are placed by, and is worked on by that chunk's node.
+        constexpr size_t CELL_CHUNK = NumaPartitioner::CELL_CHUNK;
+        const size_t blockSize = std::bit_floor(std::min(grainSize, CELL_CHUNK));
+        const size_t blockCount = (totalSize + blockSize - 1) / blockSize;
+        std::vector<std::vector<Vector3>> blockCandidates(blockCount);
+        NumaPartitioner::instance().parallelForInterleaved(
+            blockCount, CELL_CHUNK / blockSize, 1,
+            [&](const tbb::blocked_range<size_t> &blocks) {
+                for (size_t block = blocks.begin(); block != blocks.end(); ++block) {
+                    const size_t end = std::min(totalSize, (block + 1) * blockSize);
+                    for (size_t idx = block * blockSize; idx < end; idx++) {
+                        const Vector3 currentPos = grid.getPositionForIndex(static_cast<Index>(idx));
+                        const uint64_t siteKey = mix(roundKey ^ positionKey(currentPos));
+                        if (toUnitFloat(siteKey) >= spawnChance) continue;
+
+                        if (const auto available = getAvailableNeighborPositions(currentPos); !available.empty()) {
+                            blockCandidates[block].push_back(available[mix(siteKey) % available.size()]);
+                        }
+                    }
+                }
+            }
+        );
+
+        std::vector<size_t> blockOffsets(blockCount + 1, 0);
+        for (size_t block = 0; block < blockCount; block++) {
+            blockOffsets[block + 1] = blockOffsets[block] + blockCandidates[block].size();
+        }
+        std::vector<Vector3> newPositions(blockOffsets[blockCount]);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, blockCount),
+            [&](const tbb::blocked_range<size_t> &blocks) {
+                for (size_t block = blocks.begin(); block != blocks.end(); ++block) {
+                    std::ranges::copy(blockCandidates[block], newPositions.begin() + blockOffsets[block]);
+                }
+            }
+        );
+        return newPositions;
+    }
+
+    // This tick's divisions: the ones the previous tick chose early if nothing they depend on changed since
+    std::vector<Vector3> takeDivisionSites() {
+        const DivisionInputs inputs{tickCount + 1, seed, spawnChance, latticeRevision};
+        const bool valid = nextDivisionInputs == inputs;
+        nextDivisionInputs.reset();
+        return valid ? std::move(nextDivisions) : selectDivisionSites(inputs.round);
+    }
+
+    template<typename Fn>
+    decltype(auto) inArena(Fn &&fn) {
+        return arena ? arena->execute(std::forward<Fn>(fn)) : fn();
+    }
+
+    // Hexagonal pattern on every layer, with alternate layers shifted so their seeds do not stack. The work happens
+    // on the integer lattice: each pattern row is snapped once, rows that snap onto the same lattice row are merged,
+    // and the lattice rows are filled in parallel, so points that snap onto the same site are kept once.
+    void generateHexagonalPositions() {
+        const float width = boundaryManager->getBoundaryWidth();
+        const float depth = boundaryManager->getBoundaryDepth();
+        const float height = boundaryManager->getBoundaryHeight();
+        const Vector3 center = boundaryManager->getBoundaryCenter();
+
+        const float horizontalSpacing = octahedraSpacing;
+        const float verticalSpacing = octahedraSpacing * 0.866025404f; // sqrt(3)/2
+
+        const float minX = center.x - width / 2 + horizontalSpacing / 2;
+        const float maxX = center.x + width / 2 - horizontalSpacing / 2;
+        const float minZ = center.z - depth / 2 + verticalSpacing / 2;
+        const float maxZ = center.z + depth / 2 - verticalSpacing / 2;
+
+        const std::vector<float> layers = layerHeights(center.y - height / 2, height);
+
+        // Pattern rows grouped by the lattice row (y, z) they snap onto, in order of first appearance
+        std::vector<LatticeRow> rows;
+        std::unordered_map<uint64_t, size_t> rowByKey;
+        for (int layer = 0; layer < octahedraLayers; layer++) {
+            const float layerY = layers[layer];
+            const float layerXOffset = (layer % 2) * horizontalSpacing * 0.25f;
+            const float layerZOffset = (layer % 3) * verticalSpacing * 0.25f;
+
+            for (int row = 0; minZ + layerZOffset + row * verticalSpacing <= maxZ; row++) {
+                const float z = minZ + layerZOffset + row * verticalSpacing;
+                const float firstX = minX + (row % 2) * horizontalSpacing * 0.5f + layerXOffset;
+                if (firstX > maxX) continue;
+
+                const int y = toSite(layerY);
+                const int siteZ = toSite(z);
+                const auto [entry, added] = rowByKey.try_emplace(siteKey(0, y, siteZ), rows.size());
+                if (added) rows.push_back({y, siteZ, {}});
+                rows[entry->second].spans.push_back({
+                    firstX, static_cast<int>((maxX - firstX) / horizontalSpacing) + 1
+                });
+            }
+        }
+
+        std::vector<std::vector<Vector3>> rowPositions(rows.size());
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, rows.size()),
+            [&](const tbb::blocked_range<size_t> &range) {
+                std::vector<int> sites;
+                for (size_t r = range.begin(); r != range.end(); ++r) {
+                    const LatticeRow &row = rows[r];
+                    sites.clear();
+                    for (const auto &[firstX, count]: row.spans) {
+                        for (int i = 0; i < count; i++) {
+                            sites.push_back(toSite(firstX + i * horizontalSpacing));
+                        }
+                    }
+                    // A single span snaps in ascending order, so only merged rows need sorting
+                    if (row.spans.size() > 1) std::ranges::sort(sites);
+                    sites.erase(std::unique(sites.begin(), sites.end()), sites.end());
+
+                    for (const int x: sites) {
+                        const Vector3 position = {x * SITE_STEP, row.y * SITE_STEP, row.z * SITE_STEP};
+                        if (isWithinBoundary(position)) {
+                            rowPositions[r].push_back(position);
+                        }
+                    }
+                }
+            }
+        );
+
+        size_t total = 0;
+        for (const auto &positions: rowPositions) total += positions.size();
+        startingPositions.clear();
+        startingPositions.reserve(total);
+        for (const auto &positions: rowPositions) {
+            startingPositions.insert(startingPositions.end(), positions.begin(), positions.end());
+        }
+    }
+
+    // Random and file-based layouts: the pattern's points are snapped in parallel, points that share a site are kept
+    // once (the first one wins, so the layout does not depend on the thread count), and those outside the boundary
+    // are dropped
+    void generateScatteredPositions() {
+        const BoundingBox bounds = boundaryManager->getBounds();
+        const SeedArea area{bounds.min.x, bounds.min.z, bounds.max.x, bounds.max.z};
+        const std::vector<float> layers = layerHeights(bounds.min.y, bounds.max.y - bounds.min.y);
+        const float density = SeedPatterns::hexagonalDensity(octahedraSpacing);
+
+        std::vector<Vector3> points;
+        if (const auto &list = seedingOptions.pointList; seedingOptions.strategy == SeedingStrategy::PointList && list) {
+            for (const Vector3 &point: list->points) {
+                const float x = bounds.min.x + point.x * MM_TO_WORLD_SCALE;
+                const float z = bounds.min.z + point.z * MM_TO_WORLD_SCALE;
+                if (list->hasHeight) {
+                    points.push_back({x, bounds.min.y + point.y * MM_TO_WORLD_SCALE, z});
+                } else {
+                    for (const float y: layers) points.push_back({x, y, z});
+                }
+            }
+        } else {
+            for (size_t layer = 0; layer < layers.size(); layer++) {
+                const uint64_t layerSeed = mix(seed ^ mix(layer));
+                std::vector<Vector2> layout;
+                switch (seedingOptions.strategy) {
+                    case SeedingStrategy::Uniform:
+                        layout = SeedPatterns::uniform(area, density, layerSeed);
+                        break;
+                    case SeedingStrategy::PoissonDisk:
+                        layout = SeedPatterns::poissonDisk(area, SeedPatterns::poissonRadius(octahedraSpacing),
+                                                           layerSeed);
+                        break;
+                    case SeedingStrategy::Clustered:
+                        layout = SeedPatterns::clustered(area, density, seedingOptions.seedsPerCluster,
+                                                         seedingOptions.clusterRadius, layerSeed);
+                        break;
+                    case SeedingStrategy::DensityImage:
+                        if (seedingOptions.densityMap) {
+                            layout = SeedPatterns::fromDensityMap(area, *seedingOptions.densityMap, density, layerSeed);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+                for (const Vector2 &point: layout) points.push_back({point.x, layers[layer], point.y});
+            }
+        }
+
+        // Sorting the snapped sites by packed lattice coordinates puts duplicates next to each other, earliest first
+        std::vector<std::pair<uint64_t, size_t>> keyed(points.size());
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, points.size()),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    const int x = toSite(points[i].x);
+                    const int y = toSite(points[i].y);
+                    const int z = toSite(points[i].z);
+                    points[i] = {x * SITE_STEP, y * SITE_STEP, z * SITE_STEP};
+                    keyed[i] = {siteKey(x, y, z), i};
+                }
+            }
+        );
+        tbb::parallel_sort(keyed.begin(), keyed.end());
+
+        std::vector<uint8_t> keep(points.size());
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, keyed.size()),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    const size_t point = keyed[i].second;
+                    keep[point] = (i == 0 || keyed[i - 1].first != keyed[i].first) && isWithinBoundary(points[point]);
+                }
+            }
+        );
+
+        startingPositions.clear();
+        for (size_t i = 0; i < points.size(); i++) {
+            if (keep[i]) startingPositions.push_back(points[i]);
+        }
+    }
+
+    // Heights of the seeded layers, spread over the given vertical extent and at least one site apart. The margin is
+    // capped so that wide spacings in a thin boundary still seed inside it rather than above it.
+    [[nodiscard]] std::vector<float> layerHeights(const float bottom, const float height) const {
+        const float margin = std::min(octahedraSpacing / 2, height / (2.0f * static_cast<float>(octahedraLayers)));
+        float layerSpacing = octahedraLayers > 1 ? (height - 2 * margin) / (octahedraLayers - 1) : 0;
+        layerSpacing = std::max(layerSpacing, SITE_STEP);
+
+        std::vector<float> heights(octahedraLayers);
+        for (int layer = 0; layer < octahedraLayers; layer++) {
+            heights[layer] = bottom + margin + layer * layerSpacing;
+        }
+        return heights;
+    }
+
+    // Lattice coordinates packed 21 bits each, offset so that slightly negative sites still sort correctly
+    [[nodiscard]] static uint64_t siteKey(const int x, const int y, const int z) {
+        constexpr int offset = 1 << 20;
+        constexpr uint64_t mask = (1u << 21) - 1;
+        return (static_cast<uint64_t>(y + offset) & mask) << 42 | (static_cast<uint64_t>(z + offset) & mask) << 21 |
+               (static_cast<uint64_t>(x + offset) & mask);
+    }
+
+    // Lattice sites are spaced half a square distance apart on every axis, matching Grid::snapToGridPosition
+    static constexpr float SITE_STEP = Grid::SQUARE_DISTANCE * 0.5f;
+
+    // What a round's division choice depends on besides the round itself
+    struct DivisionInputs {
+        uint64_t round;
+        uint64_t seed;
+        float spawnChance;
+        uint64_t latticeRevision;
+
+        bool operator==(const DivisionInputs &) const = default;
+    };
+
+    struct SeedingInputs {
+        uint64_t boundaryRevision;
+        uint64_t optionsRevision;
+        uint64_t seed;
+        float spacing;
+        int layers;
+
+        bool operator==(const SeedingInputs &) const = default;
+    };
+
+    // One lattice row of the seeding pattern and the pattern rows snapped onto it, as (first x, point count) spans
+    struct LatticeRow {
+        int y;
+        int z;
+        std::vector<std::pair<float, int>> spans;
+    };
+
+    [[nodiscard]] static int toSite(const float coordinate) {
+        return static_cast<int>(std::lround(coordinate / SITE_STEP));
+    }
+
+    // splitmix64 finalizer
+    [[nodiscard]] static uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    [[nodiscard]] static uint64_t positionKey(const Vector3 &pos) {
+        const uint64_t x = std::bit_cast<uint32_t>(pos.x);
+        const uint64_t y = std::bit_cast<uint32_t>(pos.y);
+        const uint64_t z = std::bit_cast<uint32_t>(pos.z);
+        return mix((x << 32 | z) ^ mix(y));
+    }
+
+    [[nodiscard]] static float toUnitFloat(const uint64_t bits) {
+        return static_cast<float>(bits >> 40) * 0x1.0p-24f;
+    }
+
+    Transforms transforms;
+    Grid grid;
+    std::shared_ptr<BoundaryManager> boundaryManager;
+
+    bool latticeInitialized = false;
+    std::optional<std::pair<int, int>> ownedColumns;
+    uint64_t seed;
+    uint64_t tickCount = 0;
+    size_t capacity = 0;
+    // Cells the per-cell arrays were reserved for when the lattice was built
+    size_t reservedCells = 0;
+    float spawnChance = 1.0f; // Default spawn chance
+    float octahedraSpacing = 20.0f;
+    int octahedraLayers = 1;
+    std::vector<Vector3> startingPositions;
+    SeedingOptions seedingOptions;
+    uint64_t seedingRevision = 0;
+    std::optional<SeedingInputs> seedingInputs;
+    size_t grainSize = DEFAULT_GRAIN_SIZE;
+    // Bumped whenever cells or the boundary mask change, so a division choice made early can tell it is stale
+    uint64_t latticeRevision = 0;
+    std::vector<Vector3> nextDivisions;
+    std::optional<DivisionInputs> nextDivisionInputs;
+    std::unique_ptr<tbb::task_arena> arena;
+};
+
+using ColonySimulation = BasicColonySimulation<>;
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Units.h"
+
+// Predicts how many division rounds a seeded colony needs to reach a given confluence, so the seeding spacing for a
+// target time can be solved for without running the simulation.
+//
+// Predictions come from calibration tables measured with `cell_sim_headless calibrate`: for each layer count, a grid
+// of (spawn chance, spacing) points with the mean number of ticks to reach 5%, 10%, ... 95% confluence. Between grid
+// points the tables are interpolated bilinearly (linearly in the confluence level). Time to confluence depends on the
+// seed spacing, not on the footprint, as long as the spacing is well below the footprint, so one reference well
+// serves every size.
+//
+// Without a table for the requested layer count an analytic fallback is used: each seed's clone is a disc whose
+// radius grows at a constant front speed, and coverage follows the Avrami law 1 - exp(-density * area). Its
+// constants were fitted to single-layer runs and are only good for rough estimates.
+class ConfluencePredictor {
+public:
+    static constexpr int LEVEL_COUNT = 19;
+
+    static constexpr float levelPercent(const int level) {
+        return 5.0f * static_cast<float>(level + 1);
+    }
+
+    // Ticks to reach each confluence level at one calibration point; negative where a level was never reached
+    using LevelTicks = std::array<float, LEVEL_COUNT>;
+
+    // Returned for confluence levels that are never reached. The build uses -ffast-math, which assumes there are no
+    // infinities or NaNs, so "never" is a large finite value here and a negative one in the tables.
+    static constexpr float NEVER_REACHED = std::numeric_limits<float>::max();
+
+    [[nodiscard]] bool hasTable() const {
+        return !tables.empty();
+    }
+
+    bool loadTable(const std::string &path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Could not open confluence table " << path << std::endl;
+            return false;
+        }
+        return readTable(file, path);
+    }
+
+    // CSV with the header written by writeTable. Layer counts whose points do not form a full grid are skipped.
+    bool readTable(std::istream &in, const std::string &name = "confluence table") {
+        std::string line;
+        if (!std::getline(in, line) || !line.starts_with("layers,spawn_chance,spacing")) {
+            std::cerr << "Invalid header in " << name << std::endl;
+            return false;
+        }
+
+        std::map<int, std::vector<std::pair<std::array<float, 2>, LevelTicks>>> rows;
+        int lineNumber = 1;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (line.empty()) continue;
+
+            std::stringstream stream(line);
+            std::string field;
+            std::vector<float> values;
+            while (std::getline(stream, field, ',')) {
+                try {
+                    values.push_back(std::stof(field));
+                } catch (const std::exception &) {
+                    values.clear();
+                    break;
+                }
+            }
+            if (values.size() != 3 + LEVEL_COUNT) {
+                std::cerr << "Skipping malformed line " << lineNumber << " in " << name << std::endl;
+                continue;
+            }
+
+            LevelTicks ticks{};
+            std::copy(values.begin() + 3, values.end(), ticks.begin());
+            rows[static_cast<int>(values[0])].push_back({{values[1], values[2]}, ticks});
+        }
+
+        for (auto &[layers, points]: rows) {
+            for (const auto &[key, ticks]: points) {
+                addCalibrationPoint(layers, key[0], key[1], ticks);
+            }
+        }
+        std::erase_if(tables, [&](const auto &entry) {
+            if (entry.second.isComplete()) return false;
+            std::cerr << "Confluence table " << name << " has an incomplete grid for " << entry.first
+                      << " layers, ignoring it" << std::endl;
+            return true;
+        });
+        return hasTable();
+    }
+
+    void writeTable(std::ostream &out) const {
+        out << "layers,spawn_chance,spacing";
+        for (int level = 0; level < LEVEL_COUNT; level++) {
+            out << ",ticks_" << static_cast<int>(levelPercent(level));
+        }
+        out << '\n';
+
+        for (const auto &[layers, table]: tables) {
+            for (size_t c = 0; c < table.spawnChances.size(); c++) {
+                for (size_t s = 0; s < table.spacings.size(); s++) {
+                    out << layers << ',' << table.spawnChances[c] << ',' << table.spacings[s];
+                    for (const float ticks: table.at(c, s)) {
+                        out << ',' << ticks;
+                    }
+                    out << '\n';
+                }
+            }
+        }
+    }
+
+    void addCalibrationPoint(const int layers, const float spawnChance, const float spacing, const LevelTicks &ticks) {
+        LayerTable &table = tables[layers];
+        LevelTicks stored = ticks;
+        for (float &value: stored) {
+            value = std::max(value, -1.0f);
+        }
+        table.points[{spawnChance, spacing}] = stored;
+        table.rebuildAxes();
+    }
+
+    // Ticks to reach each level along a mean confluence curve (percent per tick, starting at tick 1), interpolating
+    // between ticks
+    static LevelTicks ticksFromCurve(const std::vector<float> &meanConfluence) {
+        LevelTicks ticks;
+        ticks.fill(-1.0f);
+        for (int level = 0; level < LEVEL_COUNT; level++) {
+            const float target = levelPercent(level);
+            for (size_t tick = 0; tick < meanConfluence.size(); tick++) {
+                if (meanConfluence[tick] < target) continue;
+
+                const float previous = tick > 0 ? meanConfluence[tick - 1] : 0.0f;
+                const float step = meanConfluence[tick] - previous;
+                const float fraction = step > 0.0f ? (target - previous) / step : 1.0f;
+                ticks[level] = static_cast<float>(tick) + fraction;
+                break;
+            }
+        }
+        return ticks;
+    }
+
+    // Division rounds until confluencePercent of the boundary is filled; NEVER_REACHED if it is never reached
+    [[nodiscard]] float predictTicks(const float spacing, const float spawnChance, const int layers,
+                                     const float confluencePercent) const {
+        const float percent = std::clamp(confluencePercent, levelPercent(0), levelPercent(LEVEL_COUNT - 1));
+        const float levelPosition = percent / 5.0f - 1.0f;
+        const int lowerLevel = std::min(static_cast<int>(levelPosition), LEVEL_COUNT - 2);
+        const float levelWeight = levelPosition - static_cast<float>(lowerLevel);
+
+        const auto table = findTable(layers);
+        if (table == tables.end()) {
+            return analyticTicks(spacing, spawnChance, percent);
+        }
+
+        const float lower = table->second.interpolate(spawnChance, spacing, lowerLevel);
+        const float upper = table->second.interpolate(spawnChance, spacing, lowerLevel + 1);
+        if (lower < 0.0f || upper < 0.0f) {
+            return levelWeight <= 0.0f && lower >= 0.0f ? lower : NEVER_REACHED;
+        }
+        return std::max(0.0f, lower + (upper - lower) * levelWeight);
+    }
+
+    [[nodiscard]] float predictHours(const float spacing, const float spawnChance, const int layers,
+                                     const float confluencePercent, const float cellSplitHours) const {
+        const float ticks = predictTicks(spacing, spawnChance, layers, confluencePercent);
+        return ticks == NEVER_REACHED ? NEVER_REACHED : ticks * cellSplitHours;
+    }
+
+    // Spacing (world units) at which the colony reaches confluencePercent after targetHours. Time to confluence grows
+    // with spacing, so this is a bisection over predictTicks. Clamped to the smallest sensible spacing (one cell)
+    // when even the densest seeding is too slow, and to the largest calibrated spacing (or maxSpacing without a
+    // table) when even the sparsest is too fast.
+    [[nodiscard]] float solveSpacing(const float targetHours, const float cellSplitHours, const float confluencePercent,
+                                     const float spawnChance, const int layers,
+                                     const float maxSpacing = 400.0f) const {
+        const float targetTicks = targetHours / std::max(cellSplitHours, 1e-3f);
+        const auto table = findTable(layers);
+        float low = OCTAHEDRON_WORLD_SIZE;
+        float high = std::max(low, table != tables.end() ? table->second.spacings.back() : maxSpacing);
+        if (predictTicks(low, spawnChance, layers, confluencePercent) >= targetTicks) return low;
+        if (predictTicks(high, spawnChance, layers, confluencePercent) <= targetTicks) return high;
+
+        for (int iteration = 0; iteration < 32 && high - low > 0.01f; iteration++) {
+            const float middle = (low + high) / 2;
+            if (predictTicks(middle, spawnChance, layers, confluencePercent) < targetTicks) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        return (low + high) / 2;
+    }
+
+private:
+    // Calibration points of one layer count on a rectilinear (spawn chance x spacing) grid
+    struct LayerTable {
+        std::map<std::array<float, 2>, LevelTicks> points;
+        std::vector<float> spawnChances;
+        std::vector<float> spacings;
+        std::vector<LevelTicks> grid; // spawn chance major
+
+        void rebuildAxes() {
+            spawnChances.clear();
+            spacings.clear();
+            for (const auto &key: points | std::views::keys) {
+                spawnChances.push_back(key[0]);
+                spacings.push_back(key[1]);
+            }
+            for (auto *axis: {&spawnChances, &spacings}) {
+                std::ranges::sort(*axis);
+                axis->erase(std::unique(axis->begin(), axis->end()), axis->end());
+            }
+
+            grid.assign(spawnChances.size() * spacings.size(), {});
+            for (auto &ticks: grid) ticks.fill(-1.0f);
+            for (const auto &[key, ticks]: points) {
+                const size_t c = std::ranges::lower_bound(spawnChances, key[0]) - spawnChances.begin();
+                const size_t s = std::ranges::lower_bound(spacings, key[1]) - spacings.begin();
+                grid[c * spacings.size() + s] = ticks;
+            }
+        }
+
+        [[nodiscard]] bool isComplete() const {
+            return !grid.empty() && points.size() == grid.size();
+        }
+
+        [[nodiscard]] const LevelTicks &at(const size_t c, const size_t s) const {
+            return grid[c * spacings.size() + s];
+        }
+
+        // Bilinear in (spawn chance, spacing), clamped to the measured range: measured ticks are noisy enough that
+        // extrapolating from the last two points can even slope the wrong way. Negative if any corner never reached
+        // the level.
+        [[nodiscard]] float interpolate(const float spawnChance, const float spacing, const int level) const {
+            const auto [c0, c1, cWeight] = bracket(spawnChances, spawnChance);
+            const auto [s0, s1, sWeight] = bracket(spacings, spacing);
+            const auto alongSpacing = [&](const size_t c) {
+                const float a = at(c, s0)[level];
+                const float b = at(c, s1)[level];
+                return a >= 0.0f && b >= 0.0f ? a + (b - a) * sWeight : -1.0f;
+            };
+            const float a = alongSpacing(c0);
+            const float b = c1 == c0 ? a : alongSpacing(c1);
+            return a >= 0.0f && b >= 0.0f ? a + (b - a) * cWeight : -1.0f;
+        }
+
+        static std::tuple<size_t, size_t, float> bracket(const std::vector<float> &axis, const float value) {
+            if (axis.size() == 1) return {0, 0, 0.0f};
+
+            const size_t upper = std::clamp<size_t>(std::ranges::upper_bound(axis, value) - axis.begin(), 1,
+                                                    axis.size() - 1);
+            const size_t lower = upper - 1;
+            const float weight = (value - axis[lower]) / (axis[upper] - axis[lower]);
+            return {lower, upper, std::clamp(weight, 0.0f, 1.0f)};
+        }
+    };
+
+    // Fitted to single-layer runs on a 5 mm box: front speed in world units per tick at spawn chance 1, its power-law
+    // falloff with the spawn chance, and the rounds lost before clones reach their steady shape
+    static constexpr float FRONT_SPEED = 2.5f;
+    static constexpr float SPAWN_EXPONENT = 0.75f;
+    static constexpr float STARTUP_TICKS = 2.8f;
+
+    static float analyticTicks(const float spacing, const float spawnChance, const float percent) {
+        // Seeds on a hexagonal pattern cover sqrt(3)/2 * spacing^2 each
+        constexpr float pi = 3.14159265f;
+        const float coverage = std::min(percent / 100.0f, 0.999f);
+        const float radius = spacing * std::sqrt(-std::log(1.0f - coverage) * 0.866025404f / pi);
+        const float speed = FRONT_SPEED * std::pow(std::clamp(spawnChance, 0.01f, 1.0f), SPAWN_EXPONENT);
+        return STARTUP_TICKS / std::pow(std::clamp(spawnChance, 0.01f, 1.0f), SPAWN_EXPONENT) + radius / speed;
+    }
+
+    [[nodiscard]] std::map<int, LayerTable>::const_iterator findTable(const int layers) const {
+        return tables.find(layers);
+    }
+
+    std::map<int, LayerTable> tables;
+};
@@ -0,0 +1,582 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <tbb/global_control.h>
+
+#include "raylib.h"
+#include "BoundaryManager.h"
+#include "ColonySimulation.h"
+#include "HeadlessRun.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CELL_SIM_DECOMPOSITION 1
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+// Domain decomposition of one large colony over several worker processes, for wells whose lattice does not fit in
+// one process. The lattice is cut into slabs of whole x columns and every worker simulates one slab (see
+// ColonySimulation::setOwnedColumns), so its memory follows the slab rather than the well.
+//
+// A division reaches at most one column to either side, so neighboring slabs only need to agree on one column each
+// way. Each tick, every worker
+//   1. chooses division sites for its own cells, reading its halo copy of the neighbors' edge columns,
+//   2. sends the claims that landed in a neighbor's column to that neighbor and inserts its own plus the ones it
+//      received,
+//   3. sends the new cells in its edge columns to the neighbors, which copy them into their halo as ghosts, and
+//   4. sums the cell counts with every other worker, so all of them stop on the same tick.
+// Divisions only depend on a cell's site and the occupancy before the round, so the decomposed colony is exactly the
+// colony the undecomposed run grows from the same seed.
+
+// Moves the messages of one decomposed run between its workers, ranked along x. Swappable: the shared-memory
+// transport below serves workers on one host, and anything that can move bytes between ranks (sockets, MPI) can
+// implement the same two calls.
+class HaloTransport {
+public:
+    virtual ~HaloTransport() = default;
+
+    [[nodiscard]] virtual int getRank() const = 0;
+
+    [[nodiscard]] virtual int getWorkerCount() const = 0;
+
+    // Sends one message to each neighboring slab and returns the messages they sent this way, {from lower, from
+    // upper}. Both directions progress together, so messages larger than any buffer cannot deadlock. Messages to a
+    // missing neighbor are dropped; a missing neighbor sends an empty message.
+    virtual std::array<std::vector<char>, 2> exchange(const std::vector<char> &toLower,
+                                                      const std::vector<char> &toUpper) = 0;
+
+    // Element-wise sum over all workers. Every worker calls it with as many values, at the same point of the run.
+    virtual std::vector<uint64_t> sum(const std::vector<uint64_t> &values) = 0;
+};
+
+// Columns firstColumn to endColumn - 1 of the lattice
+struct SlabRange {
+    int firstColumn;
+    int endColumn;
+};
+
+struct SlabSummary {
+    SlabRange columns;
+    size_t capacity = 0;
+    size_t initialCells = 0;
+    size_t finalCells = 0;
+    double computeMs = 0.0;  // choosing and inserting divisions
+    double exchangeMs = 0.0; // halo exchanges and sums, including waiting for slower neighbors
+};
+
+// Splits a run's lattice into slabs with about equal numbers of sites inside the boundary, so round wells do not
+// leave the outer workers idle. Every slab gets at least one column. Runs serially: it is called before the workers
+// are forked, when the parent must not have started TBB threads yet.
+inline std::vector<SlabRange> planSlabs(const RunParameters &params, const int workers) {
+    const auto boundary = makeRunBoundary(params);
+    const BoundingBox bounds = boundary->getBounds();
+    const int columns = static_cast<int>(ColonySimulation::latticeSizeFor(bounds)[0]);
+
+    // Column weight: boundary hits on a sample line along z through the middle of the boundary
+    constexpr int samples = 256;
+    const float middleY = (bounds.min.y + bounds.max.y) / 2;
+    std::vector<double> cumulative(columns + 1, 0.0);
+    for (int column = 0; column < columns; column++) {
+        const float x = static_cast<float>(column) * OctahedronGrid::SQUARE_DISTANCE;
+        int inside = 0;
+        for (int sample = 0; sample < samples; sample++) {
+            const float fraction = (static_cast<float>(sample) + 0.5f) / samples;
+            const float z = bounds.min.z + (bounds.max.z - bounds.min.z) * fraction;
+            inside += boundary->isPointWithinBoundary({x, middleY, z}) ? 1 : 0;
+        }
+        cumulative[column + 1] = cumulative[column] + inside;
+    }
+
+    const int count = std::clamp(workers, 1, columns);
+    std::vector<SlabRange> slabs(count);
+    int first = 0;
+    for (int slab = 0; slab < count; slab++) {
+        int end = columns;
+        if (slab + 1 < count) {
+            const double target = cumulative[columns] * (slab + 1) / count;
+            end = static_cast<int>(std::ranges::lower_bound(cumulative, target) - cumulative.begin());
+            end = std::clamp(end, first + 1, columns - (count - slab - 1));
+        }
+        slabs[slab] = {first, end};
+        first = end;
+    }
+    return slabs;
+}
+
+// Runs one slab of a decomposed run to the end. Every worker returns the same result, as all stopping decisions use
+// the summed counts; only the timings are the worker's own.
+template<typename Index = CellIndex>
+RunResult runSlab(const RunParameters &params, const SlabRange &slab, HaloTransport &transport,
+                  SlabSummary &summary) {
+    using Clock = std::chrono::steady_clock;
+    using Grid = typename BasicColonySimulation<Index>::Grid;
+    const auto runStart = Clock::now();
+    const auto elapsedMs = [](const Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    // Every worker lays out the whole seeding pattern and keeps its own share, so seeding matches the undecomposed run
+    BasicColonySimulation<Index> simulation(makeRunBoundary(params), params.seed);
+    simulation.setOctahedraSpacing(params.spacing);
+    simulation.setOctahedraLayers(params.layers);
+    simulation.setSpawnChance(params.spawnChance);
+    simulation.setSeedingOptions(params.seeding);
+    if (params.grainSize > 0) simulation.setGrainSize(params.grainSize);
+    simulation.setOwnedColumns(slab.firstColumn, slab.endColumn);
+    simulation.generateStartingPositions();
+    simulation.initializeLattice();
+
+    const auto columnOf = [](const Vector3 &pos) { return std::get<0>(Grid::getSiteCoordinates(pos)); };
+    const auto pack = [](const std::vector<Vector3> &positions) {
+        std::vector<char> bytes(positions.size() * sizeof(Vector3));
+        std::memcpy(bytes.data(), positions.data(), bytes.size());
+        return bytes;
+    };
+    const auto unpackInto = [](const std::vector<char> &bytes, std::vector<Vector3> &positions) {
+        const size_t first = positions.size();
+        positions.resize(first + bytes.size() / sizeof(Vector3));
+        std::memcpy(positions.data() + first, bytes.data(), (positions.size() - first) * sizeof(Vector3));
+    };
+
+    // New cells in the edge columns go to the neighbor whose halo they are in
+    const auto exchangeEdges = [&](const std::vector<Vector3> &cells) {
+        std::vector<Vector3> lowerEdge;
+        std::vector<Vector3> upperEdge;
+        for (const Vector3 &pos: cells) {
+            const int column = columnOf(pos);
+            if (column == slab.firstColumn) lowerEdge.push_back(pos);
+            if (column == slab.endColumn - 1) upperEdge.push_back(pos);
+        }
+        const auto received = transport.exchange(pack(lowerEdge), pack(upperEdge));
+        std::vector<Vector3> ghosts;
+        unpackInto(received[0], ghosts);
+        unpackInto(received[1], ghosts);
+        simulation.insertGhosts(ghosts);
+    };
+
+    std::vector<Vector3> initialCells(simulation.getCount());
+    for (size_t i = 0; i < initialCells.size(); i++) {
+        initialCells[i] = simulation.getGrid().getPositionForIndex(static_cast<Index>(i));
+    }
+    exchangeEdges(initialCells);
+    simulation.updateVisibility();
+
+    summary.columns = slab;
+    summary.capacity = simulation.getCapacity();
+    summary.initialCells = simulation.getCount();
+    const auto totals = transport.sum({summary.capacity, summary.initialCells});
+
+    RunResult result;
+    result.capacity = totals[0];
+    result.initialCells = totals[1];
+    const auto confluenceOf = [&](const size_t cells) {
+        return result.capacity > 0 ? 100.0f * static_cast<float>(cells) / static_cast<float>(result.capacity) : 0.0f;
+    };
+
+    int idleTicks = 0;
+    double tickMsSum = 0.0;
+    size_t cells = result.initialCells;
+    while (result.ticks < params.maxTicks) {
+        const auto tickStart = Clock::now();
+
+        std::vector<Vector3> claims;
+        std::vector<Vector3> toLower;
+        std::vector<Vector3> toUpper;
+        for (const Vector3 &site: simulation.chooseDivisionSites()) {
+            const int column = columnOf(site);
+            (column < slab.firstColumn ? toLower : column >= slab.endColumn ? toUpper : claims).push_back(site);
+        }
+        summary.computeMs += elapsedMs(tickStart);
+
+        auto stepStart = Clock::now();
+        const auto received = transport.exchange(pack(toLower), pack(toUpper));
+        unpackInto(received[0], claims);
+        unpackInto(received[1], claims);
+        summary.exchangeMs += elapsedMs(stepStart);
+
+        stepStart = Clock::now();
+        const auto inserted = simulation.insertDivisions(claims);
+        std::vector<Vector3> newCells;
+        newCells.reserve(inserted.insertedCount);
+        for (size_t i = 0; i < claims.size(); i++) {
+            if (inserted.wasInserted(i)) newCells.push_back(claims[i]);
+        }
+        summary.computeMs += elapsedMs(stepStart);
+
+        stepStart = Clock::now();
+        exchangeEdges(newCells);
+        summary.exchangeMs += elapsedMs(stepStart);
+
+        stepStart = Clock::now();
+        const auto tickTotals = transport.sum({inserted.insertedCount, simulation.getCount()});
+        summary.exchangeMs += elapsedMs(stepStart);
+
+        const double tickMs = elapsedMs(tickStart);
+        result.ticks++;
+        tickMsSum += tickMs;
+        result.maxTickMs = std::max(result.maxTickMs, tickMs);
+
+        cells = tickTotals[1];
+        const float confluence = confluenceOf(cells);
+        if (result.ticksToConfluence < 0 && confluence >= params.confluencePercent) {
+            result.ticksToConfluence = result.ticks;
+            result.hoursToConfluence = static_cast<float>(result.ticks) * params.cellSplitHours;
+            if (params.stopAtConfluence) break;
+        }
+        idleTicks = tickTotals[0] == 0 ? idleTicks + 1 : 0;
+        if (idleTicks >= params.stallTicks || (result.capacity > 0 && cells >= result.capacity)) break;
+    }
+
+    summary.finalCells = simulation.getCount();
+    result.finalCells = cells;
+    result.finalConfluence = confluenceOf(cells);
+    result.meanTickMs = result.ticks > 0 ? tickMsSum / result.ticks : 0.0;
+    result.totalMs = elapsedMs(runStart);
+    return result;
+}
+
+#if defined(CELL_SIM_DECOMPOSITION)
+// Transport between worker processes on one host. A shared anonymous mapping, created before the workers are forked,
+// holds a single-producer single-consumer ring buffer for each direction between neighboring slabs and the slots for
+// sums. Waiting spins with yields, which keeps latency low when every worker has a core of its own.
+class SharedMemoryTransport final : public HaloTransport {
+public:
+    static constexpr size_t DEFAULT_RING_BYTES = 1 << 20;
+    static constexpr size_t MAX_SUM_VALUES = 8;
+
+    explicit SharedMemoryTransport(const int workers, const size_t ringBytes = DEFAULT_RING_BYTES)
+        : workers(workers),
+          ringBytes(std::max<size_t>(ringBytes, 64)) {
+        const size_t rings = 2 * static_cast<size_t>(workers);
+        sumOffset = roundUp(sizeof(Header));
+        ringOffset = sumOffset + roundUp(2 * workers * MAX_SUM_VALUES * sizeof(uint64_t));
+        dataOffset = ringOffset + rings * sizeof(Ring);
+        mappingBytes = dataOffset + rings * this->ringBytes;
+
+        void *mapping = mmap(nullptr, mappingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Could not map " << mappingBytes << " bytes for the halo exchange: " << std::strerror(errno)
+                      << std::endl;
+            return;
+        }
+        base = static_cast<char *>(mapping);
+        header = new(base) Header();
+        for (size_t ring = 0; ring < rings; ring++) {
+            new(base + ringOffset + ring * sizeof(Ring)) Ring();
+        }
+    }
+
+    ~SharedMemoryTransport() override {
+        if (base) munmap(base, mappingBytes);
+    }
+
+    SharedMemoryTransport(const SharedMemoryTransport &) = delete;
+    SharedMemoryTransport &operator=(const SharedMemoryTransport &) = delete;
+
+    [[nodiscard]] bool isValid() const {
+        return base != nullptr;
+    }
+
+    // Called in each worker after the fork
+    void setRank(const int workerRank) {
+        rank = workerRank;
+    }
+
+    [[nodiscard]] int getRank() const override {
+        return rank;
+    }
+
+    [[nodiscard]] int getWorkerCount() const override {
+        return workers;
+    }
+
+    // Makes every worker waiting on a peer give up, for when one of them died
+    void abort() const {
+        header->aborted.store(true, std::memory_order_release);
+    }
+
+    std::array<std::vector<char>, 2> exchange(const std::vector<char> &toLower,
+                                              const std::vector<char> &toUpper) override {
+        // Rings are numbered by sender, two per worker: toward the lower neighbor, then toward the upper one
+        const std::array<bool, 2> hasNeighbor = {rank > 0, rank + 1 < workers};
+        const std::array<const std::vector<char> *, 2> outgoing = {&toLower, &toUpper};
+        const std::array<int, 2> sendRings = {2 * rank, 2 * rank + 1};
+        const std::array<int, 2> receiveRings = {2 * (rank - 1) + 1, 2 * (rank + 1)};
+
+        std::array<std::vector<char>, 2> incoming;
+        std::array<size_t, 2> sent = {0, 0};
+        std::array<size_t, 2> received = {0, 0};
+        std::array<uint64_t, 2> lengths = {0, 0};
+        while (true) {
+            bool pending = false;
+            bool progress = false;
+            for (int side = 0; side < 2; side++) {
+                if (!hasNeighbor[side]) continue;
+                progress |= send(sendRings[side], *outgoing[side], sent[side]);
+                progress |= receive(receiveRings[side], incoming[side], lengths[side], received[side]);
+                pending |= sent[side] < sizeof(uint64_t) + outgoing[side]->size() ||
+                        received[side] < sizeof(uint64_t) + lengths[side];
+            }
+            if (!pending) break;
+            if (!progress) waitForPeers();
+        }
+        return incoming;
+    }
+
+    std::vector<uint64_t> sum(const std::vector<uint64_t> &values) override {
+        if (values.size() > MAX_SUM_VALUES) {
+            throw std::length_error("too many values for one sum");
+        }
+        // Two alternating sets of slots, so a worker already in the next sum cannot overwrite values the others are
+        // still reading
+        auto *slots = reinterpret_cast<uint64_t *>(base + sumOffset) + (sumRound++ & 1) * workers * MAX_SUM_VALUES;
+        std::copy(values.begin(), values.end(), slots + rank * MAX_SUM_VALUES);
+        barrier();
+
+        std::vector<uint64_t> totals(values.size(), 0);
+        for (int worker = 0; worker < workers; worker++) {
+            for (size_t i = 0; i < values.size(); i++) {
+                totals[i] += slots[worker * MAX_SUM_VALUES + i];
+            }
+        }
+        return totals;
+    }
+
+private:
+    struct alignas(64) Header {
+        std::atomic<uint32_t> arrived{0};
+        std::atomic<uint32_t> generation{0};
+        std::atomic<bool> aborted{false};
+    };
+
+    // Byte counters only ever grow; the sender owns head and the receiver owns tail
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+    };
+
+    static size_t roundUp(const size_t bytes) {
+        return (bytes + 63) & ~size_t{63};
+    }
+
+    [[nodiscard]] Ring &ring(const int index) const {
+        return *reinterpret_cast<Ring *>(base + ringOffset + index * sizeof(Ring));
+    }
+
+    [[nodiscard]] char *ringData(const int index) const {
+        return base + dataOffset + index * ringBytes;
+    }
+
+    size_t writeRing(const int index, const char *source, const size_t bytes) const {
+        Ring &target = ring(index);
+        const uint64_t head = target.head.load(std::memory_order_relaxed);
+        const uint64_t tail = target.tail.load(std::memory_order_acquire);
+        const size_t count = std::min<size_t>(bytes, ringBytes - (head - tail));
+        const size_t start = head % ringBytes;
+        const size_t first = std::min(count, ringBytes - start);
+        std::memcpy(ringData(index) + start, source, first);
+        std::memcpy(ringData(index), source + first, count - first);
+        target.head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t readRing(const int index, char *destination, const size_t bytes) const {
+        Ring &source = ring(index);
+        const uint64_t tail = source.tail.load(std::memory_order_relaxed);
+        const uint64_t head = source.head.load(std::memory_order_acquire);
+        const size_t count = std::min<size_t>(bytes, head - tail);
+        const size_t start = tail % ringBytes;
+        const size_t first = std::min(count, ringBytes - start);
+        std::memcpy(destination, ringData(index) + start, first);
+        std::memcpy(destination + first, ringData(index), count - first);
+        source.tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Messages are framed as their length followed by the payload. Both calls continue from done and return whether
+    // they moved any bytes.
+    bool send(const int index, const std::vector<char> &payload, size_t &done) const {
+        const uint64_t length = payload.size();
+        const size_t before = done;
+        while (done < sizeof(length) + payload.size()) {
+            const size_t written = done < sizeof(length)
+                                       ? writeRing(index, reinterpret_cast<const char *>(&length) + done,
+                                                   sizeof(length) - done)
+                                       : writeRing(index, payload.data() + (done - sizeof(length)),
+                                                   sizeof(length) + payload.size() - done);
+            if (written == 0) break;
+            done += written;
+        }
+        return done != before;
+    }
+
+    bool receive(const int index, std::vector<char> &payload, uint64_t &length, size_t &done) const {
+        const size_t before = done;
+        while (done < sizeof(length) || done < sizeof(length) + length) {
+            if (done < sizeof(length)) {
+                const size_t read = readRing(index, reinterpret_cast<char *>(&length) + done, sizeof(length) - done);
+                if (read == 0) break;
+                done += read;
+                if (done == sizeof(length)) payload.resize(length);
+            } else {
+                const size_t read = readRing(index, payload.data() + (done - sizeof(length)),
+                                             sizeof(length) + length - done);
+                if (read == 0) break;
+                done += read;
+            }
+        }
+        return done != before;
+    }
+
+    void barrier() const {
+        const uint32_t generation = header->generation.load(std::memory_order_acquire);
+        if (header->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == static_cast<uint32_t>(workers)) {
+            header->arrived.store(0, std::memory_order_relaxed);
+            header->generation.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        while (header->generation.load(std::memory_order_acquire) == generation) {
+            waitForPeers();
+        }
+    }
+
+    void waitForPeers() const {
+        if (header->aborted.load(std::memory_order_acquire)) {
+            throw std::runtime_error("another worker of the decomposed run failed");
+        }
+        std::this_thread::yield();
+    }
+
+    int workers;
+    int rank = 0;
+    size_t ringBytes;
+    size_t sumOffset = 0;
+    size_t ringOffset = 0;
+    size_t dataOffset = 0;
+    size_t mappingBytes = 0;
+    uint64_t sumRound = 0;
+    char *base = nullptr;
+    Header *header = nullptr;
+};
+
+struct DecompositionOptions {
+    int workers = 2;
+    int coresPerWorker = 1;
+    bool pinWorkers = true;
+    size_t ringBytes = SharedMemoryTransport::DEFAULT_RING_BYTES;
+};
+
+struct DecomposedRun {
+    RunResult result;
+    std::vector<SlabSummary> slabs;
+    bool completed = false;
+};
+
+// Runs one colony as a decomposed run on this host: one forked process per slab, connected by a
+// SharedMemoryTransport. If any worker fails, the others are released from their waits and the run is incomplete.
+inline DecomposedRun runDecomposed(const RunParameters &params, const DecompositionOptions &options) {
+    DecomposedRun run;
+    const std::vector<SlabRange> slabs = planSlabs(params, options.workers);
+    const int workers = static_cast<int>(slabs.size());
+    SharedMemoryTransport transport(workers, options.ringBytes);
+
+    // Workers report their results here: the run result, then one summary per slab
+    const size_t resultBytes = sizeof(RunResult) + workers * sizeof(SlabSummary);
+    void *resultMapping = mmap(nullptr, resultBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (!transport.isValid() || resultMapping == MAP_FAILED) {
+        if (resultMapping != MAP_FAILED) munmap(resultMapping, resultBytes);
+        return run;
+    }
+    auto *sharedResult = new(resultMapping) RunResult();
+    auto *sharedSlabs = reinterpret_cast<SlabSummary *>(static_cast<char *>(resultMapping) + sizeof(RunResult));
+    for (int rank = 0; rank < workers; rank++) {
+        new(sharedSlabs + rank) SlabSummary();
+    }
+
+    std::vector<pid_t> children;
+    bool failed = false;
+    for (int rank = 0; rank < workers && !failed; rank++) {
+        std::cout.flush();
+        std::cerr.flush();
+        const pid_t pid = fork();
+        if (pid == 0) {
+            transport.setRank(rank);
+#if defined(__linux__)
+            // Inherited affinity lists the cores this run may use; each worker takes its own share of them
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (options.pinWorkers && sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+                std::vector<int> cores;
+                for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                    if (CPU_ISSET(cpu, &allowed)) cores.push_back(cpu);
+                }
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (int i = 0; i < options.coresPerWorker; i++) {
+                    CPU_SET(cores[(static_cast<size_t>(rank) * options.coresPerWorker + i) % cores.size()], &set);
+                }
+                sched_setaffinity(0, sizeof(set), &set);
+            }
+#endif
+            tbb::global_control parallelism(tbb::global_control::max_allowed_parallelism, options.coresPerWorker);
+            try {
+                const RunResult result = runSlab(params, slabs[rank], transport, sharedSlabs[rank]);
+                if (rank == 0) *sharedResult = result;
+            } catch (const std::exception &e) {
+                std::cerr << "Slab worker " << rank << " failed: " << e.what() << std::endl;
+                transport.abort();
+                _exit(1);
+            }
+            _exit(0);
+        }
+        if (pid < 0) {
+            std::cerr << "Could not fork slab worker " << rank << ": " << std::strerror(errno) << std::endl;
+            failed = true;
+            transport.abort();
+        } else {
+            children.push_back(pid);
+        }
+    }
+
+    // Reaped in the order they finish, so a worker that dies releases the others right away
+    for (size_t remaining = children.size(); remaining > 0;) {
+        int status = 0;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+        if (std::ranges::find(children, pid) == children.end()) continue;
+        remaining--;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = true;
+            transport.abort();
+        }
+    }
+
+    run.completed = !failed;
+    run.result = *sharedResult;
+    run.slabs.assign(sharedSlabs, sharedSlabs + workers);
+    munmap(resultMapping, resultBytes);
+    return run;
+}
+#endif
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include "HeadlessRun.h"
+#include "StreamingStatistics.h"
+
+// Per-tick statistics over an ensemble of replicate runs of one parameter set. Memory grows with the tick count but
+// not with the number of replicates: each replicate is folded into running moments and quantile estimates as soon as
+// it finishes, and its trajectory is dropped.
+class EnsembleStatistics {
+public:
+    static constexpr int NEIGHBOR_BINS = 15;
+
+    // State of one replicate after one tick
+    struct TickState {
+        float confluence;
+        std::array<float, NEIGHBOR_BINS> neighborFractions; // share of cells with each neighbor count
+    };
+
+    explicit EnsembleStatistics(const int maxTicks)
+        : confluenceByTick(maxTicks),
+          neighborFractionsByTick(maxTicks) {
+    }
+
+    // A replicate that stopped early (boundary full or growth stalled) keeps its final state for the remaining ticks,
+    // so late ticks are not averaged over only the slowest colonies
+    void addReplicate(const RunResult &result, const std::vector<TickState> &trajectory) {
+        replicates++;
+        if (result.ticksToConfluence >= 0) {
+            ticksToConfluence.add(result.ticksToConfluence);
+            hoursToConfluence.add(result.hoursToConfluence);
+        }
+        finalConfluence.add(result.finalConfluence);
+        finalCells.add(static_cast<double>(result.finalCells));
+        meanTickMs.add(result.meanTickMs);
+        totalMs.add(result.totalMs);
+
+        if (trajectory.empty()) return;
+        for (size_t tick = 0; tick < confluenceByTick.size(); tick++) {
+            const TickState &state = trajectory[std::min(tick, trajectory.size() - 1)];
+            confluenceByTick[tick].add(state.confluence);
+            for (int bin = 0; bin < NEIGHBOR_BINS; bin++) {
+                neighborFractionsByTick[tick][bin].add(state.neighborFractions[bin]);
+            }
+        }
+    }
+
+    [[nodiscard]] size_t getReplicateCount() const {
+        return replicates;
+    }
+
+    [[nodiscard]] const StreamingSummary &getTicksToConfluence() const {
+        return ticksToConfluence;
+    }
+
+    [[nodiscard]] const StreamingSummary &getHoursToConfluence() const {
+        return hoursToConfluence;
+    }
+
+    // One row per end-of-run quantity. n counts the replicates the quantity exists for: runs that never reach the
+    // target confluence have no time to confluence.
+    void writeSummaryCsv(std::ostream &out) const {
+        out << "metric,n,mean,stddev,ci95_low,ci95_high,min,p05,median,p95,max\n";
+        writeSummaryRow(out, "ticks_to_confluence", ticksToConfluence);
+        writeSummaryRow(out, "hours_to_confluence", hoursToConfluence);
+        writeSummaryRow(out, "final_confluence", finalConfluence);
+        writeSummaryRow(out, "final_cells", finalCells);
+        writeSummaryRow(out, "mean_tick_ms", meanTickMs);
+        writeSummaryRow(out, "total_ms", totalMs);
+    }
+
+    void writeTicksCsv(std::ostream &out) const {
+        out << "tick,n,confluence_mean,confluence_stddev,confluence_ci95_low,confluence_ci95_high,confluence_p05,"
+               "confluence_median,confluence_p95";
+        for (int bin = 0; bin < NEIGHBOR_BINS; bin++) {
+            out << ",neighbors" << bin << "_mean,neighbors" << bin << "_stddev";
+        }
+        out << '\n';
+
+        for (size_t tick = 0; tick < confluenceByTick.size(); tick++) {
+            const StreamingSummary &confluence = confluenceByTick[tick];
+            const RunningStats &moments = confluence.getMoments();
+            if (moments.getCount() == 0) break;
+
+            out << tick + 1 << ',' << moments.getCount() << ',' << moments.getMean() << ',' << moments.getStdDev()
+                << ',' << moments.getMean() - moments.getConfidence95() << ','
+                << moments.getMean() + moments.getConfidence95() << ',' << confluence.getP05() << ','
+                << confluence.getMedian() << ',' << confluence.getP95();
+            for (const RunningStats &fraction: neighborFractionsByTick[tick]) {
+                out << ',' << fraction.getMean() << ',' << fraction.getStdDev();
+            }
+            out << '\n';
+        }
+    }
+
+private:
+    static void writeSummaryRow(std::ostream &out, const char *name, const StreamingSummary &summary) {
+        const RunningStats &moments = summary.getMoments();
+        out << name << ',' << moments.getCount() << ',' << moments.getMean() << ',' << moments.getStdDev() << ','
+            << moments.getMean() - moments.getConfidence95() << ',' << moments.getMean() + moments.getConfidence95()
+            << ',' << moments.getMin() << ',' << summary.getP05() << ',' << summary.getMedian() << ','
+            << summary.getP95() << ',' << moments.getMax() << '\n';
+    }
+
+    size_t replicates = 0;
+    StreamingSummary ticksToConfluence;
+    StreamingSummary hoursToConfluence;
+    StreamingSummary finalConfluence;
+    StreamingSummary finalCells;
+    StreamingSummary meanTickMs;
+    StreamingSummary totalMs;
+    std::vector<StreamingSummary> confluenceByTick;
+    std::vector<std::array<RunningStats, NEIGHBOR_BINS>> neighborFractionsByTick;
+};
+
+// Runs replicates of one parameter set, replicate i seeded with params.seed + i. Replicates are spread over the
+// cores by TBB and each simulation parallelizes internally as well, so small colonies keep every core busy through
+// replicate-level parallelism and large ones through their own loops. At most one replicate per worker thread is
+// alive at a time.
+inline EnsembleStatistics runEnsemble(const RunParameters &params, const int replicates, const int workers = 0) {
+    RunParameters replicateParams = params;
+    replicateParams.stopAtConfluence = false;
+
+    EnsembleStatistics statistics(params.maxTicks);
+    std::mutex statisticsMutex;
+    std::atomic<int> done{0};
+
+    tbb::task_arena arena(workers > 0 ? workers : tbb::task_arena::automatic);
+    arena.execute([&] {
+        tbb::parallel_for(
+            tbb::blocked_range<int>(0, replicates, 1),
+            [&](const tbb::blocked_range<int> &range) {
+                for (int replicate = range.begin(); replicate != range.end(); ++replicate) {
+                    RunParameters runParams = replicateParams;
+                    runParams.seed = params.seed + static_cast<uint64_t>(replicate);
+
+                    std::vector<EnsembleStatistics::TickState> trajectory;
+                    trajectory.reserve(params.maxTicks);
+                    const RunResult result = runHeadless(
+                        runParams,
+                        [&](const TickSample &sample, const ColonySimulation &simulation) {
+                            EnsembleStatistics::TickState state{sample.confluence, {}};
+                            const auto histogram = simulation.getNeighborCountHistogram();
+                            const float cells = static_cast<float>(std::max<size_t>(1, sample.cells));
+                            for (int bin = 0; bin < EnsembleStatistics::NEIGHBOR_BINS; bin++) {
+                                state.neighborFractions[bin] = static_cast<float>(histogram[bin]) / cells;
+                            }
+                            trajectory.push_back(state);
+                        }
+                    );
+
+                    {
+                        std::lock_guard lock(statisticsMutex);
+                        statistics.addReplicate(result, trajectory);
+                    }
+                    std::cerr << "[" << ++done << "/" << replicates << "] replicate " << replicate << " finished"
+                              << std::endl;
+                }
+            }
+        );
+    });
+
+    return statistics;
+}
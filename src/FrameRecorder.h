@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tbb/concurrent_queue.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+// Where the camera is at each tick of a recorded run
+class CameraPath {
+public:
+    struct Keyframe {
+        float tick;
+        Vector3 position;
+        Vector3 target;
+        float fovy;
+    };
+
+    // CSV of tick,px,py,pz,tx,ty,tz with an optional eighth fovy column, in any tick order. Lines that do not parse,
+    // such as a header, are skipped.
+    static std::optional<CameraPath> loadFromCsv(const std::string &path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Could not open camera path " << path << std::endl;
+            return std::nullopt;
+        }
+
+        CameraPath result;
+        std::string line;
+        while (std::getline(file, line)) {
+            std::stringstream stream(line);
+            std::string field;
+            std::vector<float> values;
+            while (std::getline(stream, field, ',')) {
+                try {
+                    values.push_back(std::stof(field));
+                } catch (const std::exception &) {
+                    values.clear();
+                    break;
+                }
+            }
+            if (values.size() != 7 && values.size() != 8) continue;
+            result.keyframes.push_back({
+                values[0], {values[1], values[2], values[3]}, {values[4], values[5], values[6]},
+                values.size() == 8 ? values[7] : DEFAULT_FOVY
+            });
+        }
+        if (result.keyframes.empty()) {
+            std::cerr << "No keyframes in camera path " << path << std::endl;
+            return std::nullopt;
+        }
+        std::ranges::sort(result.keyframes, {}, &Keyframe::tick);
+        return result;
+    }
+
+    // One turn around the box over ticks, looking at its center from above and outside it
+    static CameraPath orbit(const BoundingBox &bounds, const int ticks) {
+        const Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+        const Vector3 size = Vector3Subtract(bounds.max, bounds.min);
+        const float radius = 1.2f * std::max(size.x, size.z);
+        const float height = center.y + 0.8f * std::max(size.x, size.z);
+
+        constexpr int STEPS = 360;
+        CameraPath result;
+        for (int step = 0; step <= STEPS; step++) {
+            const float angle = 2.0f * PI * static_cast<float>(step) / STEPS;
+            result.keyframes.push_back({
+                static_cast<float>(ticks) * static_cast<float>(step) / STEPS,
+                {center.x + radius * std::cos(angle), height, center.z + radius * std::sin(angle)}, center,
+                DEFAULT_FOVY
+            });
+        }
+        return result;
+    }
+
+    // Interpolated linearly between keyframes, held at the first and last outside them
+    [[nodiscard]] Camera3D at(const float tick) const {
+        const auto next = std::ranges::upper_bound(keyframes, tick, {}, &Keyframe::tick);
+        if (next == keyframes.begin()) return toCamera(keyframes.front());
+        if (next == keyframes.end()) return toCamera(keyframes.back());
+
+        const Keyframe &a = *(next - 1);
+        const Keyframe &b = *next;
+        const float t = b.tick > a.tick ? (tick - a.tick) / (b.tick - a.tick) : 0.0f;
+        return toCamera({
+            tick, Vector3Lerp(a.position, b.position, t), Vector3Lerp(a.target, b.target, t), Lerp(a.fovy, b.fovy, t)
+        });
+    }
+
+private:
+    static constexpr float DEFAULT_FOVY = 45.0f;
+
+    static Camera3D toCamera(const Keyframe &keyframe) {
+        return {keyframe.position, keyframe.target, {0.0f, 1.0f, 0.0f}, keyframe.fovy, CAMERA_PERSPECTIVE};
+    }
+
+    std::vector<Keyframe> keyframes;
+};
+
+// Writes frames on a thread of its own so the simulation never waits on the disk. Frames wait in a bounded queue;
+// when the writer falls behind, new frames are dropped and counted instead of stalling the caller. Frames the writer
+// could not write, such as on a full disk or a closed pipe, are counted apart from the written ones.
+class FrameEncoder {
+public:
+    // RGB, 3 bytes per pixel, top row first
+    struct Frame {
+        int tick;
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+    };
+
+    // frame_00000.png, frame_00001.png, ... in directory, numbered by written frame
+    static std::unique_ptr<FrameEncoder> toPngSequence(const std::string &directory, const int capacity) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            std::cerr << "Could not create " << directory << ": " << error.message() << std::endl;
+            return nullptr;
+        }
+        return std::unique_ptr<FrameEncoder>(new FrameEncoder(directory, nullptr, capacity));
+    }
+
+    // Headerless RGB24 frames back to back, for ffmpeg -f rawvideo -pixel_format rgb24; "-" writes to stdout
+    static std::unique_ptr<FrameEncoder> toRawStream(const std::string &path, const int capacity) {
+        std::FILE *stream = path == "-" ? stdout : std::fopen(path.c_str(), "wb");
+#if defined(SIGPIPE)
+        // A reader that goes away should fail the writes, not end the process before it can report them
+        if (path == "-") std::signal(SIGPIPE, SIG_IGN);
+#endif
+        if (!stream) {
+            std::cerr << "Could not write " << path << std::endl;
+            return nullptr;
+        }
+        return std::unique_ptr<FrameEncoder>(new FrameEncoder("", stream, capacity));
+    }
+
+    FrameEncoder(const FrameEncoder &) = delete;
+    FrameEncoder &operator=(const FrameEncoder &) = delete;
+
+    ~FrameEncoder() {
+        finish();
+    }
+
+    // Queues the frame unless the queue is full. Returns whether it was accepted.
+    bool submit(Frame frame) {
+        if (queue.try_push(std::move(frame))) return true;
+        dropped++;
+        return false;
+    }
+
+    // Writes what is queued and waits for it. Returns whether every accepted frame was written.
+    bool finish() {
+        if (writer.joinable()) {
+            queue.push(Frame{-1, 0, 0, {}});
+            writer.join();
+            // Buffered frames only reach the file or pipe here
+            if (stream && (stream != stdout ? std::fclose(stream) : std::fflush(stream)) != 0) {
+                std::cerr << "Could not finish writing frames" << std::endl;
+                streamFailed = true;
+            }
+            stream = nullptr;
+        }
+        return failed == 0 && !streamFailed;
+    }
+
+    [[nodiscard]] size_t getWrittenCount() const {
+        return written;
+    }
+
+    [[nodiscard]] size_t getDroppedCount() const {
+        return dropped;
+    }
+
+    [[nodiscard]] size_t getFailedCount() const {
+        return failed;
+    }
+
+private:
+    FrameEncoder(std::string directory, std::FILE *stream, const int capacity)
+        : directory(std::move(directory)), stream(stream) {
+        queue.set_capacity(std::max(capacity, 1));
+        writer = std::thread([this] { writeFrames(); });
+    }
+
+    void writeFrames() {
+        Frame frame;
+        while (true) {
+            queue.pop(frame);
+            if (frame.tick < 0) break;
+            bool saved;
+            if (stream) {
+                saved = std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), stream) == frame.pixels.size();
+            } else {
+                char name[32];
+                std::snprintf(name, sizeof(name), "frame_%05zu.png", written);
+                const Image image = {
+                    frame.pixels.data(), frame.width, frame.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8
+                };
+                saved = ExportImage(image, (std::filesystem::path(directory) / name).string().c_str());
+            }
+            if (saved) {
+                written++;
+            } else {
+                failed++;
+            }
+        }
+    }
+
+    std::string directory;
+    std::FILE *stream;
+    tbb::concurrent_bounded_queue<Frame> queue;
+    std::thread writer;
+    // Only the writer thread changes written and failed, and only the submitting thread dropped; read them after finish
+    size_t written = 0;
+    size_t failed = 0;
+    size_t dropped = 0;
+    bool streamFailed = false;
+};
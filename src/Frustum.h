@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+// The six clip planes of a view-projection matrix, for skipping parts of the scene the camera cannot see. Planes are
+// stored as (a, b, c, d) with the inside where a*x + b*y + c*z + d >= 0.
+class Frustum {
+public:
+    // viewProjection as rlgl composes it: MatrixMultiply(modelview, projection)
+    explicit Frustum(const Matrix &viewProjection) {
+        const Matrix &m = viewProjection;
+        const Vector4 row0 = {m.m0, m.m4, m.m8, m.m12};
+        const Vector4 row1 = {m.m1, m.m5, m.m9, m.m13};
+        const Vector4 row2 = {m.m2, m.m6, m.m10, m.m14};
+        const Vector4 row3 = {m.m3, m.m7, m.m11, m.m15};
+
+        planes = {
+            add(row3, row0), subtract(row3, row0), // left, right
+            add(row3, row1), subtract(row3, row1), // bottom, top
+            add(row3, row2), subtract(row3, row2)  // near, far
+        };
+    }
+
+    // The camera of the current BeginMode3D block
+    [[nodiscard]] static Frustum fromCurrentCamera() {
+        return Frustum(MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+    }
+
+    // False only when the box is entirely outside one of the planes. Boxes near a frustum corner can pass without
+    // being visible, which only costs drawing them.
+    [[nodiscard]] bool intersects(const BoundingBox &box) const {
+        for (const Vector4 &plane: planes) {
+            // The corner furthest along the plane normal
+            const float x = plane.x >= 0.0f ? box.max.x : box.min.x;
+            const float y = plane.y >= 0.0f ? box.max.y : box.min.y;
+            const float z = plane.z >= 0.0f ? box.max.z : box.min.z;
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) return false;
+        }
+        return true;
+    }
+
+    // Left, right, bottom, top, near, far; the normals are not unit length
+    [[nodiscard]] const std::array<Vector4, 6> &getPlanes() const {
+        return planes;
+    }
+
+private:
+    [[nodiscard]] static Vector4 add(const Vector4 &a, const Vector4 &b) {
+        return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+    }
+
+    [[nodiscard]] static Vector4 subtract(const Vector4 &a, const Vector4 &b) {
+        return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+    }
+
+    std::array<Vector4, 6> planes;
+};
+
+// The region between two parallel planes, low <= dot(normal, p) <= high, for cutting the scene open to show a cross
+// section
+class Slab {
+public:
+    Slab(const Vector3 &normal, const float low, const float high)
+        : normal(Vector3Normalize(normal)), low(low), high(high) {}
+
+    [[nodiscard]] bool contains(const Vector3 &point) const {
+        const float along = Vector3DotProduct(normal, point);
+        return along >= low && along <= high;
+    }
+
+    // Whether any part of the box lies inside
+    [[nodiscard]] bool intersects(const BoundingBox &box) const {
+        const Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+        const Vector3 halfSize = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+        const float along = Vector3DotProduct(normal, center);
+        const float reach = std::abs(normal.x) * halfSize.x + std::abs(normal.y) * halfSize.y +
+                            std::abs(normal.z) * halfSize.z;
+        return along + reach >= low && along - reach <= high;
+    }
+
+    // Distance from point to the nearer face, negative outside
+    [[nodiscard]] float depth(const Vector3 &point) const {
+        const float along = Vector3DotProduct(normal, point);
+        return std::min(along - low, high - along);
+    }
+
+    // The same slab in the local coordinates of something drawn at offset
+    [[nodiscard]] Slab translated(const Vector3 &offset) const {
+        const float along = Vector3DotProduct(normal, offset);
+        return {normal, low - along, high - along};
+    }
+
+    [[nodiscard]] const Vector3 &getNormal() const {
+        return normal;
+    }
+
+    [[nodiscard]] float getLow() const {
+        return low;
+    }
+
+    [[nodiscard]] float getHigh() const {
+        return high;
+    }
+
+private:
+    Vector3 normal;
+    float low;
+    float high;
+};
+
+// How large world-space lengths appear on screen for a camera, for choosing how much detail to draw
+class ScreenProjection {
+public:
+    ScreenProjection(const Matrix &modelview, const Matrix &projection, const float viewportHeight)
+        : perspective(projection.m15 == 0.0f),
+          pixelsPerUnit(projection.m5 * viewportHeight * 0.5f) {
+        // The inverse view holds the camera's orientation and position in world space
+        billboardRotation = MatrixInvert(modelview);
+        eye = {billboardRotation.m12, billboardRotation.m13, billboardRotation.m14};
+        billboardRotation.m12 = billboardRotation.m13 = billboardRotation.m14 = 0.0f;
+    }
+
+    // The camera of the current BeginMode3D block
+    [[nodiscard]] static ScreenProjection fromCurrentCamera() {
+        return ScreenProjection(rlGetMatrixModelview(), rlGetMatrixProjection(), static_cast<float>(GetScreenHeight()));
+    }
+
+    // Height in pixels of something worldSize tall at position
+    [[nodiscard]] float pixelSize(const float worldSize, const Vector3 &position) const {
+        if (!perspective) return worldSize * pixelsPerUnit;
+        return worldSize * pixelsPerUnit / std::max(Vector3Distance(eye, position), 1e-3f);
+    }
+
+    // Turns geometry facing +z towards the camera, so flat impostors always show their face
+    [[nodiscard]] const Matrix &getBillboardRotation() const {
+        return billboardRotation;
+    }
+
+private:
+    bool perspective;
+    float pixelsPerUnit;
+    Vector3 eye;
+    Matrix billboardRotation;
+};
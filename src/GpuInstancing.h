@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include "CellIndex.h"
+#include "Frustum.h"
+#include "OctahedronGrid.h"
+
+#if defined(CELL_SIM_GPU_INSTANCING)
+// rlgl wraps compute dispatch and shader buffers but not memory barriers or indirect draws; raylib's own loader has
+// them once the window is up
+#include "external/glad.h"
+#endif
+
+// Builds the list of visible cells on the GPU instead of the render thread. The grid's occupancy is mirrored into a
+// shader buffer, one bit per site, uploading only the bricks that changed since the last frame. A compute pass counts
+// each occupied site's neighbors, keeps the sites with fewer than 14 inside the frustum, and appends their position
+// and neighbor count to an instance buffer whose count lands directly in an indirect draw command, so the CPU issues
+// one draw without reading anything back.
+//
+// Needs an OpenGL 4.3 context, which raylib only creates when built with OPENGL_VERSION 4.3 (the
+// CELL_SIM_GPU_INSTANCING CMake option). Everywhere else, including software GL without compute shaders, isSupported()
+// is false and the manager keeps drawing from the CPU-side lists.
+template<typename Index = CellIndex>
+class BasicGpuInstancer {
+public:
+    using Grid = BasicOctahedronGrid<Index>;
+
+    [[nodiscard]] static bool isSupported() {
+#if defined(CELL_SIM_GPU_INSTANCING)
+        return rlGetVersion() == RL_OPENGL_43;
+#else
+        return false;
+#endif
+    }
+
+    // drawShader reads instances from shader buffer binding 1 (see lighting_gpu_instances.vs); the caller keeps
+    // ownership and sets its lights. Check isValid() afterwards: a compute shader that fails to compile leaves it false.
+    BasicGpuInstancer(const Shader &drawShader, const char *computeShaderPath, const std::array<Color, 15> &colors)
+        : drawShader(drawShader) {
+        if (char *code = LoadFileText(computeShaderPath)) {
+            if (const unsigned int shaderId = rlCompileShader(code, RL_COMPUTE_SHADER); shaderId != 0) {
+                computeProgram = rlLoadComputeShaderProgram(shaderId);
+            }
+            UnloadFileText(code);
+        }
+        if (computeProgram == 0) {
+            std::cerr << "Instance list shader failed to load, drawing from the CPU instead" << std::endl;
+            return;
+        }
+
+        layoutLoc = rlGetLocationUniform(computeProgram, "gridLayout");
+        brickCountLoc = rlGetLocationUniform(computeProgram, "brickCount");
+        capacityLoc = rlGetLocationUniform(computeProgram, "capacity");
+        planesLoc = rlGetLocationUniform(computeProgram, "frustumPlanes");
+        siteSpacingLoc = rlGetLocationUniform(computeProgram, "siteSpacing");
+        drawCapacityLoc = GetShaderLocation(drawShader, "capacity");
+
+        std::array<Vector4, 15> normalized;
+        std::ranges::transform(colors, normalized.begin(), ColorNormalize);
+        SetShaderValueV(drawShader, GetShaderLocation(drawShader, "neighborColors"), normalized.data(),
+                        SHADER_UNIFORM_VEC4, static_cast<int>(normalized.size()));
+
+        commandBuffer = rlLoadShaderBuffer(sizeof(DrawCommand), nullptr, RL_DYNAMIC_COPY);
+    }
+
+    BasicGpuInstancer(const BasicGpuInstancer &) = delete;
+    BasicGpuInstancer &operator=(const BasicGpuInstancer &) = delete;
+
+    ~BasicGpuInstancer() {
+        if (occupancyBuffer != 0) rlUnloadShaderBuffer(occupancyBuffer);
+        if (instanceBuffer != 0) rlUnloadShaderBuffer(instanceBuffer);
+        if (commandBuffer != 0) rlUnloadShaderBuffer(commandBuffer);
+        if (computeProgram != 0) rlUnloadShaderProgram(computeProgram);
+    }
+
+    [[nodiscard]] bool isValid() const {
+        return computeProgram != 0;
+    }
+
+    // Draws mesh at every visible cell of a bounded grid. cellCount, the colony's current cell count, bounds the
+    // number of instances; cells inserted after it was read are dropped for this frame.
+    void draw(const Grid &grid, const size_t cellCount, const Frustum &frustum, const Mesh &mesh) {
+        const typename Grid::DenseLayout gridLayout = grid.getDenseLayout();
+        const size_t brickCount = static_cast<size_t>(gridLayout.bricksX) * gridLayout.bricksY * gridLayout.bricksZ;
+        if (brickCount == 0) return;
+
+        const bool resized = gridLayout != layout || occupancyBuffer == 0;
+        if (resized) {
+            if (occupancyBuffer != 0) rlUnloadShaderBuffer(occupancyBuffer);
+            occupancyBuffer = rlLoadShaderBuffer(
+                static_cast<unsigned int>(brickCount * BRICK_BYTES), nullptr, RL_DYNAMIC_DRAW);
+            layout = gridLayout;
+        }
+        uploadChangedBricks(grid, resized);
+        reserveInstances(cellCount);
+
+        // Flush raylib's pending immediate-mode geometry before drawing around its batching
+        rlDrawRenderBatchActive();
+
+        const DrawCommand command = {static_cast<uint32_t>(mesh.triangleCount * 3), 0, 0, 0, 0};
+        rlUpdateShaderBuffer(commandBuffer, &command, sizeof(command), 0);
+
+        const std::array<int, 6> layoutValues = {
+            layout.firstColumn, layout.length, layout.width, layout.height, layout.bricksX, layout.bricksZ
+        };
+        const int bricks = static_cast<int>(brickCount);
+        const int capacity = static_cast<int>(instanceCapacity);
+        rlEnableShader(computeProgram);
+        rlSetUniform(layoutLoc, layoutValues.data(), RL_SHADER_UNIFORM_INT, static_cast<int>(layoutValues.size()));
+        rlSetUniform(brickCountLoc, &bricks, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(capacityLoc, &capacity, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(planesLoc, frustum.getPlanes().data(), RL_SHADER_UNIFORM_VEC4, 6);
+        rlSetUniform(siteSpacingLoc, &Grid::SQUARE_DISTANCE, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlBindShaderBuffer(occupancyBuffer, 0);
+        rlBindShaderBuffer(instanceBuffer, 1);
+        rlBindShaderBuffer(commandBuffer, 2);
+
+        // One work group per brick, one invocation per row of 16 sites, in as many rows of groups as the dispatch
+        // limit needs
+        const unsigned int groupsX = static_cast<unsigned int>(std::min(brickCount, MAX_GROUPS_PER_DIMENSION));
+        const unsigned int groupsY = static_cast<unsigned int>((brickCount + groupsX - 1) / groupsX);
+        rlComputeShaderDispatch(groupsX, groupsY, 1);
+        rlDisableShader();
+        waitForInstanceList();
+
+        rlEnableShader(drawShader.id);
+        rlSetUniformMatrix(drawShader.locs[SHADER_LOC_MATRIX_MVP],
+                           MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+        const Vector4 white = {1.0f, 1.0f, 1.0f, 1.0f};
+        rlSetUniform(drawShader.locs[SHADER_LOC_COLOR_DIFFUSE], &white, RL_SHADER_UNIFORM_VEC4, 1);
+        rlSetUniform(drawCapacityLoc, &capacity, RL_SHADER_UNIFORM_INT, 1);
+        rlActiveTextureSlot(0);
+        rlEnableTexture(rlGetTextureIdDefault());
+        rlBindShaderBuffer(instanceBuffer, 1);
+        if (rlEnableVertexArray(mesh.vaoId)) {
+            drawIndirect();
+            rlDisableVertexArray();
+        }
+        rlDisableTexture();
+        rlDisableShader();
+    }
+
+private:
+    // Matches the indirect command layout glDrawElementsIndirect reads; the compute pass counts into instanceCount
+    struct DrawCommand {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        uint32_t baseVertex;
+        uint32_t baseInstance;
+    };
+
+    static constexpr size_t BRICK_BYTES = Grid::OCCUPANCY_WORDS_PER_BRICK * sizeof(uint32_t);
+    static constexpr size_t MAX_GROUPS_PER_DIMENSION = 65535;
+    // One vec4 per instance: position and neighbor count
+    static constexpr size_t INSTANCE_BYTES = 4 * sizeof(float);
+    static constexpr size_t MIN_INSTANCE_CAPACITY = 4096;
+
+    // Runs of consecutive changed bricks go up in one buffer update each
+    void uploadChangedBricks(const Grid &grid, const bool everyBrick) {
+        size_t runStart = 0;
+        const auto flush = [&] {
+            if (staging.empty()) return;
+            rlUpdateShaderBuffer(occupancyBuffer, staging.data(),
+                                 static_cast<unsigned int>(staging.size() * sizeof(uint32_t)),
+                                 static_cast<unsigned int>(runStart * BRICK_BYTES));
+            staging.clear();
+        };
+
+        grid.takeChangedOccupancy(Grid::OccupancyReader::GpuInstancer, [&](const size_t brickIndex, const uint32_t *words) {
+            if (staging.empty() || brickIndex != runStart + staging.size() / Grid::OCCUPANCY_WORDS_PER_BRICK) {
+                flush();
+                runStart = brickIndex;
+            }
+            staging.insert(staging.end(), words, words + Grid::OCCUPANCY_WORDS_PER_BRICK);
+        }, everyBrick);
+        flush();
+    }
+
+    // Room for every cell, with headroom so a growing colony does not reallocate every frame
+    void reserveInstances(const size_t cellCount) {
+        if (instanceBuffer != 0 && cellCount <= instanceCapacity) return;
+
+        instanceCapacity = std::max(MIN_INSTANCE_CAPACITY, cellCount + cellCount / 4);
+        if (instanceBuffer != 0) rlUnloadShaderBuffer(instanceBuffer);
+        instanceBuffer = rlLoadShaderBuffer(
+            static_cast<unsigned int>(instanceCapacity * INSTANCE_BYTES), nullptr, RL_DYNAMIC_COPY);
+    }
+
+    // The compute pass's writes must land before the vertex shader reads the instances and the draw reads its count
+    static void waitForInstanceList() {
+#if defined(CELL_SIM_GPU_INSTANCING)
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+#endif
+    }
+
+    void drawIndirect() const {
+#if defined(CELL_SIM_GPU_INSTANCING)
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif
+    }
+
+    Shader drawShader;
+    unsigned int computeProgram = 0;
+    int layoutLoc = -1;
+    int brickCountLoc = -1;
+    int capacityLoc = -1;
+    int planesLoc = -1;
+    int siteSpacingLoc = -1;
+    int drawCapacityLoc = -1;
+
+    typename Grid::DenseLayout layout = {};
+    unsigned int occupancyBuffer = 0;
+    unsigned int instanceBuffer = 0;
+    unsigned int commandBuffer = 0;
+    size_t instanceCapacity = 0;
+    std::vector<uint32_t> staging;
+};
+
+using GpuInstancer = BasicGpuInstancer<>;
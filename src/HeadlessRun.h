@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "BoundaryManager.h"
+#include "ColonySimulation.h"
+#include "SeedPatterns.h"
+#include "Units.h"
+
+// Everything a single headless run depends on. Sizes use the GUI's units: millimetres for the boundary footprint,
+// hours for the division time and world units for the starting spacing.
+struct RunParameters {
+    float lengthMm = 5.0f;
+    float widthMm = 5.0f;
+    int layers = 1;
+    float cellSplitHours = 8.0f;
+    float spawnChance = 1.0f;
+    float spacing = 20.0f;
+    BoundaryPreset shape = BoundaryPreset::Box;
+    SeedingOptions seeding;
+    float confluencePercent = 85.0f;
+    // Ensembles keep running past the target so every replicate contributes to every tick
+    bool stopAtConfluence = true;
+    int maxTicks = 1000;
+    // Ticks without a single division after which the colony counts as stalled
+    int stallTicks = 50;
+    uint64_t seed = 1;
+    // Cells per task in the simulation's per-cell loops; 0 keeps the simulation's default
+    size_t grainSize = 0;
+};
+
+struct RunResult {
+    size_t initialCells = 0;
+    size_t finalCells = 0;
+    size_t capacity = 0;
+    float finalConfluence = 0.0f; // percent of capacity
+    int ticks = 0;
+    int ticksToConfluence = -1;    // -1 if the target confluence was never reached
+    float hoursToConfluence = -1.0f;
+    double meanTickMs = 0.0;
+    double maxTickMs = 0.0;
+    double totalMs = 0.0;
+};
+
+struct TickSample {
+    int tick;
+    size_t cells;
+    float confluence; // percent of capacity
+    double tickMs;
+};
+
+inline const char *boundaryPresetName(const BoundaryPreset preset) {
+    switch (preset) {
+        case BoundaryPreset::Box: return "box";
+        case BoundaryPreset::RoundWell: return "round-well";
+        case BoundaryPreset::HangingDrop: return "hanging-drop";
+        case BoundaryPreset::Channel: return "channel";
+        case BoundaryPreset::Custom: return "custom";
+    }
+    return "box";
+}
+
+// Custom shapes come from mask files, which a parameter string cannot name, so only the built-in presets parse
+inline std::optional<BoundaryPreset> parseBoundaryPreset(const std::string &name) {
+    for (const BoundaryPreset preset: {BoundaryPreset::Box, BoundaryPreset::RoundWell, BoundaryPreset::HangingDrop,
+                                       BoundaryPreset::Channel}) {
+        if (name == boundaryPresetName(preset)) return preset;
+    }
+    return std::nullopt;
+}
+
+// Builds the boundary the GUI would build for these parameters (height from the layer count, like the layer spinner)
+inline std::shared_ptr<BoundaryManager> makeRunBoundary(const RunParameters &params) {
+    auto boundaryManager = std::make_shared<BoundaryManager>();
+    boundaryManager->setBoundaryWidth(params.lengthMm * MM_TO_WORLD_SCALE);
+    boundaryManager->setBoundaryDepth(params.widthMm * MM_TO_WORLD_SCALE);
+    boundaryManager->setBoundaryHeight(3.0f * OCTAHEDRON_WORLD_SIZE * static_cast<float>(params.layers));
+    // Same corner placement as the default boundary, so large footprints stay inside the lattice's positive octant
+    boundaryManager->setBoundaryCenter({
+        boundaryManager->getBoundaryWidth() / 2 + 10,
+        boundaryManager->getBoundaryHeight() / 2 + 10,
+        boundaryManager->getBoundaryDepth() / 2 + 10
+    });
+    boundaryManager->setBoundaryPreset(params.shape);
+    return boundaryManager;
+}
+
+// Runs one simulation until it reaches the target confluence, fills its boundary, stalls, or hits maxTicks.
+// onTick(const TickSample &, const BasicColonySimulation<Index> &) is called after every tick.
+template<typename Index = CellIndex, typename TickFn>
+RunResult runHeadless(const RunParameters &params, TickFn &&onTick) {
+    using Clock = std::chrono::steady_clock;
+    const auto runStart = Clock::now();
+
+    BasicColonySimulation<Index> simulation(makeRunBoundary(params), params.seed);
+    simulation.setOctahedraSpacing(params.spacing);
+    simulation.setOctahedraLayers(params.layers);
+    simulation.setSpawnChance(params.spawnChance);
+    simulation.setSeedingOptions(params.seeding);
+    if (params.grainSize > 0) simulation.setGrainSize(params.grainSize);
+    simulation.generateStartingPositions();
+    simulation.initializeLattice();
+
+    RunResult result;
+    result.initialCells = simulation.getCount();
+    result.capacity = simulation.getCapacity();
+    const auto confluenceOf = [&](const size_t cells) {
+        return result.capacity > 0 ? 100.0f * static_cast<float>(cells) / static_cast<float>(result.capacity) : 0.0f;
+    };
+
+    int idleTicks = 0;
+    double tickMsSum = 0.0;
+    while (result.ticks < params.maxTicks) {
+        const auto tickStart = Clock::now();
+        const size_t inserted = simulation.tick();
+        const double tickMs = std::chrono::duration<double, std::milli>(Clock::now() - tickStart).count();
+
+        result.ticks++;
+        tickMsSum += tickMs;
+        result.maxTickMs = std::max(result.maxTickMs, tickMs);
+
+        const size_t cells = simulation.getCount();
+        const float confluence = confluenceOf(cells);
+        onTick(TickSample{result.ticks, cells, confluence, tickMs}, simulation);
+
+        if (result.ticksToConfluence < 0 && confluence >= params.confluencePercent) {
+            result.ticksToConfluence = result.ticks;
+            result.hoursToConfluence = static_cast<float>(result.ticks) * params.cellSplitHours;
+            if (params.stopAtConfluence) break;
+        }
+        idleTicks = inserted == 0 ? idleTicks + 1 : 0;
+        if (idleTicks >= params.stallTicks || (result.capacity > 0 && cells >= result.capacity)) break;
+    }
+
+    result.finalCells = simulation.getCount();
+    result.finalConfluence = confluenceOf(result.finalCells);
+    result.meanTickMs = result.ticks > 0 ? tickMsSum / result.ticks : 0.0;
+    result.totalMs = std::chrono::duration<double, std::milli>(Clock::now() - runStart).count();
+    return result;
+}
+
+template<typename Index = CellIndex>
+RunResult runHeadless(const RunParameters &params) {
+    return runHeadless<Index>(params, [](const TickSample &, const BasicColonySimulation<Index> &) {});
+}
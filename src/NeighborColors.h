@@ -0,0 +1,26 @@
+#pragma once
+
+#include <array>
+
+#include "raylib.h"
+
+// Cell colors by neighbor count, shared by every way of drawing or rendering the colony
+constexpr std::array<Color, 15> NEIGHBOR_COLORS = {
+    {
+        BLUE, // 0 neighbors
+        SKYBLUE, // 1 neighbor
+        DARKBLUE, // 2 neighbors
+        PURPLE, // 3 neighbors
+        VIOLET, // 4 neighbors
+        PINK, // 5 neighbors
+        MAGENTA, // 6 neighbors
+        MAROON, // 7 neighbors
+        RED, // 8 neighbors
+        ORANGE, // 9 neighbors
+        GOLD, // 10 neighbors
+        YELLOW, // 11 neighbors
+        BEIGE, // 12 neighbors
+        LIME, // 13 neighbors
+        GREEN // 14 neighbors (fully surrounded)
+    }
+};
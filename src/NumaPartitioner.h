@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/info.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+
+// Spreads index ranges over the machine's NUMA nodes: one task arena per node, restricted to that node's cores, and
+// each node works on one contiguous slab of the range. Arrays that are first touched through parallelFor get each
+// slab's pages on the node that later works on the same slab, instead of every page landing on the node of the
+// thread that happened to allocate the array.
+//
+// Per-cell arrays grow, and are reserved well past their size, so slabs of their size or of their capacity would
+// drift apart. They are instead dealt to the nodes in fixed CELL_CHUNK chunks, round-robin, which holds for any size
+// and capacity: parallelForCells touches them and works on them that way.
+//
+// With a single node, or when TBB runs without its hwloc binding library (it then reports one node), this is a plain
+// parallel_for. Calls from inside an arena narrower than the machine (ensemble or sweep workers with a thread budget)
+// also stay plain, so they keep to the threads their caller gave them.
+class NumaPartitioner {
+public:
+    static NumaPartitioner &instance() {
+        static NumaPartitioner partitioner;
+        return partitioner;
+    }
+
+    [[nodiscard]] size_t getNodeCount() const {
+        return std::max<size_t>(1, arenas.size());
+    }
+
+    // Whether a parallelFor from the calling thread would be split across nodes
+    [[nodiscard]] bool spreadsAcrossNodes() const {
+        return arenas.size() > 1 && tbb::this_task_arena::max_concurrency() >= machineConcurrency;
+    }
+
+    // Cells per chunk of a per-cell array. A power of two, so any power-of-two block of cells stays within a chunk,
+    // and whole pages for element sizes down to one byte.
+    static constexpr size_t CELL_CHUNK = 1 << 14;
+
+    // Node node's slab of [0, count) is [slabBegin(count, node), slabBegin(count, node + 1))
+    [[nodiscard]] size_t slabBegin(const size_t count, const size_t node) const {
+        return count / getNodeCount() * node + std::min(node, count % getNodeCount());
+    }
+
+    // fn(const tbb::blocked_range<size_t> &) over [0, count), each node's slab on that node's threads
+    template<typename Fn>
+    void parallelFor(const size_t count, const size_t grainSize, const Fn &fn) const {
+        if (!spreadsAcrossNodes()) {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, count, grainSize), fn);
+            return;
+        }
+
+        std::vector<tbb::task_group> groups(arenas.size());
+        for (size_t node = 0; node < arenas.size(); node++) {
+            arenas[node]->execute([&, node] {
+                groups[node].run([&, node] {
+                    tbb::parallel_for(
+                        tbb::blocked_range<size_t>(slabBegin(count, node), slabBegin(count, node + 1), grainSize),
+                        fn
+                    );
+                });
+            });
+        }
+        for (size_t node = 0; node < arenas.size(); node++) {
+            arenas[node]->execute([&, node] { groups[node].wait(); });
+        }
+    }
+
+    // fn(const tbb::blocked_range<size_t> &) over [0, count), where index i is worked on by node (i / chunk) % nodes.
+    // Ranges never cross a chunk.
+    template<typename Fn>
+    void parallelForInterleaved(const size_t count, const size_t chunk, const size_t grainSize, const Fn &fn) const {
+        if (!spreadsAcrossNodes()) {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, count, grainSize), fn);
+            return;
+        }
+
+        const size_t chunkCount = (count + chunk - 1) / chunk;
+        std::vector<tbb::task_group> groups(arenas.size());
+        for (size_t node = 0; node < arenas.size(); node++) {
+            arenas[node]->execute([&, node] {
+                groups[node].run([&, node] {
+                    // The node's chunks are node, node + nodes, node + 2 * nodes, ...
+                    const size_t nodeChunks = chunkCount > node ? (chunkCount - node + arenas.size() - 1) / arenas.size()
+                                                                : 0;
+                    tbb::parallel_for(size_t{0}, nodeChunks, [&](const size_t ordinal) {
+                        const size_t begin = (node + ordinal * arenas.size()) * chunk;
+                        tbb::parallel_for(
+                            tbb::blocked_range<size_t>(begin, std::min(count, begin + chunk), grainSize), fn
+                        );
+                    });
+                });
+            });
+        }
+        for (size_t node = 0; node < arenas.size(); node++) {
+            arenas[node]->execute([&, node] { groups[node].wait(); });
+        }
+    }
+
+    // parallelForInterleaved over the cells of per-cell arrays, in the chunks their pages were placed by
+    template<typename Fn>
+    void parallelForCells(const size_t count, const size_t grainSize, const Fn &fn) const {
+        parallelForInterleaved(count, CELL_CHUNK, grainSize, fn);
+    }
+
+private:
+    NumaPartitioner()
+        : machineConcurrency(tbb::info::default_concurrency()) {
+        if (const auto nodes = tbb::info::numa_nodes(); nodes.size() > 1) {
+            for (const tbb::numa_node_id node: nodes) {
+                arenas.push_back(std::make_unique<tbb::task_arena>(tbb::task_arena::constraints(node)));
+            }
+        }
+    }
+
+    int machineConcurrency;
+    std::vector<std::unique_ptr<tbb::task_arena>> arenas;
+};
+
+// Allocator for the per-cell arrays. Large allocations are page-aligned and, when the work is spread across NUMA
+// nodes, first touched chunk by chunk on the nodes parallelForCells gives those chunks to. Touching commits the whole
+// allocation up front, including reserved capacity, so it is skipped on single-node machines where placement gains
+// nothing.
+template<typename T>
+struct FirstTouchAllocator {
+    using value_type = T;
+
+    // Smaller arrays are not worth a parallel pass
+    static constexpr size_t MIN_FIRST_TOUCH_BYTES = 4 << 20;
+    static constexpr size_t PAGE_BYTES = 4096;
+
+    FirstTouchAllocator() = default;
+
+    template<typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U> &) {
+    }
+
+    [[nodiscard]] T *allocate(const size_t n) {
+        if (n * sizeof(T) < MIN_FIRST_TOUCH_BYTES) return std::allocator<T>().allocate(n);
+
+        // Page-aligned so chunk boundaries fall on page boundaries
+        T *data = static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{PAGE_BYTES}));
+        if (const NumaPartitioner &numa = NumaPartitioner::instance(); numa.spreadsAcrossNodes()) {
+            constexpr size_t PAGE_ELEMENTS = std::max<size_t>(1, PAGE_BYTES / sizeof(T));
+            numa.parallelForCells(n, PAGE_ELEMENTS, [&](const tbb::blocked_range<size_t> &range) {
+                std::memset(static_cast<void *>(data + range.begin()), 0, (range.end() - range.begin()) * sizeof(T));
+            });
+        }
+        return data;
+    }
+
+    void deallocate(T *data, const size_t n) {
+        if (n * sizeof(T) < MIN_FIRST_TOUCH_BYTES) {
+            std::allocator<T>().deallocate(data, n);
+        } else {
+            ::operator delete(data, std::align_val_t{PAGE_BYTES});
+        }
+    }
+
+    template<typename U>
+    bool operator==(const FirstTouchAllocator<U> &) const {
+        return true;
+    }
+};
+
+template<typename T>
+using NumaVector = std::vector<T, FirstTouchAllocator<T>>;
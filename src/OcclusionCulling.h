@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#if defined(CELL_SIM_DEPTH_READBACK)
+// rlgl has no pixel buffers or fences; raylib's own loader has them once the window is up
+#include "external/glad.h"
+#endif
+
+// A max-depth mip chain over one frame's depth buffer, for skipping boxes hidden behind what that frame drew. Level 0
+// halves the viewport, and every texel holds the farthest depth of the pixels it covers, so a box nearer than none of
+// them was covered everywhere it could reach.
+class DepthPyramid {
+public:
+    // depth holds width x height window-space depths, bottom row first, as glReadPixels returns them; viewProjection
+    // is the camera they were drawn with, as rlgl composes it: MatrixMultiply(modelview, projection)
+    void build(const float *depth, const int width, const int height, const Matrix &viewProjection) {
+        this->viewProjection = viewProjection;
+        this->width = width;
+        this->height = height;
+
+        size_t levelCount = 0;
+        for (int w = width, h = height; w > 1 || h > 1; w = (w + 1) / 2, h = (h + 1) / 2) levelCount++;
+        levels.resize(std::max<size_t>(levelCount, 1));
+
+        const float *source = depth;
+        int sourceWidth = width;
+        int sourceHeight = height;
+        for (Level &level: levels) {
+            reduce(source, sourceWidth, sourceHeight, level);
+            source = level.depth.data();
+            sourceWidth = level.width;
+            sourceHeight = level.height;
+        }
+    }
+
+    // True only when every pixel the box could cover already held something nearer than all of it. Boxes reaching
+    // behind the camera or off the captured viewport are never hidden.
+    [[nodiscard]] bool hides(const BoundingBox &box) const {
+        if (levels.empty()) return false;
+
+        const Matrix &m = viewProjection;
+        float nearest = 1.0f;
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        for (int corner = 0; corner < 8; corner++) {
+            const float x = corner & 1 ? box.max.x : box.min.x;
+            const float y = corner & 2 ? box.max.y : box.min.y;
+            const float z = corner & 4 ? box.max.z : box.min.z;
+            const float clipW = m.m3 * x + m.m7 * y + m.m11 * z + m.m15;
+            if (clipW <= std::numeric_limits<float>::epsilon()) return false;
+
+            const float depth = (m.m2 * x + m.m6 * y + m.m10 * z + m.m14) / clipW * 0.5f + 0.5f;
+            if (depth < 0.0f) return false;
+            const float screenX = ((m.m0 * x + m.m4 * y + m.m8 * z + m.m12) / clipW * 0.5f + 0.5f) * width;
+            const float screenY = ((m.m1 * x + m.m5 * y + m.m9 * z + m.m13) / clipW * 0.5f + 0.5f) * height;
+            nearest = std::min(nearest, depth);
+            minX = std::min(minX, screenX);
+            minY = std::min(minY, screenY);
+            maxX = std::max(maxX, screenX);
+            maxY = std::max(maxY, screenY);
+        }
+        if (minX < 0.0f || minY < 0.0f || maxX >= width || maxY >= height) return false;
+
+        // The finest level where the box spans at most four texels each way
+        size_t level = 0;
+        int x0 = static_cast<int>(minX) >> 1;
+        int y0 = static_cast<int>(minY) >> 1;
+        int x1 = static_cast<int>(maxX) >> 1;
+        int y1 = static_cast<int>(maxY) >> 1;
+        while ((x1 - x0 > 3 || y1 - y0 > 3) && level + 1 < levels.size()) {
+            level++;
+            x0 >>= 1;
+            y0 >>= 1;
+            x1 >>= 1;
+            y1 >>= 1;
+        }
+
+        const Level &texels = levels[level];
+        float farthest = 0.0f;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                farthest = std::max(farthest, texels.depth[static_cast<size_t>(y) * texels.width + x]);
+            }
+        }
+        return nearest > farthest;
+    }
+
+private:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depth;
+    };
+
+    // Halves source into level, rounding up so the last row and column of an odd size are kept
+    static void reduce(const float *source, const int sourceWidth, const int sourceHeight, Level &level) {
+        level.width = (sourceWidth + 1) / 2;
+        level.height = (sourceHeight + 1) / 2;
+        level.depth.resize(static_cast<size_t>(level.width) * level.height);
+
+        tbb::parallel_for(tbb::blocked_range<int>(0, level.height), [&](const tbb::blocked_range<int> &rows) {
+            for (int y = rows.begin(); y != rows.end(); y++) {
+                const float *below = source + static_cast<size_t>(2 * y) * sourceWidth;
+                const float *above = source + static_cast<size_t>(std::min(2 * y + 1, sourceHeight - 1)) * sourceWidth;
+                float *out = level.depth.data() + static_cast<size_t>(y) * level.width;
+                for (int x = 0; x < level.width; x++) {
+                    const int left = 2 * x;
+                    const int right = std::min(left + 1, sourceWidth - 1);
+                    out[x] = std::max(std::max(below[left], below[right]), std::max(above[left], above[right]));
+                }
+            }
+        });
+    }
+
+    Matrix viewProjection = {};
+    int width = 0;
+    int height = 0;
+    std::vector<Level> levels;
+};
+
+// Copies each frame's depth into a pixel buffer without waiting for it, and turns the copy into a DepthPyramid one
+// frame later, once the GPU has finished it. Boxes are then tested against the previous frame's camera, so something
+// the camera has just turned towards can appear a frame late.
+//
+// Needs raylib's OpenGL 3.3 or 4.3 backend and its glad loader (CELL_SIM_DEPTH_READBACK, set when raylib is built from
+// source). Everywhere else isSupported() is false and nothing is culled by depth.
+class DepthReadback {
+public:
+    [[nodiscard]] static bool isSupported() {
+#if defined(CELL_SIM_DEPTH_READBACK)
+        const int version = rlGetVersion();
+        return version == RL_OPENGL_33 || version == RL_OPENGL_43;
+#else
+        return false;
+#endif
+    }
+
+    DepthReadback() {
+#if defined(CELL_SIM_DEPTH_READBACK)
+        for (Slot &slot: slots) glGenBuffers(1, &slot.buffer);
+#endif
+    }
+
+    ~DepthReadback() {
+#if defined(CELL_SIM_DEPTH_READBACK)
+        for (Slot &slot: slots) {
+            if (slot.fence) glDeleteSync(static_cast<GLsync>(slot.fence));
+            glDeleteBuffers(1, &slot.buffer);
+        }
+#endif
+    }
+
+    DepthReadback(const DepthReadback &) = delete;
+    DepthReadback &operator=(const DepthReadback &) = delete;
+
+    // Call once per frame before resolve() and capture(), whether or not the frame captures anything
+    void nextFrame() {
+        frame++;
+    }
+
+    // The pyramid over the previous frame's capture, or nullptr when that frame captured nothing or its copy has not
+    // arrived yet
+    [[nodiscard]] const DepthPyramid *resolve() {
+#if defined(CELL_SIM_DEPTH_READBACK)
+        Slot &slot = slots[(frame - 1) % slots.size()];
+        if (!slot.fence || slot.frame + 1 != frame) return nullptr;
+
+        const GLenum status = glClientWaitSync(static_cast<GLsync>(slot.fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return nullptr;
+        glDeleteSync(static_cast<GLsync>(slot.fence));
+        slot.fence = nullptr;
+
+        bool mapped = false;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (const void *depth = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(slot.bytes),
+                                                 GL_MAP_READ_BIT)) {
+            pyramid.build(static_cast<const float *>(depth), slot.width, slot.height, slot.viewProjection);
+            mapped = glUnmapBuffer(GL_PIXEL_PACK_BUFFER) == GL_TRUE;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return mapped ? &pyramid : nullptr;
+#else
+        return nullptr;
+#endif
+    }
+
+    // Queues a copy of the current viewport's depth, drawn with viewProjection; call once the occluders are drawn
+    void capture(const Matrix &viewProjection) {
+#if defined(CELL_SIM_DEPTH_READBACK)
+        // A multisampled depth buffer cannot be read back without resolving it first
+        GLint sampleBuffers = 0;
+        glGetIntegerv(GL_SAMPLE_BUFFERS, &sampleBuffers);
+        if (sampleBuffers != 0) return;
+
+        rlDrawRenderBatchActive();
+        GLint viewport[4] = {};
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        if (viewport[2] <= 0 || viewport[3] <= 0) return;
+
+        Slot &slot = slots[frame % slots.size()];
+        if (slot.fence) glDeleteSync(static_cast<GLsync>(slot.fence));
+        slot.width = viewport[2];
+        slot.height = viewport[3];
+        slot.viewProjection = viewProjection;
+        slot.frame = frame;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (const size_t bytes = static_cast<size_t>(slot.width) * slot.height * sizeof(float); bytes != slot.bytes) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+            slot.bytes = bytes;
+        }
+        glReadPixels(viewport[0], viewport[1], slot.width, slot.height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#else
+        (void) viewProjection;
+#endif
+    }
+
+private:
+    // Two copies in flight: the one being resolved and the one being captured
+    struct Slot {
+        unsigned int buffer = 0;
+        void *fence = nullptr;
+        size_t bytes = 0;
+        int width = 0;
+        int height = 0;
+        Matrix viewProjection = {};
+        uint64_t frame = 0;
+    };
+
+    std::array<Slot, 2> slots;
+    uint64_t frame = 0;
+    DepthPyramid pyramid;
+};
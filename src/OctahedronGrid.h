@@ -1,149 +1,664 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <tuple>
-#include <unordered_map>
+#include <tbb/blocked_range.h>
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
 #include "raylib.h"
+#include "raymath.h"
+#include "CellIndex.h"
+#include "NumaPartitioner.h"
 
-class OctahedronGrid {
+template<typename Index = CellIndex>
+class BasicOctahedronGrid {
 public:
+    using IndexType = Index;
+    static constexpr Index INVALID_INDEX = INVALID_CELL_INDEX<Index>;
+
     struct CellData {
-        size_t cellIndex;
+        Index cellIndex;
         Vector3 position;
     };
 
     static constexpr float SQUARE_DISTANCE = 2.0f * 2.82842712475f;
     static constexpr float HEXAGON_DISTANCE = SQUARE_DISTANCE * 0.866025404f;
 
+    // Sites are stored in dense bricks of BRICK_SIZE^3. A bounded grid allocates all of its bricks up front; an
+    // unbounded grid keeps them in a hash map and allocates each brick the first time a cell lands in it, so memory
+    // follows the occupied volume instead of the bounding box.
+    static constexpr int BRICK_SHIFT = 4;
+    static constexpr int BRICK_SIZE = 1 << BRICK_SHIFT;
+    static constexpr int BRICK_SITES = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+    // Consumers that mirror the occupancy and only want the bricks that changed since they last looked. Each has its
+    // own bit in a brick's unseen set, so they do not consume each other's changes.
+    enum class OccupancyReader : uint8_t {
+        GpuInstancer,
+        SurfaceMesher,
+        VolumeRenderer
+    };
+
+    static constexpr uint8_t ALL_OCCUPANCY_READERS = 0xFF;
+
+    enum class InsertStatus : uint8_t {
+        Inserted,
+        Occupied,  // slot already taken, either before the batch or by an earlier claim within it
+        Rejected   // outside the grid, blocked by the boundary mask or refused by the caller's filter
+    };
+
+    struct BatchInsertResult {
+        Index firstIndex = 0;
+        size_t insertedCount = 0;
+        std::vector<InsertStatus> status; // one entry per input position
+
+        [[nodiscard]] bool wasInserted(const size_t i) const { return status[i] == InsertStatus::Inserted; }
+    };
+
     struct NeighborAvailability {
         std::vector<Vector3> positions;
         int squareFaces = 0;
         int hexagonFaces = 0;
     };
 
-    explicit OctahedronGrid(const size_t length = 50, const size_t width = 50, const size_t height = 50)
+    explicit BasicOctahedronGrid(const size_t length = 50, const size_t width = 50, const size_t height = 50)
         : gridLength(length), gridWidth(width), gridHeight(height) {
         resizeGrid(length, width, height);
     }
 
-    void resizeGrid(const size_t length, const size_t width, const size_t height) {
+    // Switches to a bounded grid of the given size (in lattice sites). Existing cells are discarded. The grid covers
+    // columns firstX to firstX + length - 1 along x, so a slab of a larger lattice only allocates its own sites.
+    void resizeGrid(const size_t length, const size_t width, const size_t height, const int firstX = 0) {
+        resetCount++;
+        unbounded = false;
+        firstColumn = firstX;
         gridLength = length;
         gridWidth = width;
         gridHeight = height;
-        
-        grid.resize(gridLength * gridWidth * gridHeight, {SIZE_MAX, {0, 0, 0}});
-        indexToPositionMap.reserve(length * width * height);
+
+        bricksX = (length + BRICK_SIZE - 1) >> BRICK_SHIFT;
+        bricksY = (height + BRICK_SIZE - 1) >> BRICK_SHIFT;
+        bricksZ = (width + BRICK_SIZE - 1) >> BRICK_SHIFT;
+
+        sparseBricks.clear();
+        denseBricks.clear();
+        denseBricks.resize(bricksX * bricksY * bricksZ);
+        // Each brick is allocated and zeroed by a thread of the NUMA node that later works on its slab of the
+        // lattice, so its pages live on that node
+        NumaPartitioner::instance().parallelFor(
+            denseBricks.size(), 1,
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t brickIndex = range.begin(); brickIndex != range.end(); ++brickIndex) {
+                    denseBricks[brickIndex] = std::make_unique<Brick>();
+                }
+            }
+        );
+
+        cellPositions.clear();
+        cellPositions.reserve(length * width * height);
+    }
+
+    // Switches to an unbounded grid that grows in every direction as cells are inserted. Existing cells are
+    // discarded. Used when the boundary is disabled, so there is nothing to size the lattice from.
+    void makeUnbounded() {
+        resetCount++;
+        unbounded = true;
+        firstColumn = 0;
+        gridLength = gridWidth = gridHeight = 0;
+        bricksX = bricksY = bricksZ = 0;
+        denseBricks.clear();
+        sparseBricks.clear();
+        cellPositions.clear();
+    }
+
+    [[nodiscard]] bool isUnbounded() const {
+        return unbounded;
+    }
+
+    // Bumped whenever cells are discarded or bricks replaced, so readers mirroring the grid know to start over
+    [[nodiscard]] uint64_t getResetCount() const {
+        return resetCount.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] size_t getAllocatedBrickCount() const {
+        return unbounded ? sparseBricks.size() : denseBricks.size();
+    }
+
+    void reserveCells(const size_t n) {
+        cellPositions.reserve(n);
+    }
+
+    ~BasicOctahedronGrid() {
+        cellPositions.clear();
+        sparseBricks.clear();
+        denseBricks.clear();
+    }
+
+    // Removes every cell but keeps the grid dimensions and the baked boundary mask
+    void clear() {
+        resetCount++;
+        if (unbounded) {
+            sparseBricks.clear();
+        } else {
+            NumaPartitioner::instance().parallelFor(
+                denseBricks.size(), 1,
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t brickIndex = range.begin(); brickIndex != range.end(); ++brickIndex) {
+                        Brick &brick = *denseBricks[brickIndex];
+                        brick.cellIndices.fill(INVALID_INDEX);
+                        brick.visibleCells = 0;
+                        brick.unseenBy = ALL_OCCUPANCY_READERS;
+                        for (auto &state: brick.states) {
+                            state &= SITE_BLOCKED;
+                        }
+                    }
+                }
+            );
+        }
+        cellPositions.clear();
+    }
+
+    // Rasterizes a boundary into the lattice once: every site whose center fails isInside is marked permanently
+    // blocked, so the spawn path only has to test the site state instead of evaluating the boundary per candidate.
+    // Calling it again replaces the previous mask. Unbounded grids have no boundary and ignore this.
+    template<typename InsideFn>
+    void bakeBoundary(const InsideFn &isInside) {
+        if (unbounded) return;
+
+        NumaPartitioner::instance().parallelFor(
+            denseBricks.size(), 1,
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t brickIndex = range.begin(); brickIndex != range.end(); ++brickIndex) {
+                    Brick &brick = *denseBricks[brickIndex];
+                    const int originX = firstColumn + (static_cast<int>(brickIndex % bricksX) << BRICK_SHIFT);
+                    const int originZ = static_cast<int>((brickIndex / bricksX) % bricksZ) << BRICK_SHIFT;
+                    const int originY = static_cast<int>(brickIndex / (bricksX * bricksZ)) << BRICK_SHIFT;
+
+                    for (int ly = 0; ly < BRICK_SIZE; ly++) {
+                        for (int lz = 0; lz < BRICK_SIZE; lz++) {
+                            for (int lx = 0; lx < BRICK_SIZE; lx++) {
+                                const int x = originX + lx;
+                                const int y = originY + ly;
+                                const int z = originZ + lz;
+                                uint8_t &state = brick.states[siteOffset(x, y, z)];
+                                const bool inside = isValidCoordinate(x, y, z) &&
+                                                    isInside(coordinatesToPosition(x, y, z));
+                                state = inside ? state & ~SITE_BLOCKED : state | SITE_BLOCKED;
+                            }
+                        }
+                    }
+                }
+            }
+        );
+    }
+
+    void clearBoundary() {
+        for (const auto &brick: denseBricks) {
+            for (auto &state: brick->states) {
+                state &= ~SITE_BLOCKED;
+            }
+        }
+    }
+
+    // Number of sites a bounded grid can ever fill: valid sites not blocked by the boundary mask, optionally only in
+    // columns firstX to endX - 1. Unbounded grids have no such limit and report 0.
+    [[nodiscard]] size_t countUnblockedSites(const int firstX = std::numeric_limits<int>::min(),
+                                             const int endX = std::numeric_limits<int>::max()) const {
+        if (unbounded) return 0;
+
+        return tbb::parallel_reduce(
+            tbb::blocked_range<size_t>(0, denseBricks.size()),
+            size_t{0},
+            [&](const tbb::blocked_range<size_t> &range, size_t count) {
+                for (size_t brickIndex = range.begin(); brickIndex != range.end(); ++brickIndex) {
+                    const Brick &brick = *denseBricks[brickIndex];
+                    const int originX = firstColumn + (static_cast<int>(brickIndex % bricksX) << BRICK_SHIFT);
+                    const int originZ = static_cast<int>((brickIndex / bricksX) % bricksZ) << BRICK_SHIFT;
+                    const int originY = static_cast<int>(brickIndex / (bricksX * bricksZ)) << BRICK_SHIFT;
+
+                    for (int ly = 0; ly < BRICK_SIZE; ly++) {
+                        for (int lz = 0; lz < BRICK_SIZE; lz++) {
+                            for (int lx = 0; lx < BRICK_SIZE; lx++) {
+                                const int x = originX + lx;
+                                const int y = originY + ly;
+                                const int z = originZ + lz;
+                                if (x >= firstX && x < endX && isValidCoordinate(x, y, z) &&
+                                    !(brick.states[siteOffset(x, y, z)] & SITE_BLOCKED)) {
+                                    count++;
+                                }
+                            }
+                        }
+                    }
+                }
+                return count;
+            },
+            std::plus<>()
+        );
+    }
+
+    void insert(const Vector3 &worldPos, const Index cellIndex) {
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(worldPos));
+        if (!isValidCoordinate(x, y, z)) return;
+
+        Brick &brick = findOrCreateBrick(x, y, z);
+        const int offset = siteOffset(x, y, z);
+        brick.cellIndices[offset] = cellIndex;
+        brick.states[offset] |= SITE_OCCUPIED;
+        brick.unseenBy.store(ALL_OCCUPANCY_READERS, std::memory_order_release);
+        if (cellIndex >= cellPositions.size()) {
+            cellPositions.resize(cellIndex + 1, {0.0f, 0.0f, 0.0f});
+        }
+        cellPositions[cellIndex] = coordinatesToPosition(x, y, z);
+    }
+
+    // Inserts many positions at once. Each chunk of the batch first claims its sites with a CAS on the site state (so
+    // duplicates inside the batch resolve to a single winner and blocked sites are refused), then reserves a contiguous
+    // range of cell indices with one fetch_add and fills in the slots. onInserted(cellIndex, sitePos) is called
+    // concurrently for every accepted position so callers can initialize their own per-cell attributes in the same pass.
+    // Positions that would push the cell count past the range of Index are rejected.
+    template<typename AcceptFn, typename InsertedFn>
+    BatchInsertResult insertBatch(const std::vector<Vector3> &positions, const AcceptFn &accept,
+                                  const InsertedFn &onInserted) {
+        BatchInsertResult result;
+        result.firstIndex = static_cast<Index>(cellPositions.size());
+        result.status.resize(positions.size(), InsertStatus::Rejected);
+        const size_t count = std::min<size_t>(positions.size(), INVALID_INDEX - cellPositions.size());
+        if (count == 0) return result;
+
+        cellPositions.resize(result.firstIndex + count);
+        std::atomic<Index> nextCellIndex{result.firstIndex};
+
+        constexpr size_t INSERT_GRAIN_SIZE = 4096;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, count, INSERT_GRAIN_SIZE),
+            [&](const tbb::blocked_range<size_t> &range) {
+                Index claimed = 0;
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    const Vector3 snappedPos = snapToGridPosition(positions[i]);
+                    auto [x, y, z] = positionToCoordinates(snappedPos);
+                    if (!isValidCoordinate(x, y, z) || !accept(snappedPos)) continue;
+
+                    Brick &brick = findOrCreateBrick(x, y, z);
+                    uint8_t expected = 0;
+                    if (std::atomic_ref(brick.states[siteOffset(x, y, z)]).compare_exchange_strong(
+                        expected, SITE_OCCUPIED)) {
+                        brick.unseenBy.store(ALL_OCCUPANCY_READERS, std::memory_order_release);
+                        result.status[i] = InsertStatus::Inserted;
+                        claimed++;
+                    } else if (expected & SITE_OCCUPIED) {
+                        result.status[i] = InsertStatus::Occupied;
+                    }
+                }
+                if (claimed == 0) return;
+
+                Index cellIndex = nextCellIndex.fetch_add(claimed, std::memory_order_relaxed);
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    if (result.status[i] != InsertStatus::Inserted) continue;
+
+                    auto [x, y, z] = positionToCoordinates(snapToGridPosition(positions[i]));
+                    const Vector3 sitePos = coordinatesToPosition(x, y, z);
+                    findOrCreateBrick(x, y, z).cellIndices[siteOffset(x, y, z)] = cellIndex;
+                    cellPositions[cellIndex] = sitePos;
+                    onInserted(cellIndex, sitePos);
+                    cellIndex++;
+                }
+            }
+        );
+
+        const Index endIndex = nextCellIndex.load();
+        cellPositions.resize(endIndex);
+        result.insertedCount = endIndex - result.firstIndex;
+        return result;
     }
 
-    ~OctahedronGrid() {
-        indexToPositionMap.clear();
-        grid.clear();
+    template<typename InsertedFn>
+    BatchInsertResult insertBatch(const std::vector<Vector3> &positions, const InsertedFn &onInserted) {
+        return insertBatch(positions, [](const Vector3 &) { return true; }, onInserted);
     }
 
-    void insert(const Vector3 &worldPos, const size_t cellIndex) {
-        const Vector3 snappedPos = snapToGridPosition(worldPos);
-        const size_t index = positionToIndex(snappedPos);
-        if (index >= grid.size()) return;
+    // Marks sites as occupied by cells that live in another lattice, such as the halo copy of a neighboring slab's
+    // edge. Ghosts block divisions and count as neighbors but have no cell index. Positions must be distinct.
+    void insertGhosts(const std::vector<Vector3> &positions) {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, positions.size(), 4096),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    auto [x, y, z] = positionToCoordinates(snapToGridPosition(positions[i]));
+                    if (!isValidCoordinate(x, y, z)) continue;
+                    Brick &brick = findOrCreateBrick(x, y, z);
+                    std::atomic_ref(brick.states[siteOffset(x, y, z)]).fetch_or(SITE_OCCUPIED, std::memory_order_relaxed);
+                    brick.unseenBy.store(ALL_OCCUPANCY_READERS, std::memory_order_release);
+                }
+            }
+        );
+    }
 
-        grid[index] = {cellIndex, snappedPos};
-        indexToPositionMap[cellIndex] = snappedPos;
+    [[nodiscard]] size_t getCellCount() const {
+        return cellPositions.size();
     }
 
     [[nodiscard]] bool isOccupied(const Vector3 &worldPos) const {
-        const Vector3 snappedPos = snapToGridPosition(worldPos);
-        const size_t index = positionToIndex(snappedPos);
-        if (index >= grid.size()) return false;
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(worldPos));
+        if (!isValidCoordinate(x, y, z)) return false;
 
-        return grid[index].cellIndex != SIZE_MAX;
+        return siteState(x, y, z) & SITE_OCCUPIED;
+    }
+
+    // A site can receive a new cell if it is inside the grid, empty, and not blocked by the boundary mask
+    [[nodiscard]] bool isAvailable(const Vector3 &worldPos) const {
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(worldPos));
+        if (!isValidCoordinate(x, y, z)) return false;
+
+        return siteState(x, y, z) == 0;
     }
 
     [[nodiscard]] std::vector<Vector3>
-    getNeighborPositions(const Vector3 &pos, const bool filterOccupied = false) const {
+    getNeighborPositions(const Vector3 &pos, const bool filterUnavailable = false) const {
         std::vector<Vector3> neighbors{};
         neighbors.reserve(14); // 6 square + 8 hex neighbors
 
-        const Vector3 snappedPos = snapToGridPosition(pos);
-        auto [x, y, z] = positionToCoordinates(snappedPos);
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(pos));
+        forEachNeighborCoordinate(x, y, z, [&](const int nx, const int ny, const int nz) {
+            if (!filterUnavailable || siteState(nx, ny, nz) == 0) {
+                neighbors.push_back(coordinatesToPosition(nx, ny, nz));
+            }
+        });
 
-        // 6 square face neighbors
-        std::array<std::tuple<int, int, int>, 6> squareDirs = {
-            std::make_tuple(x - 1, y, z),
-            std::make_tuple(x + 1, y, z),
-            std::make_tuple(x, y, z - 1),
-            std::make_tuple(x, y, z + 1),
-            std::make_tuple(x, y - 1, z),
-            std::make_tuple(x, y + 1, z)
+        return neighbors;
+    }
+
+    [[nodiscard]] std::vector<CellData> getOccupiedNeighbors(const Vector3 &pos) const {
+        std::vector<CellData> neighbors;
+        neighbors.reserve(14);
+
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(pos));
+        forEachNeighborCoordinate(x, y, z, [&](const int nx, const int ny, const int nz) {
+            if (const Brick *brick = findBrick(nx, ny, nz)) {
+                if (const Index cellIndex = brick->cellIndices[siteOffset(nx, ny, nz)]; cellIndex != INVALID_INDEX) {
+                    neighbors.push_back({cellIndex, coordinatesToPosition(nx, ny, nz)});
+                }
+            }
+        });
+
+        return neighbors;
+    }
+
+    // Occupied neighbor sites, ghosts included. Cheaper than getOccupiedNeighbors when only the count matters.
+    [[nodiscard]] int countOccupiedNeighbors(const Vector3 &pos) const {
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(pos));
+        return countOccupiedNeighbors(x, y, z);
+    }
+
+    [[nodiscard]] int countOccupiedNeighbors(const int x, const int y, const int z) const {
+        int count = 0;
+        forEachNeighborCoordinate(x, y, z, [&](const int nx, const int ny, const int nz) {
+            if (siteState(nx, ny, nz) & SITE_OCCUPIED) count++;
+        });
+        return count;
+    }
+
+    // The cells whose neighbor count includes the site at pos, so the ones a cell placed there changes. Missing cells
+    // are INVALID_INDEX.
+    [[nodiscard]] std::array<Index, 14> findCellsNeighboring(const Vector3 &pos) const {
+        std::array<Index, 14> cells;
+        cells.fill(INVALID_INDEX);
+        size_t count = 0;
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(pos));
+        forEachReverseNeighborCoordinate(x, y, z, [&](const int nx, const int ny, const int nz) {
+            const Brick *brick = findBrick(nx, ny, nz);
+            cells[count++] = brick ? brick->cellIndices[siteOffset(nx, ny, nz)] : INVALID_INDEX;
+        });
+        return cells;
+    }
+
+    // Keeps the per-brick visible cell counts in step with the colony's visibility flags; delta is +1 or -1
+    void addVisibleCell(const Vector3 &pos, const int delta) {
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(pos));
+        if (!isValidCoordinate(x, y, z)) return;
+        findOrCreateBrick(x, y, z).visibleCells.fetch_add(static_cast<uint32_t>(delta), std::memory_order_relaxed);
+    }
+
+    // Bricks are the renderer's chunks. onChunk(const BoundingBox &bounds, const auto &forEachCell) is called for every
+    // brick with visible cells, with its world-space bounds padded by a cell's size; calling forEachCell(onCell) walks
+    // the brick's cells as onCell(Index, const Vector3 &position), so chunks the caller skips cost nothing more. Safe
+    // to run while another thread inserts, as the renderer does.
+    template<typename ChunkFn>
+    void forEachChunk(const ChunkFn &onChunk) const {
+        const auto visit = [&](const Brick &brick, const int originX, const int originY, const int originZ) {
+            if (brick.visibleCells.load(std::memory_order_relaxed) == 0) return;
+
+            const auto forEachCell = [&](const auto &onCell) {
+                for (int ly = 0; ly < BRICK_SIZE; ly++) {
+                    for (int lz = 0; lz < BRICK_SIZE; lz++) {
+                        for (int lx = 0; lx < BRICK_SIZE; lx++) {
+                            const int x = originX + lx;
+                            const int y = originY + ly;
+                            const int z = originZ + lz;
+                            if (const Index index = brick.cellIndices[siteOffset(x, y, z)]; index != INVALID_INDEX) {
+                                onCell(index, coordinatesToPosition(x, y, z));
+                            }
+                        }
+                    }
+                }
+            };
+            onChunk(getBrickBounds(originX, originY, originZ), forEachCell);
         };
 
-        for (const auto &[nx, ny, nz]: squareDirs) {
-            if (isValidCoordinate(nx, ny, nz)) {
-                if (Vector3 neighborPos = coordinatesToPosition(nx, ny, nz);
-                    !filterOccupied || !isOccupied(neighborPos)) {
-                    neighbors.push_back(neighborPos);
+        if (unbounded) {
+            for (const auto &[key, brick]: sparseBricks) {
+                visit(*brick, unpackBrickCoordinate(key) << BRICK_SHIFT, unpackBrickCoordinate(key >> 42) << BRICK_SHIFT,
+                      unpackBrickCoordinate(key >> 21) << BRICK_SHIFT);
+            }
+            return;
+        }
+        for (size_t brickIndex = 0; brickIndex < denseBricks.size(); brickIndex++) {
+            visit(*denseBricks[brickIndex],
+                  firstColumn + (static_cast<int>(brickIndex % bricksX) << BRICK_SHIFT),
+                  static_cast<int>(brickIndex / (bricksX * bricksZ)) << BRICK_SHIFT,
+                  static_cast<int>((brickIndex / bricksX) % bricksZ) << BRICK_SHIFT);
+        }
+    }
+
+    // Like forEachChunk, but for cutting the colony open: visits every brick with cells in layers firstLayer..lastLayer,
+    // whether or not any of its cells are visible, and walks only the cells in those layers. A bounded grid only looks
+    // at the bricks those layers cross.
+    template<typename ChunkFn>
+    void forEachChunkInLayers(const int firstLayer, const int lastLayer, const ChunkFn &onChunk) const {
+        if (firstLayer > lastLayer) return;
+        const auto visit = [&](const Brick &brick, const int originX, const int originY, const int originZ) {
+            const int firstY = std::max(firstLayer - originY, 0);
+            const int lastY = std::min(lastLayer - originY, BRICK_SIZE - 1);
+            if (firstY > lastY) return;
+
+            const auto forEachCell = [&](const auto &onCell) {
+                for (int ly = firstY; ly <= lastY; ly++) {
+                    for (int lz = 0; lz < BRICK_SIZE; lz++) {
+                        for (int lx = 0; lx < BRICK_SIZE; lx++) {
+                            const int x = originX + lx;
+                            const int y = originY + ly;
+                            const int z = originZ + lz;
+                            if (const Index index = brick.cellIndices[siteOffset(x, y, z)]; index != INVALID_INDEX) {
+                                onCell(index, coordinatesToPosition(x, y, z));
+                            }
+                        }
+                    }
                 }
+            };
+            onChunk(getBrickBounds(originX, originY, originZ), forEachCell);
+        };
+
+        if (unbounded) {
+            for (const auto &[key, brick]: sparseBricks) {
+                visit(*brick, unpackBrickCoordinate(key) << BRICK_SHIFT, unpackBrickCoordinate(key >> 42) << BRICK_SHIFT,
+                      unpackBrickCoordinate(key >> 21) << BRICK_SHIFT);
+            }
+            return;
+        }
+        // Dense bricks are numbered layer of bricks by layer of bricks, so the crossed ones are one contiguous run
+        const size_t bricksPerLayer = bricksX * bricksZ;
+        const int firstBrickY = std::max(firstLayer, 0) >> BRICK_SHIFT;
+        const int lastBrickY = std::min(lastLayer, static_cast<int>(gridHeight) - 1) >> BRICK_SHIFT;
+        for (int by = firstBrickY; by <= lastBrickY; by++) {
+            for (size_t i = 0; i < bricksPerLayer; i++) {
+                const size_t brickIndex = by * bricksPerLayer + i;
+                visit(*denseBricks[brickIndex], firstColumn + (static_cast<int>(i % bricksX) << BRICK_SHIFT),
+                      by << BRICK_SHIFT, static_cast<int>(i / bricksX) << BRICK_SHIFT);
             }
         }
+    }
 
-        // 8 hexagonal face neighbors with offset for top and bottom layers
-        std::array<std::tuple<int, int, int>, 8> hexDirs = {
-            std::make_tuple(x - 1, y + 1, z - 1),
-            std::make_tuple(x, y + 1, z - 1),
-            std::make_tuple(x, y + 1, z),
-            std::make_tuple(x - 1, y + 1, z),
-            std::make_tuple(x - 1, y - 1, z - 1),
-            std::make_tuple(x, y - 1, z - 1),
-            std::make_tuple(x, y - 1, z),
-            std::make_tuple(x - 1, y - 1, z)
+    // Brick layout of a bounded grid, for mirroring its occupancy elsewhere such as on the GPU. Bricks are numbered
+    // x-fastest, then z, then y, with brick x counted from firstColumn.
+    struct DenseLayout {
+        int firstColumn;
+        int length;
+        int width;
+        int height;
+        int bricksX;
+        int bricksY;
+        int bricksZ;
+
+        bool operator==(const DenseLayout &) const = default;
+    };
+
+    static constexpr int OCCUPANCY_WORDS_PER_BRICK = BRICK_SITES / 32;
+
+    [[nodiscard]] DenseLayout getDenseLayout() const {
+        return {
+            firstColumn, static_cast<int>(gridLength), static_cast<int>(gridWidth), static_cast<int>(gridHeight),
+            static_cast<int>(bricksX), static_cast<int>(bricksY), static_cast<int>(bricksZ)
         };
+    }
 
-        for (const auto &[nx, ny, nz]: hexDirs) {
-            if (isValidCoordinate(nx, ny, nz)) {
-                if (Vector3 neighborPos = coordinatesToPosition(nx, ny, nz);
-                    !filterOccupied || !isOccupied(neighborPos)) {
-                    neighbors.push_back(neighborPos);
+    // Calls onBrick(brickIndex, const uint32_t *words) for every brick of a bounded grid whose occupancy changed since
+    // reader's last call, or for every brick with everyBrick. Bit (ly << 8 | lz << 4 | lx) is set when the site at that
+    // offset from the brick's origin is occupied. Safe while the simulation keeps inserting: a site claimed during the
+    // copy marks its brick again for the next call.
+    template<typename Fn>
+    void takeChangedOccupancy(const OccupancyReader reader, const Fn &onBrick, const bool everyBrick = false) const {
+        if (unbounded) return;
+
+        std::array<uint32_t, OCCUPANCY_WORDS_PER_BRICK> words;
+        for (size_t brickIndex = 0; brickIndex < denseBricks.size(); brickIndex++) {
+            Brick &brick = *denseBricks[brickIndex];
+            if (!takeUnseen(brick, reader) && !everyBrick) continue;
+
+            const int originX = firstColumn + (static_cast<int>(brickIndex % bricksX) << BRICK_SHIFT);
+            words.fill(0);
+            for (int site = 0; site < BRICK_SITES; site++) {
+                const int offset = (site & ~BRICK_MASK) | ((originX + site) & BRICK_MASK);
+                if (std::atomic_ref(brick.states[offset]).load(std::memory_order_relaxed) & SITE_OCCUPIED) {
+                    words[site >> 5] |= 1u << (site & 31);
                 }
             }
+            onBrick(brickIndex, words.data());
         }
-
-        return neighbors;
     }
 
-    [[nodiscard]] std::vector<CellData> getOccupiedNeighbors(const Vector3 &pos) const {
-        std::vector<CellData> neighbors;
-        neighbors.reserve(14);
+    // Calls onBrick(originX, originY, originZ) for every allocated brick whose occupancy changed since reader's last
+    // call, or for every brick with everyBrick, in either layout. As with takeChangedOccupancy, changes made during the
+    // walk show up in the next one.
+    template<typename Fn>
+    void takeChangedBricks(const OccupancyReader reader, const Fn &onBrick, const bool everyBrick = false) const {
+        if (unbounded) {
+            for (const auto &[key, brick]: sparseBricks) {
+                if (!takeUnseen(*brick, reader) && !everyBrick) continue;
+                onBrick(unpackBrickCoordinate(key) << BRICK_SHIFT, unpackBrickCoordinate(key >> 42) << BRICK_SHIFT,
+                        unpackBrickCoordinate(key >> 21) << BRICK_SHIFT);
+            }
+            return;
+        }
+        for (size_t brickIndex = 0; brickIndex < denseBricks.size(); brickIndex++) {
+            if (!takeUnseen(*denseBricks[brickIndex], reader) && !everyBrick) continue;
+            onBrick(firstColumn + (static_cast<int>(brickIndex % bricksX) << BRICK_SHIFT),
+                    static_cast<int>(brickIndex / (bricksX * bricksZ)) << BRICK_SHIFT,
+                    static_cast<int>((brickIndex / bricksX) % bricksZ) << BRICK_SHIFT);
+        }
+    }
 
-        for (auto neighborPositions = getNeighborPositions(pos, false); const auto &neighborPos: neighborPositions) {
-            if (const size_t index = positionToIndex(neighborPos);
-                index < grid.size() && grid[index].cellIndex != SIZE_MAX) {
-                neighbors.push_back(grid[index]);
+    // Calls fn(x, y, z) for every occupied site of the brick whose origin is (originX, originY, originZ)
+    template<typename Fn>
+    void forEachOccupiedSite(const int originX, const int originY, const int originZ, const Fn &fn) const {
+        if (!isValidCoordinate(originX, originY, originZ)) return;
+        const Brick *brick = findBrick(originX, originY, originZ);
+        if (!brick) return;
+
+        for (int ly = 0; ly < BRICK_SIZE; ly++) {
+            for (int lz = 0; lz < BRICK_SIZE; lz++) {
+                for (int lx = 0; lx < BRICK_SIZE; lx++) {
+                    const int x = originX + lx;
+                    const int y = originY + ly;
+                    const int z = originZ + lz;
+                    if (std::atomic_ref(brick->states[siteOffset(x, y, z)]).load(std::memory_order_relaxed) &
+                        SITE_OCCUPIED) {
+                        fn(x, y, z);
+                    }
+                }
             }
         }
+    }
 
-        return neighbors;
+    [[nodiscard]] bool isSiteOccupied(const int x, const int y, const int z) const {
+        return isValidCoordinate(x, y, z) && (siteState(x, y, z) & SITE_OCCUPIED);
+    }
+
+    // World-space extent of every allocated brick together; an empty box at the origin when there are none
+    [[nodiscard]] BoundingBox getAllocatedBounds() const {
+        std::optional<BoundingBox> bounds;
+        const auto extend = [&](const int originX, const int originY, const int originZ) {
+            const BoundingBox brick = getBrickBounds(originX, originY, originZ);
+            bounds = bounds ? BoundingBox{Vector3Min(bounds->min, brick.min), Vector3Max(bounds->max, brick.max)}
+                            : brick;
+        };
+
+        if (unbounded) {
+            for (const auto &[key, brick]: sparseBricks) {
+                extend(unpackBrickCoordinate(key) << BRICK_SHIFT, unpackBrickCoordinate(key >> 42) << BRICK_SHIFT,
+                       unpackBrickCoordinate(key >> 21) << BRICK_SHIFT);
+            }
+        } else if (!denseBricks.empty()) {
+            extend(firstColumn, 0, 0);
+            extend(firstColumn + static_cast<int>((bricksX - 1) << BRICK_SHIFT),
+                   static_cast<int>((bricksY - 1) << BRICK_SHIFT), static_cast<int>((bricksZ - 1) << BRICK_SHIFT));
+        }
+        return bounds.value_or(BoundingBox{{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}});
     }
 
     [[nodiscard]] std::vector<Vector3> getAvailableNeighbors(const Vector3 &pos) const {
         return getNeighborPositions(pos, true);
     }
 
-    [[nodiscard]] size_t findCellIndex(const Vector3 &worldPos) const {
-        const Vector3 snappedPos = snapToGridPosition(worldPos);
-        const size_t index = positionToIndex(snappedPos);
+    [[nodiscard]] Index findCellIndex(const Vector3 &worldPos) const {
+        auto [x, y, z] = positionToCoordinates(snapToGridPosition(worldPos));
+        if (!isValidCoordinate(x, y, z)) return INVALID_INDEX;
 
-        if (index >= grid.size()) return SIZE_MAX;
-        return grid[index].cellIndex;
+        const Brick *brick = findBrick(x, y, z);
+        return brick ? brick->cellIndices[siteOffset(x, y, z)] : INVALID_INDEX;
     }
 
-    [[nodiscard]] Vector3 getPositionForIndex(const size_t cellIndex) const {
-        // O(1) lookup using the map
-        if (const auto it = indexToPositionMap.find(cellIndex); it != indexToPositionMap.end()) {
-            return it->second;
+    [[nodiscard]] Vector3 getPositionForIndex(const Index cellIndex) const {
+        // Cell indices are dense, so this is a plain array lookup
+        if (cellIndex < cellPositions.size()) {
+            return cellPositions[cellIndex];
         }
         return {0.0f, 0.0f, 0.0f};
     }
 
+    // Lattice coordinates (x column, y layer, z row) of the site nearest to a world position
+    [[nodiscard]] static std::tuple<int, int, int> getSiteCoordinates(const Vector3 &worldPos) {
+        return positionToCoordinates(snapToGridPosition(worldPos));
+    }
+
     [[nodiscard]] static Vector3 snapToGridPosition(const Vector3 &position) {
         constexpr float halfSquareDist = SQUARE_DISTANCE * 0.5f;
         const float snappedY = roundf(position.y / halfSquareDist) * halfSquareDist;
@@ -169,18 +684,169 @@ public:
 private:
     static constexpr float POSITION_EPSILON = HEXAGON_DISTANCE * 0.5f;
 
+    // Per-site state bits, kept apart from the cell indices so occupancy tests touch one byte per site
+    static constexpr uint8_t SITE_OCCUPIED = 1 << 0;
+    static constexpr uint8_t SITE_BLOCKED = 1 << 1;
+
+    static constexpr int BRICK_MASK = BRICK_SIZE - 1;
+    // Unbounded grids pack brick coordinates into 21 bits each, which limits them to +-2^24 sites per axis
+    static constexpr int UNBOUNDED_LIMIT = 1 << 24;
+
+    struct Brick {
+        std::array<Index, BRICK_SITES> cellIndices;
+        std::array<uint8_t, BRICK_SITES> states;
+        // Cells in the brick the colony marks visible, so the renderer can skip bricks buried inside the colony
+        std::atomic<uint32_t> visibleCells{0};
+        // One bit per OccupancyReader that has not seen the brick's latest occupancy; every change sets them all
+        std::atomic<uint8_t> unseenBy{ALL_OCCUPANCY_READERS};
+
+        Brick() {
+            cellIndices.fill(INVALID_INDEX);
+            states.fill(0);
+        }
+    };
+
+    bool unbounded = false;
+    int firstColumn = 0;
     size_t gridLength;
     size_t gridWidth;
     size_t gridHeight;
-    std::vector<CellData> grid;
-    std::unordered_map<size_t, Vector3> indexToPositionMap;
+    size_t bricksX = 0;
+    size_t bricksY = 0;
+    size_t bricksZ = 0;
+    std::vector<std::unique_ptr<Brick>> denseBricks;
+    tbb::concurrent_unordered_map<uint64_t, std::unique_ptr<Brick>> sparseBricks;
+    NumaVector<Vector3> cellPositions;
+    std::atomic<uint64_t> resetCount{0};
+
+    // Whether reader has yet to see brick's latest occupancy; marks it seen
+    [[nodiscard]] static bool takeUnseen(Brick &brick, const OccupancyReader reader) {
+        const uint8_t bit = 1u << static_cast<int>(reader);
+        return brick.unseenBy.fetch_and(static_cast<uint8_t>(~bit), std::memory_order_acq_rel) & bit;
+    }
+
+    [[nodiscard]] static int siteOffset(const int x, const int y, const int z) {
+        return ((((y & BRICK_MASK) << BRICK_SHIFT) | (z & BRICK_MASK)) << BRICK_SHIFT) | (x & BRICK_MASK);
+    }
+
+    // One 21-bit field of a brick key back to a signed brick coordinate
+    [[nodiscard]] static int unpackBrickCoordinate(const uint64_t bits) {
+        constexpr int fieldBits = 21;
+        const int value = static_cast<int>(bits & ((1u << fieldBits) - 1));
+        return value >= 1 << (fieldBits - 1) ? value - (1 << fieldBits) : value;
+    }
+
+    // Odd layers sit half a step further along x and z, and a cell reaches a square distance around its center
+    [[nodiscard]] static BoundingBox getBrickBounds(const int originX, const int originY, const int originZ) {
+        const Vector3 first = coordinatesToPosition(originX, originY, originZ);
+        const Vector3 last = coordinatesToPosition(originX + BRICK_SIZE - 1, originY + BRICK_SIZE - 1,
+                                                   originZ + BRICK_SIZE - 1);
+        constexpr float pad = SQUARE_DISTANCE;
+        return {
+            {first.x - pad, first.y - pad, first.z - pad},
+            {last.x + SQUARE_DISTANCE * 0.5f + pad, last.y + pad, last.z + SQUARE_DISTANCE * 0.5f + pad}
+        };
+    }
+
+    [[nodiscard]] static uint64_t brickKey(const int bx, const int by, const int bz) {
+        constexpr uint64_t mask = (1u << 21) - 1;
+        return ((static_cast<uint64_t>(by) & mask) << 42) | ((static_cast<uint64_t>(bz) & mask) << 21) |
+               (static_cast<uint64_t>(bx) & mask);
+    }
+
+    // Coordinates must already be valid. Returns nullptr for bricks an unbounded grid has not allocated yet.
+    [[nodiscard]] const Brick *findBrick(const int x, const int y, const int z) const {
+        const int bx = x >> BRICK_SHIFT;
+        const int by = y >> BRICK_SHIFT;
+        const int bz = z >> BRICK_SHIFT;
+        if (!unbounded) {
+            return denseBricks[(by * bricksZ + bz) * bricksX + ((x - firstColumn) >> BRICK_SHIFT)].get();
+        }
+        const auto it = sparseBricks.find(brickKey(bx, by, bz));
+        return it != sparseBricks.end() ? it->second.get() : nullptr;
+    }
+
+    // Safe to call concurrently: when two threads touch a new brick at once, one allocation wins and the other is freed
+    Brick &findOrCreateBrick(const int x, const int y, const int z) {
+        if (!unbounded) {
+            return *denseBricks[((y >> BRICK_SHIFT) * bricksZ + (z >> BRICK_SHIFT)) * bricksX +
+                                ((x - firstColumn) >> BRICK_SHIFT)];
+        }
+        const uint64_t key = brickKey(x >> BRICK_SHIFT, y >> BRICK_SHIFT, z >> BRICK_SHIFT);
+        if (const auto it = sparseBricks.find(key); it != sparseBricks.end()) {
+            return *it->second;
+        }
+        return *sparseBricks.emplace(key, std::make_unique<Brick>()).first->second;
+    }
+
+    [[nodiscard]] uint8_t siteState(const int x, const int y, const int z) const {
+        const Brick *brick = findBrick(x, y, z);
+        return brick ? brick->states[siteOffset(x, y, z)] : 0;
+    }
+
+    template<typename Fn>
+    void forEachNeighborCoordinate(const int x, const int y, const int z, const Fn &fn) const {
+        // 6 square face neighbors
+        const std::array<std::tuple<int, int, int>, 6> squareDirs = {
+            std::make_tuple(x - 1, y, z),
+            std::make_tuple(x + 1, y, z),
+            std::make_tuple(x, y, z - 1),
+            std::make_tuple(x, y, z + 1),
+            std::make_tuple(x, y - 1, z),
+            std::make_tuple(x, y + 1, z)
+        };
+
+        for (const auto &[nx, ny, nz]: squareDirs) {
+            if (isValidCoordinate(nx, ny, nz)) {
+                fn(nx, ny, nz);
+            }
+        }
+
+        // 8 hexagonal face neighbors with offset for top and bottom layers
+        const std::array<std::tuple<int, int, int>, 8> hexDirs = {
+            std::make_tuple(x - 1, y + 1, z - 1),
+            std::make_tuple(x, y + 1, z - 1),
+            std::make_tuple(x, y + 1, z),
+            std::make_tuple(x - 1, y + 1, z),
+            std::make_tuple(x - 1, y - 1, z - 1),
+            std::make_tuple(x, y - 1, z - 1),
+            std::make_tuple(x, y - 1, z),
+            std::make_tuple(x - 1, y - 1, z)
+        };
 
-    [[nodiscard]] size_t positionToIndex(const Vector3 &pos) const {
-        auto [x, y, z] = positionToCoordinates(pos);
-        if (!isValidCoordinate(x, y, z)) return SIZE_MAX;
+        for (const auto &[nx, ny, nz]: hexDirs) {
+            if (isValidCoordinate(nx, ny, nz)) {
+                fn(nx, ny, nz);
+            }
+        }
+    }
 
-        // Using the formula: (Y_n*X*Z) + (Z_n*X) + (X_n) = n
-        return (y * gridLength * gridWidth) + (z * gridLength) + x;
+    // The sites whose neighborhood, as forEachNeighborCoordinate walks it, contains (x, y, z). The hexagonal offsets are
+    // not symmetric, so for those faces these are the opposite offsets.
+    template<typename Fn>
+    void forEachReverseNeighborCoordinate(const int x, const int y, const int z, const Fn &fn) const {
+        const std::array<std::tuple<int, int, int>, 14> reverseDirs = {
+            std::make_tuple(x - 1, y, z),
+            std::make_tuple(x + 1, y, z),
+            std::make_tuple(x, y, z - 1),
+            std::make_tuple(x, y, z + 1),
+            std::make_tuple(x, y - 1, z),
+            std::make_tuple(x, y + 1, z),
+            std::make_tuple(x + 1, y - 1, z + 1),
+            std::make_tuple(x, y - 1, z + 1),
+            std::make_tuple(x, y - 1, z),
+            std::make_tuple(x + 1, y - 1, z),
+            std::make_tuple(x + 1, y + 1, z + 1),
+            std::make_tuple(x, y + 1, z + 1),
+            std::make_tuple(x, y + 1, z),
+            std::make_tuple(x + 1, y + 1, z)
+        };
+
+        for (const auto &[nx, ny, nz]: reverseDirs) {
+            if (isValidCoordinate(nx, ny, nz)) {
+                fn(nx, ny, nz);
+            }
+        }
     }
 
     [[nodiscard]] static std::tuple<int, int, int> positionToCoordinates(const Vector3 &pos) {
@@ -220,8 +886,13 @@ private:
     }
 
     [[nodiscard]] bool isValidCoordinate(const int x, const int y, const int z) const {
-        return x >= 0 && x < static_cast<int>(gridLength) &&
+        if (unbounded) {
+            return std::abs(x) < UNBOUNDED_LIMIT && std::abs(y) < UNBOUNDED_LIMIT && std::abs(z) < UNBOUNDED_LIMIT;
+        }
+        return x >= firstColumn && x < firstColumn + static_cast<int>(gridLength) &&
                y >= 0 && y < static_cast<int>(gridHeight) &&
                z >= 0 && z < static_cast<int>(gridWidth);
     }
 };
+
+using OctahedronGrid = BasicOctahedronGrid<>;
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+// Draws many copies of a mesh that differ only by translation, streaming one vec3 offset per instance instead of the
+// 4x4 matrix DrawMeshInstanced needs. The shader (see lighting_offsets.vs) adds the offset to each vertex and skips
+// the normal matrix. All groups' offsets go up in one persistent buffer per frame; each group is then one instanced
+// draw reading its own range of it.
+class OffsetInstancer {
+public:
+    // The caller keeps ownership of shader and sets its lights
+    explicit OffsetInstancer(const Shader &shader)
+        : shader(shader),
+          mvpLoc(GetShaderLocation(shader, "mvp")),
+          colorLoc(GetShaderLocation(shader, "colDiffuse")),
+          offsetLoc(GetShaderLocationAttrib(shader, "instanceOffset")) {}
+
+    OffsetInstancer(const OffsetInstancer &) = delete;
+    OffsetInstancer &operator=(const OffsetInstancer &) = delete;
+
+    ~OffsetInstancer() {
+        if (offsetBuffer != 0) rlUnloadVertexBuffer(offsetBuffer);
+    }
+
+    // Draws mesh at offsets[i] in colors[i] for every group i
+    template<size_t GROUPS>
+    void draw(const Mesh &mesh, const std::array<std::vector<Vector3>, GROUPS> &offsets,
+              const std::array<Color, GROUPS> &colors) {
+        size_t total = 0;
+        for (const auto &group: offsets) {
+            total += group.size();
+        }
+        if (total == 0 || offsetLoc < 0) return;
+
+        reserve(total);
+        size_t first = 0;
+        for (const auto &group: offsets) {
+            if (!group.empty()) {
+                rlUpdateVertexBuffer(offsetBuffer, group.data(), static_cast<int>(group.size() * sizeof(Vector3)),
+                                     static_cast<int>(first * sizeof(Vector3)));
+            }
+            first += group.size();
+        }
+
+        // Flush raylib's pending immediate-mode geometry before drawing around its batching
+        rlDrawRenderBatchActive();
+        rlEnableShader(shader.id);
+        rlSetUniformMatrix(mvpLoc, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+        if (!rlEnableVertexArray(mesh.vaoId)) {
+            rlDisableShader();
+            return;
+        }
+
+        const unsigned int location = static_cast<unsigned int>(offsetLoc);
+        rlEnableVertexBuffer(offsetBuffer);
+        rlEnableVertexAttribute(location);
+        rlSetVertexAttributeDivisor(location, 1);
+        first = 0;
+        for (size_t group = 0; group < GROUPS; group++) {
+            const size_t count = offsets[group].size();
+            if (count == 0) continue;
+
+            const Vector4 color = ColorNormalize(colors[group]);
+            rlSetUniform(colorLoc, &color, RL_SHADER_UNIFORM_VEC4, 1);
+            rlSetVertexAttribute(location, 3, RL_FLOAT, false, 0, static_cast<int>(first * sizeof(Vector3)));
+            if (mesh.indices) {
+                rlDrawVertexArrayElementsInstanced(0, mesh.triangleCount * 3, nullptr, static_cast<int>(count));
+            } else {
+                rlDrawVertexArrayInstanced(0, mesh.vertexCount, static_cast<int>(count));
+            }
+            first += count;
+        }
+
+        // Other shaders draw this mesh's vertex array too; leave them no per-instance attribute to trip over
+        rlSetVertexAttributeDivisor(location, 0);
+        rlDisableVertexAttribute(location);
+        rlDisableVertexBuffer();
+        rlDisableVertexArray();
+        rlDisableShader();
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 4096;
+
+    // Room for count offsets, with headroom so a growing colony does not reallocate every frame
+    void reserve(const size_t count) {
+        if (offsetBuffer != 0 && count <= capacity) return;
+
+        capacity = std::max(MIN_CAPACITY, count + count / 4);
+        if (offsetBuffer != 0) rlUnloadVertexBuffer(offsetBuffer);
+        offsetBuffer = rlLoadVertexBuffer(nullptr, static_cast<int>(capacity * sizeof(Vector3)), true);
+    }
+
+    Shader shader;
+    int mvpLoc;
+    int colorLoc;
+    int offsetLoc;
+    unsigned int offsetBuffer = 0;
+    size_t capacity = 0;
+};
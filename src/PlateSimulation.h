@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include "raylib.h"
+#include "BoundaryManager.h"
+#include "ColonySimulation.h"
+#include "SeedPatterns.h"
+#include "Units.h"
+
+// Geometry of a multi-well plate. Sizes follow the common SBS footprint formats.
+struct PlateFormat {
+    const char *name;
+    int rows;
+    int columns;
+    float pitchMm;        // distance between neighboring well centers
+    float wellDiameterMm; // diameter of a round well, or side of a square one
+    bool roundWells;
+};
+
+inline constexpr std::array<PlateFormat, 4> PLATE_FORMATS = {
+    {
+        {"6-well", 2, 3, 39.12f, 34.8f, true},
+        {"24-well", 4, 6, 19.3f, 15.6f, true},
+        {"96-well", 8, 12, 9.0f, 6.4f, true},
+        {"384-well", 16, 24, 4.5f, 3.3f, false}
+    }
+};
+
+// Accepts the format name ("96-well") or just its well count ("96")
+inline const PlateFormat *findPlateFormat(const std::string &name) {
+    for (const PlateFormat &format: PLATE_FORMATS) {
+        if (name == format.name || name + "-well" == format.name) return &format;
+    }
+    return nullptr;
+}
+
+// Many independent colonies, one per well, advanced together. Every well is a small ColonySimulation with its own
+// lattice and boundary in local coordinates; a tick advances all wells inside one TBB arena, so wells are spread
+// over the cores by work stealing while each well's own parallel loops fill in the gaps. This keeps every core busy
+// with hundreds of tiny colonies where one process per well would spend most of its time starting up.
+template<typename Index = CellIndex>
+class BasicPlateSimulation {
+public:
+    using Simulation = BasicColonySimulation<Index>;
+
+    // Well i is seeded with seed + i. Threads are shared with the caller's arena unless a limit is given.
+    explicit BasicPlateSimulation(const PlateFormat &format, const uint64_t seed = std::random_device()(),
+                                  const int threads = tbb::task_arena::automatic)
+        : format(format),
+          arena(threads) {
+        const int wellCount = format.rows * format.columns;
+        wells.reserve(wellCount);
+        for (int i = 0; i < wellCount; i++) {
+            wells.push_back(std::make_unique<Simulation>(std::make_shared<BoundaryManager>(),
+                                                         seed + static_cast<uint64_t>(i)));
+        }
+        fitWellBoundaries();
+    }
+
+    [[nodiscard]] const PlateFormat &getFormat() const {
+        return format;
+    }
+
+    [[nodiscard]] size_t getWellCount() const {
+        return wells.size();
+    }
+
+    [[nodiscard]] const Simulation &getWell(const size_t well) const {
+        return *wells[well];
+    }
+
+    // Row letter and column number, as printed on the plate ("A1", "P24")
+    [[nodiscard]] std::string getWellLabel(const size_t well) const {
+        const int row = static_cast<int>(well) / format.columns;
+        const int column = static_cast<int>(well) % format.columns;
+        return std::string(1, static_cast<char>('A' + row)) + std::to_string(column + 1);
+    }
+
+    // Where the well's local coordinates sit on the plate, for drawing the wells side by side
+    [[nodiscard]] Vector3 getWellOffset(const size_t well) const {
+        const float pitch = format.pitchMm * MM_TO_WORLD_SCALE;
+        return {
+            static_cast<float>(static_cast<int>(well) % format.columns) * pitch,
+            0.0f,
+            static_cast<float>(static_cast<int>(well) / format.columns) * pitch
+        };
+    }
+
+    // World-space extent of the whole plate
+    [[nodiscard]] Vector3 getPlateSize() const {
+        const float pitch = format.pitchMm * MM_TO_WORLD_SCALE;
+        return {
+            static_cast<float>(format.columns) * pitch,
+            wells.front()->getBoundaryManager()->getBoundaryHeight(),
+            static_cast<float>(format.rows) * pitch
+        };
+    }
+
+    void setOctahedraSpacing(const float spacing) {
+        for (auto &well: wells) well->setOctahedraSpacing(spacing);
+    }
+
+    [[nodiscard]] float getOctahedraSpacing() const {
+        return wells.front()->getOctahedraSpacing();
+    }
+
+    // The well height follows the layer count, as it does for the single boundary in the GUI
+    void setOctahedraLayers(const int layers) {
+        for (auto &well: wells) well->setOctahedraLayers(layers);
+        fitWellBoundaries();
+    }
+
+    [[nodiscard]] int getOctahedraLayers() const {
+        return wells.front()->getOctahedraLayers();
+    }
+
+    void setSpawnChance(const float chance) {
+        for (auto &well: wells) well->setSpawnChance(chance);
+    }
+
+    [[nodiscard]] float getSpawnChance() const {
+        return wells.front()->getSpawnChance();
+    }
+
+    void setSeedingOptions(const SeedingOptions &options) {
+        for (auto &well: wells) well->setSeedingOptions(options);
+    }
+
+    void generateStartingPositions() {
+        forEachWell([](Simulation &well) { well.generateStartingPositions(); });
+    }
+
+    [[nodiscard]] size_t getStartingPositionCount() const {
+        size_t count = 0;
+        for (const auto &well: wells) count += well->getStartingPositions().size();
+        return count;
+    }
+
+    // Builds every well's lattice and places its starting cells. Does nothing on later calls.
+    void initializeLattices() {
+        forEachWell([](Simulation &well) { well.initializeLattice(); });
+    }
+
+    void createInitialOctahedra() {
+        forEachWell([](Simulation &well) { well.createInitialOctahedra(); });
+    }
+
+    // One division round in every well that still has room. Returns the number of cells added across the plate.
+    size_t tick() {
+        std::atomic<size_t> inserted{0};
+        forEachWell([&](Simulation &well) {
+            if (isFull(well)) return;
+            inserted += well.tick();
+        });
+        return inserted;
+    }
+
+    [[nodiscard]] size_t getCount() const {
+        size_t count = 0;
+        for (const auto &well: wells) count += well->getCount();
+        return count;
+    }
+
+    [[nodiscard]] size_t getCapacity() const {
+        size_t capacity = 0;
+        for (const auto &well: wells) capacity += well->getCapacity();
+        return capacity;
+    }
+
+    // Filled share of all wells' sites together, in percent
+    [[nodiscard]] float getConfluence() const {
+        const size_t capacity = getCapacity();
+        return capacity > 0 ? 100.0f * static_cast<float>(getCount()) / static_cast<float>(capacity) : 0.0f;
+    }
+
+private:
+    [[nodiscard]] static bool isFull(const Simulation &well) {
+        return well.getCapacity() > 0 && well.getCount() >= well.getCapacity();
+    }
+
+    template<typename Fn>
+    void forEachWell(Fn &&fn) {
+        arena.execute([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, wells.size(), 1),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i) fn(*wells[i]);
+                }
+            );
+        });
+    }
+
+    // Each well keeps the default corner placement in its own coordinates, so its lattice only spans one well
+    void fitWellBoundaries() {
+        const float size = format.wellDiameterMm * MM_TO_WORLD_SCALE;
+        const float height = 3.0f * OCTAHEDRON_WORLD_SIZE * static_cast<float>(getOctahedraLayers());
+        for (auto &well: wells) {
+            const auto boundary = well->getBoundaryManager();
+            boundary->setBoundaryWidth(size);
+            boundary->setBoundaryDepth(size);
+            boundary->setBoundaryHeight(height);
+            boundary->setBoundaryCenter({size / 2 + 10, height / 2 + 10, size / 2 + 10});
+            boundary->setBoundaryPreset(format.roundWells ? BoundaryPreset::RoundWell : BoundaryPreset::Box);
+        }
+    }
+
+    PlateFormat format;
+    tbb::task_arena arena;
+    std::vector<std::unique_ptr<Simulation>> wells;
+};
+
+using PlateSimulation = BasicPlateSimulation<>;
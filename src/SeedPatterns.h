@@ -0,0 +1,460 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "raylib.h"
+
+// How the starting cells are laid out on each layer. The hexagonal pattern is the original grid seeding; the
+// random strategies aim for the same mean density at a given spacing, so the spacing keeps its meaning (and the
+// spacing predictor stays roughly valid) when switching between them.
+enum class SeedingStrategy {
+    Hexagonal,
+    Uniform,      // independent uniform points
+    PoissonDisk,  // blue noise: random, but no two seeds closer than a minimum distance
+    Clustered,    // droplet spots: Gaussian clusters around uniformly placed centers
+    DensityImage, // uniform points thinned by the brightness of a grayscale image
+    PointList     // explicit coordinates from a CSV file
+};
+
+inline const char *seedingStrategyName(const SeedingStrategy strategy) {
+    switch (strategy) {
+        case SeedingStrategy::Hexagonal: return "hexagonal";
+        case SeedingStrategy::Uniform: return "uniform";
+        case SeedingStrategy::PoissonDisk: return "poisson";
+        case SeedingStrategy::Clustered: return "clustered";
+        case SeedingStrategy::DensityImage: return "image";
+        case SeedingStrategy::PointList: return "points";
+    }
+    return "unknown";
+}
+
+// Image and point seeding need a file, which a strategy name cannot carry, so only the generated patterns parse
+inline std::optional<SeedingStrategy> parseSeedingStrategy(const std::string &name) {
+    for (const SeedingStrategy strategy: {SeedingStrategy::Hexagonal, SeedingStrategy::Uniform,
+                                          SeedingStrategy::PoissonDisk, SeedingStrategy::Clustered}) {
+        if (name == seedingStrategyName(strategy)) return strategy;
+    }
+    return std::nullopt;
+}
+
+// Grayscale seed density map, stretched over the boundary's footprint: white seeds at the full density, black not at
+// all. Image rows run along the depth (z) axis.
+struct SeedDensityMap {
+    int width = 0;
+    int height = 0;
+    std::vector<float> values; // row-major, 0 to 1
+
+    static std::shared_ptr<SeedDensityMap> loadFromImage(const std::string &path) {
+        Image image = LoadImage(path.c_str());
+        if (image.data == nullptr || image.width <= 0 || image.height <= 0) {
+            std::cerr << "Could not load seed density image " << path << std::endl;
+            UnloadImage(image);
+            return nullptr;
+        }
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+
+        auto map = std::make_shared<SeedDensityMap>();
+        map->width = image.width;
+        map->height = image.height;
+        map->values.resize(static_cast<size_t>(image.width) * image.height);
+        const auto *pixels = static_cast<const unsigned char *>(image.data);
+        for (size_t i = 0; i < map->values.size(); i++) {
+            map->values[i] = static_cast<float>(pixels[i]) / 255.0f;
+        }
+        UnloadImage(image);
+        return map;
+    }
+};
+
+// Seed coordinates in millimetres, measured from the minimum corner of the boundary's bounds. Lines are "x,z" or
+// "x,y,z"; without a height every point is seeded on every layer. Lines that do not parse (such as a header) are
+// skipped.
+struct SeedPointList {
+    std::vector<Vector3> points;
+    bool hasHeight = false;
+
+    static std::shared_ptr<SeedPointList> loadFromCsv(const std::string &path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Could not open seed point list " << path << std::endl;
+            return nullptr;
+        }
+
+        auto list = std::make_shared<SeedPointList>();
+        size_t columns = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            std::stringstream stream(line);
+            std::string field;
+            std::vector<float> values;
+            while (std::getline(stream, field, ',')) {
+                try {
+                    values.push_back(std::stof(field));
+                } catch (const std::exception &) {
+                    values.clear();
+                    break;
+                }
+            }
+            if (values.size() != 2 && values.size() != 3) continue;
+            if (columns == 0) columns = values.size();
+            if (values.size() != columns) {
+                std::cerr << "Seed point list " << path << " mixes 2D and 3D points, skipping: " << line << std::endl;
+                continue;
+            }
+            list->points.push_back(values.size() == 3 ? Vector3{values[0], values[1], values[2]}
+                                                      : Vector3{values[0], 0.0f, values[1]});
+        }
+
+        if (list->points.empty()) {
+            std::cerr << "Seed point list " << path << " has no points" << std::endl;
+            return nullptr;
+        }
+        list->hasHeight = columns == 3;
+        return list;
+    }
+};
+
+struct SeedingOptions {
+    SeedingStrategy strategy = SeedingStrategy::Hexagonal;
+    int seedsPerCluster = 12;
+    float clusterRadius = 15.0f; // standard deviation of a cluster's spread, in world units
+    std::shared_ptr<const SeedDensityMap> densityMap;
+    std::shared_ptr<const SeedPointList> pointList;
+};
+
+// Footprint of one layer in the x-z plane
+struct SeedArea {
+    float minX;
+    float minZ;
+    float maxX;
+    float maxZ;
+
+    [[nodiscard]] float getWidth() const { return std::max(0.0f, maxX - minX); }
+    [[nodiscard]] float getDepth() const { return std::max(0.0f, maxZ - minZ); }
+    [[nodiscard]] float getArea() const { return getWidth() * getDepth(); }
+};
+
+// splitmix64 stream. Patterns split their work into chunks that each draw from their own stream, keyed by the chunk,
+// so a seed produces the same layout however the chunks are spread over threads.
+class SeedRandom {
+public:
+    SeedRandom(const uint64_t seed, const uint64_t stream)
+        : state(seed ^ (stream + 1) * 0xd1b54a32d192ed03ull) {
+    }
+
+    uint64_t next() {
+        uint64_t x = state += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    // Uniform in [0, 1)
+    float nextFloat() {
+        return static_cast<float>(next() >> 40) * 0x1.0p-24f;
+    }
+
+    float nextFloat(const float low, const float high) {
+        return low + (high - low) * nextFloat();
+    }
+
+    // Standard normal by Box-Muller
+    float nextGaussian() {
+        const float u = 1.0f - nextFloat(); // (0, 1], keeps the logarithm finite
+        const float v = nextFloat();
+        return std::sqrt(-2.0f * std::log(u)) * std::cos(2.0f * PI * v);
+    }
+
+private:
+    uint64_t state;
+};
+
+// 2D seed layouts for one layer, as (x, z) points. Points may fall outside the boundary's shape; the simulation
+// snaps them to the lattice and drops those outside, as it does for the hexagonal pattern.
+class SeedPatterns {
+public:
+    // Seeds per unit area of the hexagonal pattern, which the random patterns match on average
+    static float hexagonalDensity(const float spacing) {
+        return 1.0f / (0.866025404f * spacing * spacing);
+    }
+
+    // poissonDisk packs about 0.85 / radius^2 points per unit area, so this radius matches the hexagonal pattern's
+    // density at the given spacing
+    static float poissonRadius(const float spacing) {
+        return 0.86f * spacing;
+    }
+
+    static std::vector<Vector2> uniform(const SeedArea &area, const float density, const uint64_t seed) {
+        const auto count = static_cast<size_t>(std::llround(area.getArea() * density));
+        std::vector<Vector2> points(count);
+
+        constexpr size_t chunkSize = 1 << 14;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, (count + chunkSize - 1) / chunkSize),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t chunk = range.begin(); chunk != range.end(); ++chunk) {
+                    SeedRandom random(seed, chunk);
+                    for (size_t i = chunk * chunkSize; i < std::min(count, (chunk + 1) * chunkSize); i++) {
+                        points[i] = {random.nextFloat(area.minX, area.maxX), random.nextFloat(area.minZ, area.maxZ)};
+                    }
+                }
+            }
+        );
+        return points;
+    }
+
+    // Bridson's (2007) grid-accelerated sampling, run in parallel by phase groups (Wei, 2008). Background cells are
+    // radius / sqrt(2) wide, so each holds at most one point and a conflict check looks at a 5x5 block of cells.
+    // Cells are grouped into tiles and the tiles into four phases in a 2x2 checkerboard. Tiles of one phase are far
+    // enough apart that they never see each other's writes, so each phase fills its tiles in parallel, growing from
+    // the points already placed around the tile. Candidates sit just beyond the radius of an active point at evenly
+    // spaced angles, which packs more densely with fewer attempts than Bridson's random annulus draws, and each active
+    // point tries every angle once before it retires.
+    static std::vector<Vector2> poissonDisk(const SeedArea &area, const float radius, const uint64_t seed) {
+        if (radius <= 0.0f || area.getArea() <= 0.0f) return {};
+
+        const float cellSize = radius / std::sqrt(2.0f);
+        const float inverseCellSize = 1.0f / cellSize;
+        const int cellsX = std::max(1, static_cast<int>(std::ceil(area.getWidth() * inverseCellSize)));
+        const int cellsZ = std::max(1, static_cast<int>(std::ceil(area.getDepth() * inverseCellSize)));
+        const int tilesX = (cellsX + POISSON_TILE_CELLS - 1) / POISSON_TILE_CELLS;
+        const int tilesZ = (cellsZ + POISSON_TILE_CELLS - 1) / POISSON_TILE_CELLS;
+        const float radiusSquared = radius * radius;
+
+        // The background grid has a two-cell border, so conflict checks need no bounds tests, and empty cells hold a
+        // point far outside any area, so they pass the distance test without a separate occupancy lookup
+        constexpr int border = 2;
+        const int stride = cellsX + 2 * border;
+        std::vector<Vector2> cells(static_cast<size_t>(stride) * (cellsZ + 2 * border), {EMPTY_CELL, EMPTY_CELL});
+        const auto cellIndex = [&](const int x, const int z) {
+            return static_cast<size_t>(z + border) * stride + (x + border);
+        };
+        const auto isOccupied = [](const Vector2 &cell) {
+            return cell.x != EMPTY_CELL;
+        };
+
+        // The 5x5 block around a cell without its center and corners (the corners are at least a radius away),
+        // nearest first, since a candidate next to an active point is usually rejected by a close neighbor
+        std::array<ptrdiff_t, 20> neighborOffsets;
+        {
+            std::array<std::pair<int, int>, 20> block;
+            size_t count = 0;
+            for (int dz = -2; dz <= 2; dz++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    if ((dx == 0 && dz == 0) || (std::abs(dx) == 2 && std::abs(dz) == 2)) continue;
+                    block[count++] = {dx, dz};
+                }
+            }
+            std::ranges::stable_sort(block, {}, [](const std::pair<int, int> &offset) {
+                return offset.first * offset.first + offset.second * offset.second;
+            });
+            for (size_t i = 0; i < block.size(); i++) {
+                neighborOffsets[i] = static_cast<ptrdiff_t>(block[i].second) * stride + block[i].first;
+            }
+        }
+
+        // Candidate directions, evenly spaced around the circle, and the random rotations applied to them per draw,
+        // both scaled to just beyond the radius
+        const float candidateDistance = radius * 1.0001f;
+        std::array<Vector2, POISSON_ATTEMPTS> directions;
+        for (int i = 0; i < POISSON_ATTEMPTS; i++) {
+            const float angle = 2.0f * PI * static_cast<float>(i) / POISSON_ATTEMPTS;
+            directions[i] = {std::cos(angle), std::sin(angle)};
+        }
+        std::array<Vector2, POISSON_ROTATIONS> rotations;
+        for (int i = 0; i < POISSON_ROTATIONS; i++) {
+            const float angle = 2.0f * PI * static_cast<float>(i) / POISSON_ROTATIONS;
+            rotations[i] = {std::cos(angle) * candidateDistance, std::sin(angle) * candidateDistance};
+        }
+
+        const auto fillTile = [&](const int tileX, const int tileZ) {
+            const int firstX = tileX * POISSON_TILE_CELLS;
+            const int firstZ = tileZ * POISSON_TILE_CELLS;
+            const int endX = std::min(cellsX, firstX + POISSON_TILE_CELLS);
+            const int endZ = std::min(cellsZ, firstZ + POISSON_TILE_CELLS);
+            SeedRandom random(seed, static_cast<uint64_t>(tileZ) * tilesX + tileX);
+            // At most one point per cell of the tile and of the two-cell ring around it
+            std::vector<Vector2> active;
+            active.reserve((POISSON_TILE_CELLS + 4) * (POISSON_TILE_CELLS + 4));
+
+            // Accepts a point if it lies in this tile and no placed point is closer than the radius
+            const auto tryPlace = [&](const Vector2 &point) {
+                if (point.x < area.minX || point.x >= area.maxX || point.y < area.minZ || point.y >= area.maxZ) {
+                    return false;
+                }
+                const int x = static_cast<int>((point.x - area.minX) * inverseCellSize);
+                const int z = static_cast<int>((point.y - area.minZ) * inverseCellSize);
+                if (x < firstX || x >= endX || z < firstZ || z >= endZ) return false;
+                const size_t index = cellIndex(x, z);
+                if (isOccupied(cells[index])) return false;
+
+                for (const ptrdiff_t offset: neighborOffsets) {
+                    const Vector2 &other = cells[index + offset];
+                    const float dx = other.x - point.x;
+                    const float dz = other.y - point.y;
+                    if (dx * dx + dz * dz < radiusSquared) return false;
+                }
+                cells[index] = point;
+                active.push_back(point);
+                return true;
+            };
+
+            const auto grow = [&] {
+                while (!active.empty()) {
+                    const auto pick = static_cast<size_t>(((random.next() >> 32) * active.size()) >> 32);
+                    const Vector2 origin = active[pick];
+                    const Vector2 &rotation = rotations[random.next() >> (64 - POISSON_ROTATION_BITS)];
+                    // Every direction is tried once, keeping each that fits; placing points only adds conflicts, so
+                    // the directions that failed would fail again and the origin is done. The next directions after
+                    // a placed point are within the radius of it and are skipped.
+                    active[pick] = active.back();
+                    active.pop_back();
+                    for (int attempt = 0; attempt < POISSON_ATTEMPTS; attempt++) {
+                        const Vector2 &direction = directions[attempt];
+                        if (tryPlace({
+                            origin.x + direction.x * rotation.x - direction.y * rotation.y,
+                            origin.y + direction.x * rotation.y + direction.y * rotation.x
+                        })) {
+                            attempt += POISSON_BLOCKED_ATTEMPTS;
+                        }
+                    }
+                }
+            };
+
+            // Growth continues from the points earlier phases placed close enough to reach into this tile; the first
+            // phase has none and starts from a random dart instead
+            const float tileMinX = area.minX + static_cast<float>(firstX) * cellSize;
+            const float tileMinZ = area.minZ + static_cast<float>(firstZ) * cellSize;
+            const float tileMaxX = area.minX + static_cast<float>(endX) * cellSize;
+            const float tileMaxZ = area.minZ + static_cast<float>(endZ) * cellSize;
+            for (int z = std::max(0, firstZ - 2); z < std::min(cellsZ, endZ + 2); z++) {
+                for (int x = std::max(0, firstX - 2); x < std::min(cellsX, endX + 2); x++) {
+                    const Vector2 &cell = cells[cellIndex(x, z)];
+                    if (!isOccupied(cell)) continue;
+                    const float dx = std::max({tileMinX - cell.x, cell.x - tileMaxX, 0.0f});
+                    const float dz = std::max({tileMinZ - cell.y, cell.y - tileMaxZ, 0.0f});
+                    if (dx * dx + dz * dz <= candidateDistance * candidateDistance) active.push_back(cell);
+                }
+            }
+            for (int attempt = 0; attempt < POISSON_ATTEMPTS && active.empty(); attempt++) {
+                tryPlace({
+                    area.minX + random.nextFloat(static_cast<float>(firstX), static_cast<float>(endX)) * cellSize,
+                    area.minZ + random.nextFloat(static_cast<float>(firstZ), static_cast<float>(endZ)) * cellSize
+                });
+            }
+            grow();
+        };
+
+        for (int phase = 0; phase < 4; phase++) {
+            const int phaseX = phase % 2;
+            const int phaseZ = phase / 2;
+            const int phaseTilesX = (tilesX - phaseX + 1) / 2;
+            const int phaseTilesZ = (tilesZ - phaseZ + 1) / 2;
+            tbb::parallel_for(
+                tbb::blocked_range<int>(0, phaseTilesX * phaseTilesZ),
+                [&](const tbb::blocked_range<int> &range) {
+                    for (int i = range.begin(); i != range.end(); ++i) {
+                        fillTile(phaseX + 2 * (i % phaseTilesX), phaseZ + 2 * (i / phaseTilesX));
+                    }
+                }
+            );
+        }
+
+        std::vector<Vector2> points;
+        points.reserve(static_cast<size_t>(area.getArea() * 0.9f / radiusSquared) + 16);
+        for (const Vector2 &cell: cells) {
+            if (isOccupied(cell)) points.push_back(cell);
+        }
+        return points;
+    }
+
+    // Cluster centers are placed uniformly at density / seedsPerCluster, each with seedsPerCluster seeds spread
+    // normally around it, so the overall density matches the other patterns
+    static std::vector<Vector2> clustered(const SeedArea &area, const float density, const int seedsPerCluster,
+                                          const float clusterRadius, const uint64_t seed) {
+        const int perCluster = std::max(1, seedsPerCluster);
+        const std::vector<Vector2> centers = uniform(area, density / static_cast<float>(perCluster), seed);
+        std::vector<Vector2> points(centers.size() * perCluster);
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, centers.size()),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t cluster = range.begin(); cluster != range.end(); ++cluster) {
+                    SeedRandom random(~seed, cluster);
+                    for (int i = 0; i < perCluster; i++) {
+                        points[cluster * perCluster + i] = {
+                            centers[cluster].x + clusterRadius * random.nextGaussian(),
+                            centers[cluster].y + clusterRadius * random.nextGaussian()
+                        };
+                    }
+                }
+            }
+        );
+        return points;
+    }
+
+    // Each pixel covers its share of the footprint and receives on average brightness * density * pixel area seeds,
+    // placed uniformly within it
+    static std::vector<Vector2> fromDensityMap(const SeedArea &area, const SeedDensityMap &map, const float density,
+                                               const uint64_t seed) {
+        if (map.width <= 0 || map.height <= 0) return {};
+
+        const float pixelWidth = area.getWidth() / static_cast<float>(map.width);
+        const float pixelDepth = area.getDepth() / static_cast<float>(map.height);
+        const float seedsPerPixel = density * pixelWidth * pixelDepth;
+
+        std::vector<std::vector<Vector2>> rows(map.height);
+        tbb::parallel_for(
+            tbb::blocked_range<int>(0, map.height),
+            [&](const tbb::blocked_range<int> &range) {
+                for (int row = range.begin(); row != range.end(); ++row) {
+                    SeedRandom random(seed, static_cast<uint64_t>(row));
+                    for (int column = 0; column < map.width; column++) {
+                        const float expected = map.values[static_cast<size_t>(row) * map.width + column] * seedsPerPixel;
+                        int count = static_cast<int>(expected);
+                        if (random.nextFloat() < expected - static_cast<float>(count)) count++;
+
+                        for (int i = 0; i < count; i++) {
+                            rows[row].push_back({
+                                area.minX + (static_cast<float>(column) + random.nextFloat()) * pixelWidth,
+                                area.minZ + (static_cast<float>(row) + random.nextFloat()) * pixelDepth
+                            });
+                        }
+                    }
+                }
+            }
+        );
+
+        std::vector<Vector2> points;
+        for (const auto &row: rows) {
+            points.insert(points.end(), row.begin(), row.end());
+        }
+        return points;
+    }
+
+private:
+    // Tiles read up to two cells beyond their edges, so same-phase tiles, one tile apart, must be wider than that
+    static constexpr int POISSON_TILE_CELLS = 16;
+    static constexpr int POISSON_ATTEMPTS = 16;
+    // Candidates two steps of 22.5 degrees apart are 0.77 radii apart, so a placed one rules out the next two
+    static constexpr int POISSON_BLOCKED_ATTEMPTS = 2;
+    static constexpr int POISSON_ROTATION_BITS = 8;
+    static constexpr int POISSON_ROTATIONS = 1 << POISSON_ROTATION_BITS;
+    // Far outside any area, yet its squared distance to a real point stays finite under -ffast-math
+    static constexpr float EMPTY_CELL = 1e18f;
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+// Draws lit, flat-colored triangles into an RGB image on the CPU, for rendering frames where there is no window or GL
+// context, such as the headless driver on a cluster node. Shading follows lighting.fs with white point lights and its
+// ambient term, evaluated once per triangle.
+//
+// Triangles are projected in parallel, sorted into bands of rows, and the bands rasterized in parallel, each with its
+// own rows of the color and depth buffers. Depth is kept as 1/w, which is exact for any near plane; triangles reaching
+// behind the camera's near plane are dropped rather than clipped.
+class SoftwareRasterizer {
+public:
+    struct Triangle {
+        std::array<Vector3, 3> corners;
+        Vector3 normal;
+        Color color;
+    };
+
+    SoftwareRasterizer(const int width, const int height)
+        : width(width), height(height),
+          pixels(static_cast<size_t>(width) * height * 3),
+          depth(static_cast<size_t>(width) * height) {}
+
+    // Replaces the image with triangles seen from a perspective camera, over background. Triangles facing away from
+    // the camera are skipped.
+    void render(const Camera3D &camera, const std::vector<Triangle> &triangles, const std::span<const Vector3> lights,
+                const Color background) {
+        for (size_t i = 0; i < depth.size(); i++) {
+            pixels[3 * i] = background.r;
+            pixels[3 * i + 1] = background.g;
+            pixels[3 * i + 2] = background.b;
+        }
+        std::ranges::fill(depth, 0.0f);
+
+        const float aspect = static_cast<float>(width) / static_cast<float>(height);
+        const Matrix viewProjection = MatrixMultiply(MatrixLookAt(camera.position, camera.target, camera.up),
+                                                     MatrixPerspective(camera.fovy * DEG2RAD, aspect, NEAR_PLANE,
+                                                                       FAR_PLANE));
+
+        projected.resize(triangles.size());
+        tbb::parallel_for(size_t{0}, triangles.size(), [&](const size_t i) {
+            projected[i] = project(triangles[i], viewProjection, camera.position, lights);
+        });
+
+        const int bandCount = (height + BAND_ROWS - 1) / BAND_ROWS;
+        bands.resize(bandCount);
+        for (auto &band: bands) {
+            band.clear();
+        }
+        for (uint32_t i = 0; i < projected.size(); i++) {
+            const Projected &triangle = projected[i];
+            if (!triangle.visible) continue;
+            const float top = std::min({triangle.y[0], triangle.y[1], triangle.y[2]});
+            const float bottom = std::max({triangle.y[0], triangle.y[1], triangle.y[2]});
+            const int firstBand = std::max(static_cast<int>(top), 0) / BAND_ROWS;
+            const int lastBand = std::min(static_cast<int>(bottom), height - 1) / BAND_ROWS;
+            for (int band = firstBand; band <= lastBand; band++) {
+                bands[band].push_back(i);
+            }
+        }
+
+        tbb::parallel_for(0, bandCount, [&](const int band) {
+            const int firstRow = band * BAND_ROWS;
+            const int lastRow = std::min(firstRow + BAND_ROWS, height) - 1;
+            for (const uint32_t i: bands[band]) {
+                rasterize(projected[i], firstRow, lastRow);
+            }
+        });
+    }
+
+    // RGB, 3 bytes per pixel, top row first
+    [[nodiscard]] const std::vector<uint8_t> &getPixels() const {
+        return pixels;
+    }
+
+    [[nodiscard]] int getWidth() const {
+        return width;
+    }
+
+    [[nodiscard]] int getHeight() const {
+        return height;
+    }
+
+private:
+    static constexpr float NEAR_PLANE = 0.1f;
+    // Only shapes the projection; depth is compared as 1/w, so nothing beyond it is clipped
+    static constexpr float FAR_PLANE = 100000.0f;
+    static constexpr int BAND_ROWS = 32;
+    // lighting.fs's ambient uniform as the viewer sets it, which the shader divides by 10
+    static constexpr float AMBIENT = 0.2f / 10.0f;
+
+    // A triangle in pixel coordinates with its shaded color
+    struct Projected {
+        std::array<float, 3> x;
+        std::array<float, 3> y;
+        std::array<float, 3> inverseW;
+        std::array<uint8_t, 3> rgb;
+        bool visible;
+    };
+
+    [[nodiscard]] Projected project(const Triangle &triangle, const Matrix &m, const Vector3 &eye,
+                                    const std::span<const Vector3> lights) const {
+        Projected result = {};
+        const Vector3 centroid = Vector3Scale(
+            Vector3Add(Vector3Add(triangle.corners[0], triangle.corners[1]), triangle.corners[2]), 1.0f / 3.0f);
+        if (Vector3DotProduct(triangle.normal, Vector3Subtract(eye, centroid)) <= 0.0f) return result;
+
+        for (int c = 0; c < 3; c++) {
+            const Vector3 &p = triangle.corners[c];
+            const float clipX = m.m0 * p.x + m.m4 * p.y + m.m8 * p.z + m.m12;
+            const float clipY = m.m1 * p.x + m.m5 * p.y + m.m9 * p.z + m.m13;
+            const float clipW = m.m3 * p.x + m.m7 * p.y + m.m11 * p.z + m.m15;
+            if (clipW < NEAR_PLANE) return result;
+            result.inverseW[c] = 1.0f / clipW;
+            result.x[c] = (clipX * result.inverseW[c] * 0.5f + 0.5f) * static_cast<float>(width);
+            result.y[c] = (0.5f - clipY * result.inverseW[c] * 0.5f) * static_cast<float>(height);
+        }
+
+        const Vector3 shaded = shade(triangle, centroid, eye, lights);
+        result.rgb = {
+            static_cast<uint8_t>(std::clamp(shaded.x, 0.0f, 1.0f) * 255.0f + 0.5f),
+            static_cast<uint8_t>(std::clamp(shaded.y, 0.0f, 1.0f) * 255.0f + 0.5f),
+            static_cast<uint8_t>(std::clamp(shaded.z, 0.0f, 1.0f) * 255.0f + 0.5f)
+        };
+        result.visible = true;
+        return result;
+    }
+
+    // lighting.fs at position, with a white texel and diffuse color
+    [[nodiscard]] static Vector3 shade(const Triangle &triangle, const Vector3 &position, const Vector3 &eye,
+                                       const std::span<const Vector3> lights) {
+        const Vector3 tint = {
+            static_cast<float>(triangle.color.r) / 255.0f, static_cast<float>(triangle.color.g) / 255.0f,
+            static_cast<float>(triangle.color.b) / 255.0f
+        };
+        const Vector3 viewDirection = Vector3Normalize(Vector3Subtract(eye, position));
+        float lightDot = 0.0f;
+        float specular = 0.0f;
+        for (const Vector3 &light: lights) {
+            const Vector3 toLight = Vector3Normalize(Vector3Subtract(light, position));
+            const float nDotL = std::max(Vector3DotProduct(triangle.normal, toLight), 0.0f);
+            lightDot += nDotL;
+            if (nDotL > 0.0f) {
+                const Vector3 reflected = Vector3Reflect(Vector3Negate(toLight), triangle.normal);
+                specular += std::pow(std::max(0.0f, Vector3DotProduct(viewDirection, reflected)), 16.0f);
+            }
+        }
+
+        const auto channel = [&](const float tintChannel) {
+            const float linear = (tintChannel + specular) * lightDot + AMBIENT * tintChannel;
+            return std::pow(std::max(linear, 0.0f), 1.0f / 2.2f);
+        };
+        return {channel(tint.x), channel(tint.y), channel(tint.z)};
+    }
+
+    [[nodiscard]] static float edge(const float ax, const float ay, const float bx, const float by, const float px,
+                                    const float py) {
+        return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+    }
+
+    // Fills the triangle's pixels within rows firstRow..lastRow that are nearer than what is there
+    void rasterize(const Projected &t, const int firstRow, const int lastRow) {
+        const float area = edge(t.x[0], t.y[0], t.x[1], t.y[1], t.x[2], t.y[2]);
+        if (std::abs(area) < 1e-8f) return;
+        const float inverseArea = 1.0f / area;
+
+        const int left = std::max(static_cast<int>(std::floor(std::min({t.x[0], t.x[1], t.x[2]}))), 0);
+        const int right = std::min(static_cast<int>(std::ceil(std::max({t.x[0], t.x[1], t.x[2]}))), width - 1);
+        const int top = std::max(static_cast<int>(std::floor(std::min({t.y[0], t.y[1], t.y[2]}))), firstRow);
+        const int bottom = std::min(static_cast<int>(std::ceil(std::max({t.y[0], t.y[1], t.y[2]}))), lastRow);
+
+        for (int row = top; row <= bottom; row++) {
+            const float py = static_cast<float>(row) + 0.5f;
+            for (int column = left; column <= right; column++) {
+                const float px = static_cast<float>(column) + 0.5f;
+                // Barycentric weights, all non-negative inside whichever way the triangle winds on screen
+                const float w0 = edge(t.x[1], t.y[1], t.x[2], t.y[2], px, py) * inverseArea;
+                const float w1 = edge(t.x[2], t.y[2], t.x[0], t.y[0], px, py) * inverseArea;
+                const float w2 = 1.0f - w0 - w1;
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+                const float inverseW = w0 * t.inverseW[0] + w1 * t.inverseW[1] + w2 * t.inverseW[2];
+                const size_t pixel = static_cast<size_t>(row) * width + column;
+                if (inverseW <= depth[pixel]) continue;
+                depth[pixel] = inverseW;
+                pixels[3 * pixel] = t.rgb[0];
+                pixels[3 * pixel + 1] = t.rgb[1];
+                pixels[3 * pixel + 2] = t.rgb[2];
+            }
+        }
+    }
+
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+    std::vector<float> depth;
+    std::vector<Projected> projected;
+    std::vector<std::vector<uint32_t>> bands;
+};
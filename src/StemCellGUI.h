@@ -24,8 +24,10 @@ typedef struct {
     int simulationTimeSpinnerValue;
     bool completedAtSpinnerEditMode;
     int completedAtSpinnerValue;
+    int boundaryShapeActive;
+    int seedingActive;
 
-    Rectangle layoutRecs[27];
+    Rectangle layoutRecs[28];
     char progressLabelText[64];
 } StemCellGUIState;
 
@@ -74,6 +76,8 @@ StemCellGUIState InitStemCellGUI(void)
     state.simulationTimeSpinnerValue = 120;  // Default: 5 days (120 hours)
     state.completedAtSpinnerEditMode = false;
     state.completedAtSpinnerValue = 85;  // Default: 85% completion threshold
+    state.boundaryShapeActive = 0;  // Default: box
+    state.seedingActive = 0;  // Default: hexagonal
 
     // Initialize rectangles for GUI elements
     state.layoutRecs[0] = (Rectangle){ 8, 16, 200, 696 };
@@ -91,7 +95,7 @@ StemCellGUIState InitStemCellGUI(void)
     state.layoutRecs[12] = (Rectangle){ state.anchor01.x + 40, state.anchor01.y + 200, 120, 24 };
     state.layoutRecs[13] = (Rectangle){ state.anchor01.x + 40, state.anchor01.y + 176, 120, 24 };
     state.layoutRecs[14] = (Rectangle){ state.anchor01.x + 40, state.anchor01.y + 616, 120, 16 };
-    state.layoutRecs[15] = (Rectangle){ state.anchor01.x + 16, state.anchor01.y + 536, 24, 24 };
+    state.layoutRecs[15] = (Rectangle){ state.anchor01.x + 16, state.anchor01.y + 528, 24, 24 };
     state.layoutRecs[16] = (Rectangle){ state.anchor01.x + 0, state.anchor01.y + 232, 120, 16 };
     state.layoutRecs[17] = (Rectangle){ state.anchor01.x + 72, state.anchor01.y + 232, 120, 16 };
     state.layoutRecs[18] = (Rectangle){ state.anchor01.x + 0, state.anchor01.y + 512, 120, 16 };
@@ -103,6 +107,7 @@ StemCellGUIState InitStemCellGUI(void)
     state.layoutRecs[24] = (Rectangle){ state.anchor01.x + 40, state.anchor01.y + 104, 120, 24 };
     state.layoutRecs[25] = (Rectangle){ state.anchor01.x + 40, state.anchor01.y + 56, 120, 24 };
     state.layoutRecs[26] = (Rectangle){ state.anchor01.x + 40, state.anchor01.y + 32, 120, 24 };
+    state.layoutRecs[27] = (Rectangle){ state.anchor01.x + 40, state.anchor01.y + 556, 120, 24 };
 
     // Initialize progress label
     strcpy(state.progressLabelText, "Progress: Not Started");
@@ -124,6 +129,8 @@ void DrawStemCellGUI(StemCellGUIState *state)
     const char *progressBarText = TextFormat("%d%%", (int)(state->progressBarValue * 100));
     const char *simulationTimeLabelText = "Simulation Time (h)";
     const char *completedAtLabelText = "Completed at (%)";
+    const char *boundaryShapeText = "Box;Round well;Hanging drop;Channel;Custom";
+    const char *seedingText = "Hexagonal;Uniform;Poisson disk;Clustered;From file";
     
     // Dummy rectangle serves as background
     GuiDummyRec(state->layoutRecs[0], "");
@@ -163,6 +170,9 @@ void DrawStemCellGUI(StemCellGUIState *state)
         state->layerSpinnerEditMode = !state->layerSpinnerEditMode;
     }
     
+    // Boundary shape selector
+    GuiComboBox(state->layoutRecs[6], boundaryShapeText, &state->boundaryShapeActive);
+    
     // Cell split time spinner
     GuiLabel(state->layoutRecs[13], cellSplitLabelText);
     if (GuiSpinner(state->layoutRecs[12], "", &state->cellSplitSpinnerValue, 1, 240, state->cellSplitSpinnerEditMode)) {
@@ -189,6 +199,9 @@ void DrawStemCellGUI(StemCellGUIState *state)
     
     // Debug checkbox
     GuiCheckBox(state->layoutRecs[15], debugCheckBoxText, &state->debugCheckBoxChecked);
+
+    // Seeding strategy selector
+    GuiComboBox(state->layoutRecs[27], seedingText, &state->seedingActive);
     
     // Decorative lines
     GuiLine(state->layoutRecs[16], NULL);
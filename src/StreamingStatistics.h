@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Online statistics that summarize a stream in constant memory, for aggregating many replicate runs without keeping
+// their trajectories around.
+
+// Mean and variance by Welford's method, which stays accurate where the naive sum of squares cancels out
+class RunningStats {
+public:
+    void add(const double x) {
+        count++;
+        const double delta = x - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (x - mean);
+        minimum = std::min(minimum, x);
+        maximum = std::max(maximum, x);
+    }
+
+    [[nodiscard]] size_t getCount() const { return count; }
+    [[nodiscard]] double getMean() const { return mean; }
+    [[nodiscard]] double getMin() const { return count > 0 ? minimum : 0.0; }
+    [[nodiscard]] double getMax() const { return count > 0 ? maximum : 0.0; }
+
+    [[nodiscard]] double getVariance() const {
+        return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0;
+    }
+
+    [[nodiscard]] double getStdDev() const {
+        return std::sqrt(getVariance());
+    }
+
+    // Half-width of the normal-approximation 95% confidence interval of the mean
+    [[nodiscard]] double getConfidence95() const {
+        return count > 1 ? 1.96 * getStdDev() / std::sqrt(static_cast<double>(count)) : 0.0;
+    }
+
+private:
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    // Finite sentinels: the build's -ffast-math assumes there are no infinities
+    double minimum = std::numeric_limits<double>::max();
+    double maximum = std::numeric_limits<double>::lowest();
+};
+
+// Single-quantile estimate by the P-squared algorithm (Jain & Chlamtac, 1985): five markers track the minimum, the
+// target quantile, the maximum and two points halfway between, and are nudged along a piecewise-parabolic fit as
+// samples arrive. Exact until five samples have been seen.
+class P2Quantile {
+public:
+    explicit P2Quantile(const double p)
+        : p(p),
+          increments{0.0, p / 2, p, (1 + p) / 2, 1.0} {
+    }
+
+    void add(const double x) {
+        if (count < 5) {
+            heights[count++] = x;
+            if (count == 5) {
+                std::sort(heights.begin(), heights.end());
+                positions = {0, 1, 2, 3, 4};
+                desired = {0.0, 2 * p, 4 * p, 2 + 2 * p, 4.0};
+            }
+            return;
+        }
+        count++;
+
+        int cell;
+        if (x < heights[0]) {
+            heights[0] = x;
+            cell = 0;
+        } else if (x >= heights[4]) {
+            heights[4] = x;
+            cell = 3;
+        } else {
+            cell = 0;
+            while (x >= heights[cell + 1]) cell++;
+        }
+
+        for (int i = cell + 1; i < 5; i++) positions[i]++;
+        for (int i = 0; i < 5; i++) desired[i] += increments[i];
+
+        for (int i = 1; i <= 3; i++) {
+            const double offset = desired[i] - positions[i];
+            if ((offset >= 1 && positions[i + 1] - positions[i] > 1) ||
+                (offset <= -1 && positions[i - 1] - positions[i] < -1)) {
+                const int step = offset > 0 ? 1 : -1;
+                const double candidate = parabolic(i, step);
+                heights[i] = heights[i - 1] < candidate && candidate < heights[i + 1] ? candidate : linear(i, step);
+                positions[i] += step;
+            }
+        }
+    }
+
+    [[nodiscard]] double getValue() const {
+        if (count == 0) return 0.0;
+        if (count >= 5) return heights[2];
+
+        std::array<double, 5> sorted = heights;
+        std::sort(sorted.begin(), sorted.begin() + count);
+        const auto rank = static_cast<size_t>(std::lround(p * static_cast<double>(count - 1)));
+        return sorted[rank];
+    }
+
+private:
+    [[nodiscard]] double parabolic(const int i, const int step) const {
+        const double d = step;
+        return heights[i] + d / (positions[i + 1] - positions[i - 1]) *
+               ((positions[i] - positions[i - 1] + d) * (heights[i + 1] - heights[i]) / (positions[i + 1] - positions[i]) +
+                (positions[i + 1] - positions[i] - d) * (heights[i] - heights[i - 1]) / (positions[i] - positions[i - 1]));
+    }
+
+    [[nodiscard]] double linear(const int i, const int step) const {
+        return heights[i] + step * (heights[i + step] - heights[i]) / (positions[i + step] - positions[i]);
+    }
+
+    double p;
+    size_t count = 0;
+    std::array<double, 5> heights{};
+    std::array<int, 5> positions{};
+    std::array<double, 5> desired{};
+    std::array<double, 5> increments;
+};
+
+// Moments plus the 5th, 50th and 95th percentiles of one quantity
+class StreamingSummary {
+public:
+    void add(const double x) {
+        moments.add(x);
+        lower.add(x);
+        median.add(x);
+        upper.add(x);
+    }
+
+    [[nodiscard]] const RunningStats &getMoments() const { return moments; }
+    [[nodiscard]] double getP05() const { return lower.getValue(); }
+    [[nodiscard]] double getMedian() const { return median.getValue(); }
+    [[nodiscard]] double getP95() const { return upper.getValue(); }
+
+private:
+    RunningStats moments;
+    P2Quantile lower{0.05};
+    P2Quantile median{0.5};
+    P2Quantile upper{0.95};
+};
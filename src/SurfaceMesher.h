@@ -0,0 +1,376 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "CellIndex.h"
+#include "Frustum.h"
+#include "OctahedronGrid.h"
+#include "TruncatedOctahedron.h"
+
+// The outer surface of a colony as an explicit mesh: only the faces of cells whose neighbor across that face is
+// missing, with the corners cells share welded into one vertex. Meshes are kept per lattice brick (a chunk), built in
+// parallel, and rebuilt only for bricks whose occupancy changed since the last update and the bricks around them, so a
+// growing colony re-meshes its frontier rather than its whole volume.
+//
+// Faces follow the cell shape (see TruncatedOctahedron) rather than the lattice's neighbor count. In a tiling of
+// truncated octahedra no two faces in the same plane share an edge, so there are no coplanar faces to merge; the saving
+// comes from dropping buried faces, which leaves nothing at all inside the colony.
+//
+// Vertices are kept on an integer lattice in units of sqrt(2), where every cell corner lands exactly, so welding is
+// exact and chunks line up without cracks.
+template<typename Index = CellIndex>
+class BasicSurfaceMesher {
+public:
+    using Grid = BasicOctahedronGrid<Index>;
+
+    struct LatticePoint {
+        int x;
+        int y;
+        int z;
+
+        bool operator==(const LatticePoint &) const = default;
+    };
+
+    // Brings the chunks up to date with the grid. Cheap when nothing changed. Safe to call while the simulation
+    // inserts on another thread; cells added during the update are picked up by the next one.
+    void update(const Grid &grid) {
+        std::unordered_set<uint64_t> dirtyKeys;
+        const auto markAround = [&](const int originX, const int originY, const int originZ) {
+            // Faces of cells in the bricks around a change can appear or disappear too
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        dirtyKeys.insert(chunkKey(originX + dx * Grid::BRICK_SIZE, originY + dy * Grid::BRICK_SIZE,
+                                                  originZ + dz * Grid::BRICK_SIZE));
+                    }
+                }
+            }
+        };
+
+        // On the first update, or after the grid dropped or replaced its bricks, everything is meshed afresh
+        const uint64_t resets = grid.getResetCount();
+        const bool restart = resets != seenResetCount;
+        if (restart) {
+            releaseGpuMeshes();
+            chunks.clear();
+            seenResetCount = resets;
+            columnPhase = grid.getDenseLayout().firstColumn & (Grid::BRICK_SIZE - 1);
+        }
+        grid.takeChangedBricks(Grid::OccupancyReader::SurfaceMesher, markAround, restart);
+        if (dirtyKeys.empty()) return;
+
+        const std::vector<uint64_t> keys(dirtyKeys.begin(), dirtyKeys.end());
+        std::vector<Chunk> rebuilt(keys.size());
+        tbb::parallel_for(size_t{0}, keys.size(), [&](const size_t i) {
+            const auto [originX, originY, originZ] = unpackChunkKey(keys[i]);
+            buildChunk(grid, originX, originY, originZ, rebuilt[i]);
+        });
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            const auto it = chunks.find(keys[i]);
+            if (it != chunks.end() || !rebuilt[i].indices.empty()) remeshedChunks++;
+            if (it != chunks.end()) {
+                unloadChunk(it->second);
+                if (rebuilt[i].indices.empty()) {
+                    chunks.erase(it);
+                } else {
+                    it->second = std::move(rebuilt[i]);
+                }
+            } else if (!rebuilt[i].indices.empty()) {
+                chunks.emplace(keys[i], std::move(rebuilt[i]));
+            }
+        }
+    }
+
+    // Draws every chunk inside the frustum with material, whose shader takes per-vertex normals and colors (such as
+    // lighting.vs). Chunks changed by the last update are uploaded first, as static indexed meshes. Render thread only.
+    void draw(const Material &material, const Frustum &frustum, const std::array<Color, 15> &colors) {
+        for (auto &[key, chunk]: chunks) {
+            if (!frustum.intersects(chunk.bounds)) continue;
+            if (!chunk.uploaded) uploadChunk(chunk, colors);
+            for (const Mesh &mesh: chunk.meshes) {
+                DrawMesh(mesh, material, MatrixIdentity());
+            }
+        }
+    }
+
+    // Drops the uploaded vertex buffers but keeps the surface, for when drawing switches to another path. Render
+    // thread only.
+    void releaseGpuMeshes() {
+        for (auto &[key, chunk]: chunks) {
+            unloadChunk(chunk);
+        }
+    }
+
+    // Wavefront OBJ of the whole surface in world units, with vertices welded across chunks and one flat normal per
+    // face. Triangles are grouped by the neighbor count of their cell.
+    void writeObj(std::ostream &output) const {
+        std::vector<uint64_t> keys;
+        keys.reserve(chunks.size());
+        for (const auto &[key, chunk]: chunks) {
+            keys.push_back(key);
+        }
+        std::ranges::sort(keys);
+
+        std::unordered_map<LatticePoint, uint32_t, LatticePointHash> vertexIds;
+        std::array<std::vector<std::array<uint32_t, 4>>, 15> trianglesByCount;
+        output << "# Colony surface, " << getTriangleCount() << " triangles\n";
+        for (const uint64_t key: keys) {
+            const Chunk &chunk = chunks.at(key);
+            std::vector<uint32_t> ids(chunk.vertices.size());
+            for (size_t v = 0; v < chunk.vertices.size(); v++) {
+                const auto [it, inserted] = vertexIds.try_emplace(chunk.vertices[v],
+                                                                  static_cast<uint32_t>(vertexIds.size() + 1));
+                if (inserted) {
+                    const Vector3 position = toWorld(chunk.vertices[v]);
+                    output << "v " << position.x << ' ' << position.y << ' ' << position.z << '\n';
+                }
+                ids[v] = it->second;
+            }
+            for (size_t t = 0; t < chunk.faces.size(); t++) {
+                trianglesByCount[chunk.neighborCounts[t]].push_back({
+                    ids[chunk.indices[3 * t]], ids[chunk.indices[3 * t + 1]], ids[chunk.indices[3 * t + 2]],
+                    static_cast<uint32_t>(chunk.faces[t] + 1)
+                });
+            }
+        }
+
+        for (const Face &face: TruncatedOctahedron::FACES) {
+            output << "vn " << face.normal.x << ' ' << face.normal.y << ' ' << face.normal.z << '\n';
+        }
+        for (size_t count = 0; count < trianglesByCount.size(); count++) {
+            if (trianglesByCount[count].empty()) continue;
+            output << "g neighbors_" << count << '\n';
+            for (const auto &[a, b, c, normal]: trianglesByCount[count]) {
+                output << "f " << a << "//" << normal << ' ' << b << "//" << normal << ' ' << c << "//" << normal
+                        << '\n';
+            }
+        }
+    }
+
+    // Calls fn(const std::array<Vector3, 3> &corners, const Vector3 &normal, int neighborCount) for every triangle of
+    // the surface, with corners in world units, counter-clockwise seen from outside
+    template<typename Fn>
+    void forEachTriangle(const Fn &fn) const {
+        for (const auto &[key, chunk]: chunks) {
+            for (size_t t = 0; t < chunk.faces.size(); t++) {
+                const std::array<Vector3, 3> corners = {
+                    toWorld(chunk.vertices[chunk.indices[3 * t]]), toWorld(chunk.vertices[chunk.indices[3 * t + 1]]),
+                    toWorld(chunk.vertices[chunk.indices[3 * t + 2]])
+                };
+                const Vector3 &normal = TruncatedOctahedron::FACES[chunk.faces[t]].normal;
+                fn(corners, normal, static_cast<int>(chunk.neighborCounts[t]));
+            }
+        }
+    }
+
+    [[nodiscard]] size_t getTriangleCount() const {
+        size_t triangles = 0;
+        for (const auto &[key, chunk]: chunks) {
+            triangles += chunk.faces.size();
+        }
+        return triangles;
+    }
+
+    [[nodiscard]] size_t getChunkCount() const {
+        return chunks.size();
+    }
+
+    // Chunks rebuilt over the mesher's lifetime, for gauging how local the updates are
+    [[nodiscard]] size_t getRemeshedChunkCount() const {
+        return remeshedChunks;
+    }
+
+    ~BasicSurfaceMesher() {
+        releaseGpuMeshes();
+    }
+
+private:
+    using Face = TruncatedOctahedron::Face;
+
+    struct Chunk {
+        std::vector<LatticePoint> vertices;
+        std::vector<uint32_t> indices;
+        // Per triangle: the cell face it belongs to, and that cell's neighbor count as the simulation counts it
+        std::vector<uint8_t> faces;
+        std::vector<uint8_t> neighborCounts;
+        BoundingBox bounds = {};
+        std::vector<Mesh> meshes;
+        bool uploaded = false;
+    };
+
+    struct LatticePointHash {
+        size_t operator()(const LatticePoint &point) const {
+            return std::hash<uint64_t>()((static_cast<uint64_t>(static_cast<uint32_t>(point.y)) << 42) ^
+                                         (static_cast<uint64_t>(static_cast<uint32_t>(point.z)) << 21) ^
+                                         static_cast<uint32_t>(point.x));
+        }
+    };
+
+    [[nodiscard]] static Vector3 toVector(const LatticePoint &p) {
+        return {static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)};
+    }
+
+    [[nodiscard]] static Vector3 toWorld(const LatticePoint &p) {
+        constexpr float unit = Grid::SQUARE_DISTANCE / 4.0f; // sqrt(2)
+        return Vector3Scale(toVector(p), unit);
+    }
+
+    // A cell's center in sqrt(2) units: a site is 4 apart along x and z and 2 per layer, odd layers shifted by 2
+    [[nodiscard]] static LatticePoint cellCenter(const int x, const int y, const int z) {
+        const int shift = (y & 1) * 2;
+        return {4 * x + shift, 2 * y, 4 * z + shift};
+    }
+
+    // Chunks are keyed by brick coordinates. Bricks of a bounded grid start at its first column, which need not be a
+    // multiple of the brick size, so x origins keep that phase.
+    [[nodiscard]] uint64_t chunkKey(const int originX, const int originY, const int originZ) const {
+        constexpr uint64_t mask = (1u << 21) - 1;
+        return ((static_cast<uint64_t>(originY >> Grid::BRICK_SHIFT) & mask) << 42) |
+               ((static_cast<uint64_t>(originZ >> Grid::BRICK_SHIFT) & mask) << 21) |
+               (static_cast<uint64_t>((originX - columnPhase) >> Grid::BRICK_SHIFT) & mask);
+    }
+
+    [[nodiscard]] std::array<int, 3> unpackChunkKey(const uint64_t key) const {
+        const auto field = [](const uint64_t bits) {
+            const int value = static_cast<int>(bits & ((1u << 21) - 1));
+            return (value >= 1 << 20 ? value - (1 << 21) : value) << Grid::BRICK_SHIFT;
+        };
+        return {field(key) + columnPhase, field(key >> 42), field(key >> 21)};
+    }
+
+    static void buildChunk(const Grid &grid, const int originX, const int originY, const int originZ, Chunk &chunk) {
+        std::unordered_map<LatticePoint, uint32_t, LatticePointHash> welded;
+        Vector3 low = {0.0f, 0.0f, 0.0f};
+        Vector3 high = {0.0f, 0.0f, 0.0f};
+
+        grid.forEachOccupiedSite(originX, originY, originZ, [&](const int x, const int y, const int z) {
+            const LatticePoint center = cellCenter(x, y, z);
+            int neighborCount = -1;
+            for (size_t f = 0; f < TruncatedOctahedron::FACES.size(); f++) {
+                const Face &face = TruncatedOctahedron::FACES[f];
+                const TruncatedOctahedron::Point &across = face.neighborOffsets[y & 1];
+                if (grid.isSiteOccupied(x + across.x, y + across.y, z + across.z)) continue;
+
+                if (neighborCount < 0) neighborCount = std::clamp(grid.countOccupiedNeighbors(x, y, z), 0, 14);
+                std::array<uint32_t, 6> ids;
+                for (int c = 0; c < face.cornerCount; c++) {
+                    const TruncatedOctahedron::Point &offset = TruncatedOctahedron::CORNERS[face.corners[c]];
+                    const LatticePoint corner = {center.x + offset.x, center.y + offset.y, center.z + offset.z};
+                    const auto [it, inserted] = welded.try_emplace(corner, static_cast<uint32_t>(chunk.vertices.size()));
+                    if (inserted) {
+                        chunk.vertices.push_back(corner);
+                        const Vector3 position = toWorld(corner);
+                        low = chunk.vertices.size() == 1 ? position : Vector3Min(low, position);
+                        high = chunk.vertices.size() == 1 ? position : Vector3Max(high, position);
+                    }
+                    ids[c] = it->second;
+                }
+                // Fan from the first corner: 2 triangles per square, 4 per hexagon
+                for (int c = 1; c + 1 < face.cornerCount; c++) {
+                    chunk.indices.insert(chunk.indices.end(), {ids[0], ids[c], ids[c + 1]});
+                    chunk.faces.push_back(static_cast<uint8_t>(f));
+                    chunk.neighborCounts.push_back(static_cast<uint8_t>(neighborCount));
+                }
+            }
+        });
+        chunk.bounds = {low, high};
+    }
+
+    // raylib indexes meshes with 16 bits
+    static constexpr int MAX_MESH_VERTICES = 1 << 16;
+
+    // Flat-shaded: every face gets its own corners with its normal and its cell's color, shared by the face's
+    // triangles through the index buffer. A chunk whose faces need more vertices than one mesh can index is split
+    // over several meshes at face boundaries.
+    static void uploadChunk(Chunk &chunk, const std::array<Color, 15> &colors) {
+        const size_t triangleCount = chunk.faces.size();
+        size_t first = 0;
+        while (first < triangleCount) {
+            size_t end = first;
+            int vertexCount = 0;
+            while (end < triangleCount) {
+                const int cornerCount = TruncatedOctahedron::FACES[chunk.faces[end]].cornerCount;
+                if (vertexCount + cornerCount > MAX_MESH_VERTICES) break;
+                vertexCount += cornerCount;
+                end += cornerCount - 2;
+            }
+            chunk.meshes.push_back(uploadFaces(chunk, first, end, vertexCount, colors));
+            first = end;
+        }
+        chunk.uploaded = true;
+    }
+
+    // The faces whose triangles are first to end - 1, as one mesh of vertexCount vertices
+    static Mesh uploadFaces(const Chunk &chunk, const size_t first, const size_t end, const int vertexCount,
+                            const std::array<Color, 15> &colors) {
+        Mesh mesh = {};
+        mesh.vertexCount = vertexCount;
+        mesh.triangleCount = static_cast<int>(end - first);
+        mesh.vertices = static_cast<float *>(MemAlloc(mesh.vertexCount * 3 * sizeof(float)));
+        mesh.normals = static_cast<float *>(MemAlloc(mesh.vertexCount * 3 * sizeof(float)));
+        mesh.colors = static_cast<unsigned char *>(MemAlloc(mesh.vertexCount * 4 * sizeof(unsigned char)));
+        mesh.indices = static_cast<unsigned short *>(MemAlloc(mesh.triangleCount * 3 * sizeof(unsigned short)));
+
+        int v = 0;
+        int i = 0;
+        for (size_t t = first; t < end;) {
+            const Face &face = TruncatedOctahedron::FACES[chunk.faces[t]];
+            const Color &color = colors[chunk.neighborCounts[t]];
+            const int fanCount = face.cornerCount - 2;
+            const int base = v;
+            // Triangle k of the fan is corners 0, k + 1 and k + 2, so corner c > 0 is the second corner of triangle
+            // c - 1, and the last one the third corner of the last triangle
+            for (int c = 0; c < face.cornerCount; c++, v++) {
+                const int k = std::min(std::max(c - 1, 0), fanCount - 1);
+                const Vector3 position = toWorld(chunk.vertices[chunk.indices[3 * (t + k) + (c == 0 ? 0 : c - k)]]);
+                mesh.vertices[v * 3] = position.x;
+                mesh.vertices[v * 3 + 1] = position.y;
+                mesh.vertices[v * 3 + 2] = position.z;
+                mesh.normals[v * 3] = face.normal.x;
+                mesh.normals[v * 3 + 1] = face.normal.y;
+                mesh.normals[v * 3 + 2] = face.normal.z;
+                mesh.colors[v * 4] = color.r;
+                mesh.colors[v * 4 + 1] = color.g;
+                mesh.colors[v * 4 + 2] = color.b;
+                mesh.colors[v * 4 + 3] = color.a;
+            }
+            for (int k = 0; k < fanCount; k++) {
+                mesh.indices[i++] = static_cast<unsigned short>(base);
+                mesh.indices[i++] = static_cast<unsigned short>(base + k + 1);
+                mesh.indices[i++] = static_cast<unsigned short>(base + k + 2);
+            }
+            t += fanCount;
+        }
+
+        UploadMesh(&mesh, false);
+        return mesh;
+    }
+
+    static void unloadChunk(Chunk &chunk) {
+        if (!chunk.uploaded) return;
+        for (const Mesh &mesh: chunk.meshes) {
+            UnloadMesh(mesh);
+        }
+        chunk.meshes.clear();
+        chunk.uploaded = false;
+    }
+
+    std::unordered_map<uint64_t, Chunk> chunks;
+    uint64_t seenResetCount = 0;
+    int columnPhase = 0;
+    size_t remeshedChunks = 0;
+};
+
+using SurfaceMesher = BasicSurfaceMesher<>;
@@ -0,0 +1,448 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+#include "HeadlessRun.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CELL_SIM_SWEEP_PROCESSES 1
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+// One swept parameter, parsed from the command line:
+//   "8,12,16"   explicit values
+//   "8:24:5"    5 evenly spaced values from 8 to 24
+//   "8:24"      continuous range; Latin-hypercube sampling draws from it, a grid uses both ends
+struct SweepAxis {
+    std::vector<float> values;
+    bool continuous = false;
+    float min = 0.0f;
+    float max = 0.0f;
+
+    static SweepAxis fixed(const float value) {
+        return {{value}, false, value, value};
+    }
+
+    static std::optional<SweepAxis> parse(const std::string &text) {
+        std::vector<float> numbers;
+        const bool isRange = text.find(':') != std::string::npos;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, isRange ? ':' : ',')) {
+            try {
+                size_t used = 0;
+                numbers.push_back(std::stof(item, &used));
+                if (used != item.size()) return std::nullopt;
+            } catch (const std::exception &) {
+                return std::nullopt;
+            }
+        }
+        if (numbers.empty()) return std::nullopt;
+
+        SweepAxis axis;
+        if (!isRange) {
+            axis.values = numbers;
+            axis.min = *std::ranges::min_element(numbers);
+            axis.max = *std::ranges::max_element(numbers);
+            return axis;
+        }
+        if (numbers.size() < 2 || numbers.size() > 3 || numbers[1] < numbers[0]) return std::nullopt;
+
+        axis.min = numbers[0];
+        axis.max = numbers[1];
+        if (numbers.size() == 2) {
+            axis.continuous = true;
+            axis.values = {axis.min, axis.max};
+            return axis;
+        }
+        const int count = static_cast<int>(numbers[2]);
+        if (count < 1) return std::nullopt;
+        for (int i = 0; i < count; i++) {
+            axis.values.push_back(count == 1 ? axis.min : axis.min + (axis.max - axis.min) * i / (count - 1));
+        }
+        return axis;
+    }
+
+    // Maps a stratified sample u in [0, 1) onto the axis
+    [[nodiscard]] float sample(const float u) const {
+        if (continuous) return min + (max - min) * u;
+        return values[std::min(values.size() - 1, static_cast<size_t>(u * static_cast<float>(values.size())))];
+    }
+};
+
+// The GUI's tunable parameters as sweep axes. Everything else (shape, confluence target, tick limit, base seed) is
+// taken from base and shared by every run.
+struct SweepSpec {
+    RunParameters base;
+    SweepAxis lengthMm = SweepAxis::fixed(5.0f);
+    SweepAxis widthMm = SweepAxis::fixed(5.0f);
+    SweepAxis layers = SweepAxis::fixed(1.0f);
+    SweepAxis cellSplitHours = SweepAxis::fixed(8.0f);
+    SweepAxis spawnChance = SweepAxis::fixed(1.0f);
+    SweepAxis spacing = SweepAxis::fixed(20.0f);
+    int replicates = 1;
+
+    // Full factorial grid, each point repeated with distinct seeds
+    [[nodiscard]] std::vector<RunParameters> expandGrid() const {
+        std::vector<RunParameters> runs;
+        for (const float length: lengthMm.values)
+            for (const float width: widthMm.values)
+                for (const float layerCount: layers.values)
+                    for (const float split: cellSplitHours.values)
+                        for (const float chance: spawnChance.values)
+                            for (const float space: spacing.values) {
+                                const std::array point = {length, width, layerCount, split, chance, space};
+                                addReplicates(runs, point);
+                            }
+        return runs;
+    }
+
+    // Latin-hypercube design with the given number of points: every axis is cut into that many equal strata and each
+    // stratum is used exactly once, so a few hundred runs cover the space far more evenly than a coarse grid.
+    [[nodiscard]] std::vector<RunParameters> sampleLatinHypercube(const int samples) const {
+        std::vector<RunParameters> runs;
+        if (samples <= 0) return runs;
+
+        std::mt19937_64 rng(base.seed);
+        std::uniform_real_distribution<float> jitter(0.0f, 1.0f);
+        const std::array axes = {&lengthMm, &widthMm, &layers, &cellSplitHours, &spawnChance, &spacing};
+        std::array<std::vector<float>, 6> strata;
+        for (auto &column: strata) {
+            column.resize(samples);
+            for (int i = 0; i < samples; i++) {
+                column[i] = (static_cast<float>(i) + jitter(rng)) / static_cast<float>(samples);
+            }
+            std::ranges::shuffle(column, rng);
+        }
+
+        for (int i = 0; i < samples; i++) {
+            std::array<float, 6> point{};
+            for (size_t axis = 0; axis < axes.size(); axis++) {
+                point[axis] = axes[axis]->sample(std::min(strata[axis][i], 0.99999994f));
+            }
+            addReplicates(runs, point);
+        }
+        return runs;
+    }
+
+private:
+    void addReplicates(std::vector<RunParameters> &runs, const std::array<float, 6> &point) const {
+        for (int replicate = 0; replicate < replicates; replicate++) {
+            RunParameters params = base;
+            params.lengthMm = point[0];
+            params.widthMm = point[1];
+            params.layers = std::max(1, static_cast<int>(std::lround(point[2])));
+            params.cellSplitHours = point[3];
+            params.spawnChance = point[4];
+            params.spacing = point[5];
+            params.seed = base.seed + runs.size();
+            runs.push_back(params);
+        }
+    }
+};
+
+struct SweepOptions {
+    int workers = 0;         // concurrent simulations; 0 picks one per coresPerWorker available cores
+    int coresPerWorker = 1;  // TBB threads each simulation may use
+    bool pinWorkers = true;  // bind each worker process to its own cores (Linux only)
+    bool useProcesses = true; // fork one process per run; otherwise run workers as threads of this process
+    bool recordTicks = false;
+};
+
+struct SweepRun {
+    RunParameters params;
+    RunResult result;
+    std::vector<TickSample> ticks;
+    bool completed = false;
+};
+
+// Runs many independent headless simulations on a bounded pool of workers. Each run gets its own process, forked
+// from this one, so runs share no allocator, TBB scheduler or cache lines and a crashed run cannot take the sweep
+// down with it. A worker slot owns a fixed group of cores: the process is pinned to them and its TBB parallelism is
+// capped to their count. Where fork is unavailable, workers are threads with one task_arena each instead.
+class SweepRunner {
+public:
+    explicit SweepRunner(const SweepOptions &options)
+        : options(options),
+          cores(availableCores()) {
+        this->options.coresPerWorker = std::max(1, options.coresPerWorker);
+        if (this->options.workers <= 0) {
+            this->options.workers = std::max(1, static_cast<int>(cores.size()) / this->options.coresPerWorker);
+        }
+    }
+
+    [[nodiscard]] int getWorkerCount() const {
+        return options.workers;
+    }
+
+    std::vector<SweepRun> run(const std::vector<RunParameters> &runs) {
+        std::vector<SweepRun> results(runs.size());
+        for (size_t i = 0; i < runs.size(); i++) {
+            results[i].params = runs[i];
+        }
+
+#if defined(CELL_SIM_SWEEP_PROCESSES)
+        if (options.useProcesses) {
+            runInProcesses(results);
+            return results;
+        }
+#endif
+        runInThreads(results);
+        return results;
+    }
+
+    static void writeResultsCsv(std::ostream &out, const std::vector<SweepRun> &runs) {
+        out << "run,seed,length_mm,width_mm,layers,cell_split_hours,spawn_chance,spacing,shape,seeding,initial_cells,"
+               "capacity,final_cells,final_confluence,ticks,ticks_to_confluence,hours_to_confluence,mean_tick_ms,max_tick_ms,"
+               "total_ms,status\n";
+        for (size_t i = 0; i < runs.size(); i++) {
+            const RunParameters &p = runs[i].params;
+            const RunResult &r = runs[i].result;
+            out << i << ',' << p.seed << ',' << p.lengthMm << ',' << p.widthMm << ',' << p.layers << ','
+                << p.cellSplitHours << ',' << p.spawnChance << ',' << p.spacing << ',' << boundaryPresetName(p.shape)
+                << ',' << seedingStrategyName(p.seeding.strategy) << ',' << r.initialCells << ',' << r.capacity << ',' << r.finalCells << ',' << r.finalConfluence << ','
+                << r.ticks << ',' << r.ticksToConfluence << ',' << r.hoursToConfluence << ',' << r.meanTickMs << ','
+                << r.maxTickMs << ',' << r.totalMs << ',' << (runs[i].completed ? "ok" : "failed") << '\n';
+        }
+    }
+
+    static void writeTicksCsv(std::ostream &out, const std::vector<SweepRun> &runs) {
+        out << "run,tick,cells,confluence,tick_ms\n";
+        for (size_t i = 0; i < runs.size(); i++) {
+            for (const TickSample &sample: runs[i].ticks) {
+                out << i << ',' << sample.tick << ',' << sample.cells << ',' << sample.confluence << ','
+                    << sample.tickMs << '\n';
+            }
+        }
+    }
+
+private:
+    SweepOptions options;
+    std::vector<int> cores;
+
+    // CPUs this process may run on, honoring an affinity mask set from outside (taskset, cgroups, a batch scheduler)
+    static std::vector<int> availableCores() {
+        std::vector<int> result;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) result.push_back(cpu);
+            }
+        }
+#endif
+        if (result.empty()) {
+            const int count = std::max(1u, std::thread::hardware_concurrency());
+            for (int cpu = 0; cpu < count; cpu++) result.push_back(cpu);
+        }
+        return result;
+    }
+
+    void pinToSlot(const int slot) const {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int i = 0; i < options.coresPerWorker; i++) {
+            CPU_SET(cores[(static_cast<size_t>(slot) * options.coresPerWorker + i) % cores.size()], &set);
+        }
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            std::cerr << "Could not pin sweep worker " << slot << ": " << std::strerror(errno) << std::endl;
+        }
+#else
+        (void) slot;
+#endif
+    }
+
+    void executeRun(SweepRun &run) const {
+        run.result = runHeadless(run.params, [&](const TickSample &sample, const ColonySimulation &) {
+            if (options.recordTicks) run.ticks.push_back(sample);
+        });
+        run.completed = true;
+    }
+
+    static void reportProgress(const size_t done, const size_t total, const size_t index, const SweepRun &run) {
+        std::cerr << "[" << done << "/" << total << "] run " << index
+                  << (run.completed ? " finished in " + std::to_string(static_cast<long long>(run.result.totalMs)) +
+                                      " ms"
+                                    : std::string(" failed")) << std::endl;
+    }
+
+    void runInThreads(std::vector<SweepRun> &results) const {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::vector<std::thread> workers;
+        for (int slot = 0; slot < options.workers; slot++) {
+            workers.emplace_back([&] {
+                tbb::task_arena arena(options.coresPerWorker);
+                for (size_t i = next++; i < results.size(); i = next++) {
+                    arena.execute([&] { executeRun(results[i]); });
+                    reportProgress(++done, results.size(), i, results[i]);
+                }
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+
+#if defined(CELL_SIM_SWEEP_PROCESSES)
+    struct ChildProcess {
+        pid_t pid;
+        int fd;
+        size_t runIndex;
+        int slot;
+        std::vector<char> payload;
+    };
+
+    static bool writeAll(const int fd, const void *data, size_t size) {
+        auto bytes = static_cast<const char *>(data);
+        while (size > 0) {
+            const ssize_t written = write(fd, bytes, size);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+            bytes += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    // Child side: run, then send the result and the tick log back through the pipe as raw structs (both ends are the
+    // same binary, so the layout matches)
+    [[noreturn]] void runChild(SweepRun &run, const int slot, const int fd) const {
+        if (options.pinWorkers) {
+            pinToSlot(slot);
+        }
+        tbb::global_control parallelism(tbb::global_control::max_allowed_parallelism, options.coresPerWorker);
+        executeRun(run);
+
+        const uint64_t tickCount = run.ticks.size();
+        const bool sent = writeAll(fd, &run.result, sizeof(RunResult)) &&
+                          writeAll(fd, &tickCount, sizeof(tickCount)) &&
+                          writeAll(fd, run.ticks.data(), tickCount * sizeof(TickSample));
+        close(fd);
+        _exit(sent ? 0 : 1);
+    }
+
+    static bool decodePayload(const std::vector<char> &payload, SweepRun &run) {
+        constexpr size_t headerSize = sizeof(RunResult) + sizeof(uint64_t);
+        if (payload.size() < headerSize) return false;
+
+        uint64_t tickCount = 0;
+        std::memcpy(&run.result, payload.data(), sizeof(RunResult));
+        std::memcpy(&tickCount, payload.data() + sizeof(RunResult), sizeof(tickCount));
+        if (payload.size() != headerSize + tickCount * sizeof(TickSample)) return false;
+
+        run.ticks.resize(tickCount);
+        std::memcpy(run.ticks.data(), payload.data() + headerSize, tickCount * sizeof(TickSample));
+        return true;
+    }
+
+    void runInProcesses(std::vector<SweepRun> &results) const {
+        std::vector<int> freeSlots;
+        for (int slot = options.workers - 1; slot >= 0; slot--) {
+            freeSlots.push_back(slot);
+        }
+        std::vector<ChildProcess> children;
+        size_t next = 0;
+        size_t done = 0;
+
+        const auto finish = [&](ChildProcess &child) {
+            close(child.fd);
+            int status = 0;
+            while (waitpid(child.pid, &status, 0) < 0 && errno == EINTR) {
+            }
+            SweepRun &run = results[child.runIndex];
+            run.completed = WIFEXITED(status) && WEXITSTATUS(status) == 0 && decodePayload(child.payload, run);
+            freeSlots.push_back(child.slot);
+            reportProgress(++done, results.size(), child.runIndex, run);
+        };
+
+        while (next < results.size() || !children.empty()) {
+            while (!freeSlots.empty() && next < results.size()) {
+                const size_t runIndex = next++;
+                int fds[2];
+                if (pipe(fds) != 0) {
+                    std::cerr << "Could not create a pipe for sweep run " << runIndex << ": " << std::strerror(errno)
+                              << std::endl;
+                    reportProgress(++done, results.size(), runIndex, results[runIndex]);
+                    continue;
+                }
+
+                const int slot = freeSlots.back();
+                std::cout.flush();
+                std::cerr.flush();
+                const pid_t pid = fork();
+                if (pid == 0) {
+                    close(fds[0]);
+                    runChild(results[runIndex], slot, fds[1]);
+                }
+                close(fds[1]);
+                if (pid < 0) {
+                    std::cerr << "Could not fork sweep run " << runIndex << ": " << std::strerror(errno) << std::endl;
+                    close(fds[0]);
+                    reportProgress(++done, results.size(), runIndex, results[runIndex]);
+                    continue;
+                }
+                freeSlots.pop_back();
+                children.push_back({pid, fds[0], runIndex, slot, {}});
+            }
+            if (children.empty()) continue;
+
+            std::vector<pollfd> pollFds;
+            for (const auto &child: children) {
+                pollFds.push_back({child.fd, POLLIN, 0});
+            }
+            if (poll(pollFds.data(), pollFds.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Sweep poll failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            // Drain whatever is readable; a child is finished once its end of the pipe reports EOF
+            std::vector<bool> finished(children.size(), false);
+            for (size_t i = 0; i < children.size(); i++) {
+                if (!(pollFds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+                char buffer[65536];
+                const ssize_t bytes = read(children[i].fd, buffer, sizeof(buffer));
+                if (bytes > 0) {
+                    children[i].payload.insert(children[i].payload.end(), buffer, buffer + bytes);
+                } else if (bytes == 0 || errno != EINTR) {
+                    finish(children[i]);
+                    finished[i] = true;
+                }
+            }
+            for (size_t i = children.size(); i-- > 0;) {
+                if (finished[i]) children.erase(children.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+        }
+
+        for (auto &child: children) {
+            finish(child);
+        }
+    }
+#endif
+};
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "raylib.h"
 #include "raymath.h"
+#include "CellIndex.h"
+#include "NumaPartitioner.h"
 
-struct TransformData {
-    std::vector<bool> is_visible;
-    std::vector<int> neighbor_counts;
+template<typename Index = CellIndex>
+struct BasicTransformData {
+    // One byte per flag rather than std::vector<bool> so different cells can be written from different threads
+    NumaVector<uint8_t> is_visible;
+    NumaVector<int> neighbor_counts;
 
     void reserve(const size_t n) {
         is_visible.reserve(n);
@@ -19,9 +24,21 @@ struct TransformData {
         neighbor_counts.push_back(0);
     }
 
+    // Grows or shrinks to n cells. New cells start hidden until initialize() is called on them, so a batch can
+    // size the arrays for its worst case up front and fill the slots it actually uses in parallel.
+    void resize(const size_t n) {
+        is_visible.resize(n, false);
+        neighbor_counts.resize(n, 0);
+    }
+
+    void initialize(const Index index) {
+        is_visible[index] = true;
+        neighbor_counts[index] = 0;
+    }
+
     [[nodiscard]] size_t size() const { return is_visible.size(); }
 
-    [[nodiscard]] static Matrix getTransform(const size_t index, const Vector3 &position) {
+    [[nodiscard]] static Matrix getTransform(const Index index, const Vector3 &position) {
         return MatrixTranslate(
             position.x,
             position.y,
@@ -29,19 +46,21 @@ struct TransformData {
         );
     }
 
-    void setVisibility(const size_t index, bool visible) {
+    void setVisibility(const Index index, bool visible) {
         is_visible[index] = visible;
     }
 
-    [[nodiscard]] bool isVisible(const size_t index) const {
+    [[nodiscard]] bool isVisible(const Index index) const {
         return is_visible[index];
     }
 
-    void setNeighborCount(const size_t index, int count) {
+    void setNeighborCount(const Index index, int count) {
         neighbor_counts[index] = count;
     }
 
-    [[nodiscard]] int getNeighborCount(const size_t index) const {
+    [[nodiscard]] int getNeighborCount(const Index index) const {
         return neighbor_counts[index];
     }
 };
+
+using TransformData = BasicTransformData<>;
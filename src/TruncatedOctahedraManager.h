@@ -1,165 +1,125 @@
 #pragma once
 
 #include <vector>
-#include <random>
-#include <execution>
-#include <mutex>
-#include <numeric>
-#include <unordered_set>
 #include <thread>
 #include <atomic>
-#include <condition_variable>
-#include <queue>
 #include <array>
 #include <algorithm>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <utility>
 
-#include "raylib.h"
-#include "OctahedronGrid.h"
-
-#include "BoundaryManager.h"
-#include "TransformData.h"
-
-constexpr std::array<Color, 15> NEIGHBOR_COLORS = {
-    {
-        BLUE, // 0 neighbors
-        SKYBLUE, // 1 neighbor
-        DARKBLUE, // 2 neighbors
-        PURPLE, // 3 neighbors
-        VIOLET, // 4 neighbors
-        PINK, // 5 neighbors
-        MAGENTA, // 6 neighbors
-        MAROON, // 7 neighbors
-        RED, // 8 neighbors
-        ORANGE, // 9 neighbors
-        GOLD, // 10 neighbors
-        YELLOW, // 11 neighbors
-        BEIGE, // 12 neighbors
-        LIME, // 13 neighbors
-        GREEN // 14 neighbors (fully surrounded)
-    }
-};
-
+#include <tbb/info.h>
 
-class TruncatedOctahedraManager {
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include "ColonySimulation.h"
+#include "Frustum.h"
+#include "GpuInstancing.h"
+#include "MeshGenerator.h"
+#include "NeighborColors.h"
+#include "OcclusionCulling.h"
+#include "OffsetInstancing.h"
+#include "PlateSimulation.h"
+#include "SurfaceMesher.h"
+#include "VolumeRenderer.h"
+
+template<typename Index = CellIndex>
+class BasicTruncatedOctahedraManager {
 public:
-    TruncatedOctahedraManager(const Model &model, const Material &mat)
+    using Simulation = BasicColonySimulation<Index>;
+    using Grid = typename Simulation::Grid;
+    using Transforms = typename Simulation::Transforms;
+    using Plate = BasicPlateSimulation<Index>;
+    using GpuInstancer = BasicGpuInstancer<Index>;
+    using SurfaceMesher = BasicSurfaceMesher<Index>;
+    using VolumeRenderer = BasicVolumeRenderer<Index>;
+
+    // Every full-detail cell is drawn with model's mesh, which the caller keeps
+    BasicTruncatedOctahedraManager(const Model &model, const Material &mat)
         : baseModel(model), material(mat),
-          gen(std::random_device()()),
           generationActive(false),
-          shouldStopThread(false),
-          boundaryManager(std::make_shared<BoundaryManager>()),
-          gridInitialized(false),
-          octahedraSpacing(20.0f),
-          octahedraLayers(1) {
-        setupColoredModels();
-        transforms.reserve(1000);
-        startingPositions.reserve(1000);
-        generateStartingPositions();
+          shouldStopThread(false) {
+        // Leave a core to the render thread so frames keep coming while a tick runs
+        simulation.setThreadCount(std::max(1, tbb::info::default_concurrency() - 1));
+        setupCountMaterials();
     }
 
     void handleBoundaryResizing() {
-        const float oldWidth = boundaryManager->getBoundaryWidth();
-        const float oldDepth = boundaryManager->getBoundaryDepth();
-        const float oldHeight = boundaryManager->getBoundaryHeight();
-        boundaryManager->handleResizing();
-        const float newWidth = boundaryManager->getBoundaryWidth();
-        const float newDepth = boundaryManager->getBoundaryDepth();
-        const float newHeight = boundaryManager->getBoundaryHeight();
-
-        if (oldWidth != newWidth || oldDepth != newDepth || oldHeight != newHeight) {
-            generateStartingPositions();
-        }
+        simulation.getBoundaryManager()->handleResizing();
+        generateStartingPositions();
     }
 
+    // Cheap when nothing changed: the simulation only recomputes when its seeding inputs did
     void generateStartingPositions() {
-        startingPositions.clear();
-        const float width = boundaryManager->getBoundaryWidth();
-        const float depth = boundaryManager->getBoundaryDepth();
-        const float height = boundaryManager->getBoundaryHeight();
-        const Vector3 center = boundaryManager->getBoundaryCenter();
-
-        const float horizontalSpacing = octahedraSpacing;
-        const float verticalSpacing = octahedraSpacing * 0.866025404f; // sqrt(3)/2
-
-        const float minX = center.x - width / 2 + horizontalSpacing / 2;
-        const float maxX = center.x + width / 2 - horizontalSpacing / 2;
-        const float minZ = center.z - depth / 2 + verticalSpacing / 2;
-        const float maxZ = center.z + depth / 2 - verticalSpacing / 2;
-
-        // Calculate Y position based on boundary center
-        const float minY = center.y - height / 2 + octahedraSpacing / 2;
-
-        // Calculate Y spacing for multiple layers if needed
-        float layerSpacing = octahedraLayers > 1 ? (height - octahedraSpacing) / (octahedraLayers - 1) : 0;
-        layerSpacing = std::max(layerSpacing, octahedraSpacing); // Ensure minimum spacing between layers
-
-        for (int layer = 0; layer < octahedraLayers; layer++) {
-            const float layerY = minY + layer * layerSpacing;
-            const float layerXOffset = (layer % 2) * horizontalSpacing * 0.25f;
-            const float layerZOffset = (layer % 3) * verticalSpacing * 0.25f;
-
-            for (float z = minZ + layerZOffset; z <= maxZ; z += verticalSpacing) {
-                const bool isOffsetRow = static_cast<int>((z - minZ) / verticalSpacing) % 2 == 1;
-                const float rowOffset = isOffsetRow ? horizontalSpacing * 0.5f : 0.0f;
-                for (float x = minX + rowOffset + layerXOffset; x <= maxX; x += horizontalSpacing) {
-                    const Vector3 position = {x, layerY, z};
-                    const Vector3 snappedPos = OctahedronGrid::snapToGridPosition(position);
-                    if (isWithinBoundary(snappedPos)) {
-                        startingPositions.push_back(snappedPos);
-                    }
-                }
-            }
+        if (plate) {
+            plate->generateStartingPositions();
+        } else {
+            simulation.generateStartingPositions();
         }
-
-        // If no positions were generated, add center position as a fallback
-        if (startingPositions.empty()) {
-            const Vector3 centerPos = {center.x, center.y, center.z};
-            startingPositions.push_back(OctahedronGrid::snapToGridPosition(centerPos));
-        }
-        std::cout << "Generated " << startingPositions.size() << " starting positions." << std::endl;
     }
 
-    // Create octahedra based on the precomputed starting positions
-    void createInitialOctahedra() {
-        if (transforms.size() > 0) {
-            grid = OctahedronGrid();
-            transforms = TransformData();
-            transforms.reserve(5000000);
+    void resetOctahedra() {
+        if (plate) {
+            plate->createInitialOctahedra();
+        } else {
+            simulation.createInitialOctahedra();
         }
+    }
 
-        for (const auto &position: startingPositions) {
-            addOctahedron(position);
+    // Switches to a plate of independent wells with the current settings, or back to the single colony with nullptr.
+    // Ignored while the generation thread runs.
+    void setPlateFormat(const PlateFormat *format) {
+        if (isGenerationActive()) return;
+        if (!format) {
+            plate.reset();
+            return;
         }
 
-        updateVisibility();
+        plate = std::make_unique<Plate>(*format, std::random_device()(), simulation.getThreadCount());
+        plate->setOctahedraLayers(simulation.getOctahedraLayers());
+        plate->setOctahedraSpacing(simulation.getOctahedraSpacing());
+        plate->setSpawnChance(simulation.getSpawnChance());
+        plate->setSeedingOptions(simulation.getSeedingOptions());
+        plate->generateStartingPositions();
     }
 
-    void resetOctahedra() {
-        createInitialOctahedra();
+    [[nodiscard]] const Plate *getPlate() const {
+        return plate.get();
     }
 
-    // Create independent colored models for each neighbor count
-    void setupColoredModels() {
+    // One material per neighbor count; every count draws the same uploaded cell mesh
+    void setupCountMaterials() {
         for (int i = 0; i < 15; i++) {
-            // Create a new mesh for each model
-            const Mesh mesh = MeshGenerator::genTruncatedOctahedron();
-            coloredModels[i] = LoadModelFromMesh(mesh);
             Material newMaterial = LoadMaterialDefault();
             newMaterial.maps[MATERIAL_MAP_DIFFUSE].color = NEIGHBOR_COLORS[i];
             newMaterial.maps[MATERIAL_MAP_SPECULAR].color = WHITE;
             newMaterial.maps[MATERIAL_MAP_DIFFUSE].value = 1.0f;
             newMaterial.maps[MATERIAL_MAP_SPECULAR].value = 0.5f;
             newMaterial.shader = material.shader; // Use the same shader as the base material
-            coloredModels[i].materials[0] = newMaterial;
+            countMaterials[i] = newMaterial;
         }
+
+        // The coarser levels of detail share the colored materials
+        impostorMesh = MeshGenerator::genHexagonImpostor();
+        blockMesh = GenMeshCube(1.0f, 1.0f, 1.0f);
     }
 
     [[nodiscard]] std::shared_ptr<BoundaryManager> getBoundaryManager() const {
-        return boundaryManager;
+        return simulation.getBoundaryManager();
     }
 
-    ~TruncatedOctahedraManager() {
+    [[nodiscard]] const Simulation &getSimulation() const {
+        return simulation;
+    }
+
+    ~BasicTruncatedOctahedraManager() {
         shouldStopThread = true;
 
         if (generationThread.joinable()) {
@@ -168,188 +128,265 @@ public:
         }
     }
 
-    void addOctahedron(const Vector3 &pos) {
-        if (const Vector3 snappedPos = OctahedronGrid::snapToGridPosition(pos);
-            !grid.isOccupied(snappedPos) && isWithinBoundary(snappedPos)) {
-            const size_t index = transforms.size();
-            transforms.add();
-            grid.insert(snappedPos, index);
-        }
+    // Builds the single colony's instance list on the GPU from now on, drawing with drawShader (see GpuInstancer).
+    // Returns false and keeps the CPU path when the context has no compute shaders. Call from the render thread.
+    bool enableGpuInstancing(const Shader &drawShader, const char *computeShaderPath) {
+        if (!GpuInstancer::isSupported()) return false;
+
+        auto instancer = std::make_unique<GpuInstancer>(drawShader, computeShaderPath, NEIGHBOR_COLORS);
+        if (!instancer->isValid()) return false;
+        gpuInstancer = std::move(instancer);
+        return true;
     }
 
-    [[nodiscard]] bool isWithinBoundary(const Vector3 &pos) const {
-        return boundaryManager->isPointWithinBoundary(pos);
+    void disableGpuInstancing() {
+        gpuInstancer.reset();
     }
 
-    [[nodiscard]] std::vector<Vector3> getAvailableNeighborPositions(const Vector3 &pos) const {
-        auto positions = grid.getAvailableNeighbors(pos);
+    // Skips lattice bricks of the CPU lists hidden behind what the previous frame drew (see DepthReadback). Returns
+    // false when the context cannot read depth back. Call from the render thread.
+    bool enableOcclusionCulling() {
+        if (!DepthReadback::isSupported()) return false;
+        depthReadback = std::make_unique<DepthReadback>();
+        return true;
+    }
 
-        std::vector<Vector3> filteredPositions;
-        filteredPositions.reserve(positions.size());
+    void disableOcclusionCulling() {
+        depthReadback.reset();
+    }
 
-        for (const auto &neighborPos: positions) {
-            if (boundaryManager->isPointWithinBoundary(neighborPos)) {
-                filteredPositions.push_back(neighborPos);
-            }
-        }
+    [[nodiscard]] bool isOcclusionCulling() const {
+        return depthReadback != nullptr;
+    }
 
-        return filteredPositions;
+    // Draws the full-detail cells from the CPU lists with shader, which takes one offset per instance instead of a
+    // matrix (see OffsetInstancer), or with the material's matrix shader again after disableOffsetInstancing. mesh,
+    // which the caller keeps, replaces the cell mesh for a shader made for it, such as
+    // MeshGenerator::genPackedTruncatedOctahedron with lighting_offsets_packed.vs. Call from the render thread.
+    void enableOffsetInstancing(const Shader &shader, const Mesh *mesh = nullptr) {
+        offsetInstancer = std::make_unique<OffsetInstancer>(shader);
+        offsetMesh = mesh ? std::optional<Mesh>(*mesh) : std::nullopt;
     }
 
-    void updateVisibility() {
-        std::vector<size_t> indices(transforms.size());
-        std::iota(indices.begin(), indices.end(), 0);
+    void disableOffsetInstancing() {
+        offsetInstancer.reset();
+        offsetMesh.reset();
+    }
 
-        std::for_each(
-            std::execution::par_unseq,
-            indices.begin(), indices.end(),
-            [&](const size_t idx) {
-                updateCellVisibility(idx);
-            }
-        );
+    [[nodiscard]] bool isGpuInstancing() const {
+        return gpuInstancer != nullptr;
     }
 
-    void updateCellVisibility(const size_t idx) {
-        const Vector3 pos = grid.getPositionForIndex(idx);
-        const auto neighbors = grid.getOccupiedNeighbors(pos);
+    // Draws the single colony as its surface mesh (see SurfaceMesher) with material, whose shader must take vertex
+    // normals and colors like lighting.vs, or goes back to instanced cells with nullptr. Call from the render thread.
+    void setSurfaceRendering(const Material *material) {
+        if (!material) {
+            surfaceRendering = false;
+            if (surfaceMesher) surfaceMesher->releaseGpuMeshes();
+            return;
+        }
+        surfaceMaterial = *material;
+        surfaceRendering = true;
+        if (!surfaceMesher) surfaceMesher = std::make_unique<SurfaceMesher>();
+    }
 
-        const int neighborCount = static_cast<int>(neighbors.size());
-        const bool isVisible = neighborCount < 14;
-        transforms.setVisibility(idx, isVisible);
-        transforms.setNeighborCount(idx, neighborCount);
+    [[nodiscard]] bool isSurfaceRendering() const {
+        return surfaceRendering;
     }
 
-    void updateVisibilityForNewCells(const std::vector<Vector3> &newPositions) {
-        constexpr size_t MAX_BATCH_SIZE = 1000;
+    [[nodiscard]] size_t getSurfaceTriangleCount() const {
+        return surfaceMesher ? surfaceMesher->getTriangleCount() : 0;
+    }
 
-        for (size_t startIdx = 0; startIdx < newPositions.size(); startIdx += MAX_BATCH_SIZE) {
-            const size_t batchSize = std::min(MAX_BATCH_SIZE, newPositions.size() - startIdx);
+    // Draws the single colony by ray-marching its lattice with shader (see VolumeRenderer), for colonies too large for
+    // any per-cell path. Unbounded lattices and ones too large for the textures keep the other paths. Call from the
+    // render thread.
+    void enableVolumeRendering(const Shader &shader) {
+        volumeRenderer = std::make_unique<VolumeRenderer>(shader, NEIGHBOR_COLORS);
+    }
 
-            for (size_t i = 0; i < batchSize; i++) {
-                const auto &pos = newPositions[startIdx + i];
-                if (const size_t idx = grid.findCellIndex(pos); idx != SIZE_MAX) {
-                    updateCellVisibility(idx);
-                }
-            }
+    void disableVolumeRendering() {
+        volumeRenderer.reset();
+    }
 
-            std::unordered_set<size_t> processedNeighbors;
-            processedNeighbors.reserve(batchSize * 14);
+    [[nodiscard]] bool isVolumeRendering() const {
+        return volumeRenderer != nullptr;
+    }
 
-            for (size_t i = 0; i < batchSize; i++) {
-                const auto &pos = newPositions[startIdx + i];
+    // Draws only what lies inside slab, cut open so the cells on its faces show even where they are buried, or
+    // everything again with nullptr. Only the lattice bricks the slab crosses are walked, which for a slab of layers
+    // (see getLayerSlab) means only the bricks holding those layers. Cross-sections always draw cells from the CPU lists.
+    void setClipSlab(const Slab *slab) {
+        clipSlab = slab ? std::optional<Slab>(*slab) : std::nullopt;
+    }
 
-                for (auto neighborPositions = grid.getNeighborPositions(pos, false); const auto &neighborPos:
-                     neighborPositions) {
-                    if (size_t neighborIdx = grid.findCellIndex(neighborPos); neighborIdx != SIZE_MAX) {
-                        processedNeighbors.insert(neighborIdx);
-                    }
-                }
-            }
+    [[nodiscard]] const Slab *getClipSlab() const {
+        return clipSlab ? &*clipSlab : nullptr;
+    }
 
-            std::vector neighborIndices(processedNeighbors.begin(), processedNeighbors.end());
-            if (!neighborIndices.empty()) {
-                std::for_each(
-                    std::execution::par_unseq,
-                    neighborIndices.begin(), neighborIndices.end(),
-                    [&](const size_t idx) {
-                        updateCellVisibility(idx);
-                    }
-                );
-            }
+    // The slab holding lattice layers firstLayer..lastLayer
+    [[nodiscard]] static Slab getLayerSlab(const int firstLayer, const int lastLayer) {
+        constexpr float layerHeight = Grid::SQUARE_DISTANCE * 0.5f;
+        return {
+            {0.0f, 1.0f, 0.0f}, (static_cast<float>(firstLayer) - 0.5f) * layerHeight,
+            (static_cast<float>(lastLayer) + 0.5f) * layerHeight
+        };
+    }
+
+    // The lattice layer nearest to height y
+    [[nodiscard]] static int getLayerAt(const float y) {
+        return static_cast<int>(std::lround(y / (Grid::SQUARE_DISTANCE * 0.5f)));
+    }
+
+    // Writes the single colony's surface as a Wavefront OBJ. Returns false when the file cannot be written.
+    bool exportSurface(const char *path) {
+        std::ofstream output(path);
+        if (!output) {
+            std::cerr << "Could not write " << path << std::endl;
+            return false;
         }
+        if (!surfaceMesher) surfaceMesher = std::make_unique<SurfaceMesher>();
+        surfaceMesher->update(simulation.getGrid());
+        surfaceMesher->writeObj(output);
+        return true;
+    }
+
+    // Frees everything uploaded to the GPU; call before closing the window
+    void releaseGraphics() {
+        gpuInstancer.reset();
+        offsetInstancer.reset();
+        depthReadback.reset();
+        volumeRenderer.reset();
+        if (surfaceMesher) surfaceMesher->releaseGpuMeshes();
     }
 
     void draw() const {
-        // If we're in the pre-simulation state (no octahedra created yet), show a preview
-        if (transforms.size() == 0) {
-            if (!startingPositions.empty()) {
-                drawStartingPositionsPreview();
-            }
-            boundaryManager->draw();
+        const Matrix viewProjection = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        const Frustum frustum(viewProjection);
+        if (depthReadback) depthReadback->nextFrame();
+        const bool wholeColony = !plate && !clipSlab && simulation.getTransforms().size() > 0;
+        if (volumeRenderer && wholeColony && volumeRenderer->draw(simulation.getGrid())) {
+            simulation.getBoundaryManager()->draw();
             return;
         }
 
-        // Group transforms by neighbor count (0-14)
-        std::array<std::vector<Matrix>, 15> neighborCountMatrices;
-        for (auto &matrices: neighborCountMatrices) {
-            matrices.reserve(1000);
+        if (surfaceRendering && wholeColony) {
+            surfaceMesher->update(simulation.getGrid());
+            surfaceMesher->draw(surfaceMaterial, frustum, NEIGHBOR_COLORS);
+            simulation.getBoundaryManager()->draw();
+            return;
         }
 
-        // Organize visible cells by neighbor count
-        for (size_t i = 0; i < transforms.size(); i++) {
-            if (transforms.isVisible(i)) {
-                Vector3 position = grid.getPositionForIndex(i);
-                int neighborCount = transforms.getNeighborCount(i);
+        // Unbounded lattices, plates, cross-sections and the starting-position preview still come from the CPU lists
+        if (gpuInstancer && wholeColony && !simulation.getGrid().isUnbounded()) {
+            gpuInstancer->draw(simulation.getGrid(), simulation.getTransforms().size(), frustum,
+                               getCellMesh());
+            simulation.getBoundaryManager()->draw();
+            return;
+        }
 
-                neighborCount = std::clamp(neighborCount, 0, 14);
-                neighborCountMatrices[neighborCount].push_back(transforms.getTransform(i, position));
+        // Group transforms by level of detail and neighbor count (0-14), across every well in plate mode
+        DrawLists lists;
+        for (auto &positions: lists.cells) {
+            positions.reserve(1000);
+        }
+
+        const ScreenProjection projection = ScreenProjection::fromCurrentCamera();
+        const Slab *slab = getClipSlab();
+        const DepthPyramid *occluders = depthReadback ? depthReadback->resolve() : nullptr;
+        if (plate) {
+            for (size_t well = 0; well < plate->getWellCount(); well++) {
+                gatherMatrices(plate->getWell(well), plate->getWellOffset(well), frustum, occluders, projection, slab,
+                               lists);
             }
+        } else {
+            gatherMatrices(simulation, {0.0f, 0.0f, 0.0f}, frustum, occluders, projection, slab, lists);
         }
+
         // Render each group with its corresponding colored material
+        if (offsetInstancer) {
+            offsetInstancer->draw(offsetMesh ? *offsetMesh : getCellMesh(), lists.cells, NEIGHBOR_COLORS);
+        }
         for (int count = 0; count < 15; count++) {
-            const auto &matrices = neighborCountMatrices[count];
-            if (matrices.empty()) continue;
-
-            if (constexpr size_t MAX_BATCH_SIZE = 100000; matrices.size() <= MAX_BATCH_SIZE) {
-                DrawMeshInstanced(coloredModels[count].meshes[0], coloredModels[count].materials[0], matrices.data(),
-                                  matrices.size());
-            } else {
-                for (size_t offset = 0; offset < matrices.size(); offset += MAX_BATCH_SIZE) {
-                    const size_t batchSize = std::min(MAX_BATCH_SIZE, matrices.size() - offset);
-                    DrawMeshInstanced(coloredModels[count].meshes[0], coloredModels[count].materials[0],
-                                      matrices.data() + offset, batchSize);
-                }
+            const Material &countMaterial = countMaterials[count];
+            if (!offsetInstancer) {
+                drawInstanced(getCellMesh(), countMaterial, toTranslations(lists.cells[count]));
             }
+            drawInstanced(impostorMesh, countMaterial, lists.impostors[count]);
+            drawInstanced(blockMesh, countMaterial, lists.blocks[count]);
         }
-
-        boundaryManager->draw();
-    }
-
-    void drawStartingPositionsPreview() const {
-        std::vector<Matrix> previewMatrices;
-        previewMatrices.reserve(startingPositions.size());
-
-        for (const auto &position: startingPositions) {
-            previewMatrices.push_back(TransformData::getTransform(0, position));
+        // Only the cells occlude; the boundaries are wireframes
+        if (depthReadback) depthReadback->capture(viewProjection);
+
+        if (plate) {
+            for (size_t well = 0; well < plate->getWellCount(); well++) {
+                const Vector3 offset = plate->getWellOffset(well);
+                rlPushMatrix();
+                rlTranslatef(offset.x, offset.y, offset.z);
+                plate->getWell(well).getBoundaryManager()->draw();
+                rlPopMatrix();
+            }
+        } else {
+            simulation.getBoundaryManager()->draw();
         }
+    }
 
-        if (!previewMatrices.empty()) {
-            if (constexpr size_t MAX_BATCH_SIZE = 100000; previewMatrices.size() <= MAX_BATCH_SIZE) {
-                DrawMeshInstanced(coloredModels[0].meshes[0], coloredModels[0].materials[0], previewMatrices.data(),
-                                  previewMatrices.size());
-            } else {
-                for (size_t offset = 0; offset < previewMatrices.size(); offset += MAX_BATCH_SIZE) {
-                    const size_t batchSize = std::min(MAX_BATCH_SIZE, previewMatrices.size() - offset);
-                    DrawMeshInstanced(coloredModels[0].meshes[0], coloredModels[0].materials[0],
-                                      previewMatrices.data() + offset, batchSize);
-                }
-            }
+    // World-space box around everything draw() may show: the boundaries and the allocated lattice, across every well
+    // in plate mode
+    [[nodiscard]] BoundingBox getSceneBounds() const {
+        const auto colonyBounds = [](const Simulation &colony, const Vector3 &offset) {
+            const BoundingBox boundary = colony.getBoundaryManager()->getBounds();
+            const BoundingBox lattice = colony.getGrid().getAllocatedBounds();
+            return BoundingBox{
+                Vector3Add(Vector3Min(boundary.min, lattice.min), offset),
+                Vector3Add(Vector3Max(boundary.max, lattice.max), offset)
+            };
+        };
+
+        if (!plate) return colonyBounds(simulation, {0.0f, 0.0f, 0.0f});
+        BoundingBox bounds = colonyBounds(plate->getWell(0), plate->getWellOffset(0));
+        for (size_t well = 1; well < plate->getWellCount(); well++) {
+            const BoundingBox wellBounds = colonyBounds(plate->getWell(well), plate->getWellOffset(well));
+            bounds = {Vector3Min(bounds.min, wellBounds.min), Vector3Max(bounds.max, wellBounds.max)};
         }
+        return bounds;
     }
 
     void toggleBoundaryVisibility() const {
-        boundaryManager->toggleVisibility();
+        simulation.getBoundaryManager()->toggleVisibility();
     }
 
-    void toggleBoundaryEnabled() const {
-        boundaryManager->toggleBoundaryEnabled();
+    void toggleBoundaryEnabled() {
+        simulation.toggleBoundaryEnabled();
     }
 
     [[nodiscard]] bool isBoundaryEnabled() const {
-        return boundaryManager->isBoundaryEnabled();
+        return simulation.getBoundaryManager()->isBoundaryEnabled();
     }
 
     [[nodiscard]] size_t getCount() const {
-        return transforms.size();
+        return plate ? plate->getCount() : simulation.getCount();
+    }
+
+    // Sites inside the boundary (all wells' together in plate mode), 0 until the lattice is built and for unbounded
+    // growth
+    [[nodiscard]] size_t getCapacity() const {
+        return plate ? plate->getCapacity() : simulation.getCapacity();
+    }
+
+    // Filled share of the capacity in percent
+    [[nodiscard]] float getConfluence() const {
+        return plate ? plate->getConfluence() : simulation.getConfluence();
     }
 
     [[nodiscard]] size_t getStartingPositionCount() const {
-        return startingPositions.size();
+        return plate ? plate->getStartingPositionCount() : simulation.getStartingPositions().size();
     }
 
     void setOctahedraSpacing(const float spacing) {
         if (spacing > 0.0f) {
-            octahedraSpacing = spacing;
+            simulation.setOctahedraSpacing(spacing);
+            if (plate) plate->setOctahedraSpacing(spacing);
             if (!isGenerationActive()) {
                 generateStartingPositions();
             }
@@ -357,12 +394,13 @@ public:
     }
 
     [[nodiscard]] float getOctahedraSpacing() const {
-        return octahedraSpacing;
+        return simulation.getOctahedraSpacing();
     }
 
     void setOctahedraLayers(const int layers) {
         if (layers > 0) {
-            octahedraLayers = layers;
+            simulation.setOctahedraLayers(layers);
+            if (plate) plate->setOctahedraLayers(layers);
             if (!isGenerationActive()) {
                 generateStartingPositions();
             }
@@ -370,68 +408,40 @@ public:
     }
 
     [[nodiscard]] int getOctahedraLayers() const {
-        return octahedraLayers;
+        return simulation.getOctahedraLayers();
     }
 
-    void setSpawnChance(float chance) {
-        spawnChance = std::max(0.01f, std::min(1.0f, chance));
+    void setSeedingOptions(SeedingOptions options) {
+        if (plate) plate->setSeedingOptions(options);
+        simulation.setSeedingOptions(std::move(options));
+        if (!isGenerationActive()) {
+            generateStartingPositions();
+        }
     }
-    
-    [[nodiscard]] float getSpawnChance() const {
-        return spawnChance;
+
+    [[nodiscard]] const SeedingOptions &getSeedingOptions() const {
+        return simulation.getSeedingOptions();
     }
-    
-    void trySpawningNewOctahedra(const std::function<void()> &tick) {
-        const size_t totalSize = transforms.size();
-        std::vector<bool> shouldSpawn(totalSize);
-        std::vector<size_t> indices(totalSize);
-        std::iota(indices.begin(), indices.end(), 0);
-
-        std::uniform_real_distribution dis(0.0f, 1.0f);
-        std::transform(
-            std::execution::par_unseq,
-            indices.begin(), indices.end(),
-            shouldSpawn.begin(),
-            [&](size_t idx) {
-                thread_local std::mt19937 localGen(std::random_device{}());
-                return dis(localGen) < spawnChance;
-            }
-        );
 
-        std::vector<size_t> spawnIndices;
-        spawnIndices.reserve(totalSize / 10);
-        for (size_t i = 0; i < totalSize; i++) {
-            if (shouldSpawn[i]) spawnIndices.push_back(i);
-        }
+    void setSpawnChance(const float chance) {
+        simulation.setSpawnChance(chance);
+        if (plate) plate->setSpawnChance(chance);
+    }
 
-        std::vector<Vector3> newPositions;
-        newPositions.reserve(spawnIndices.size());
-
-        std::mutex positionsMutex;
-        std::for_each(
-            std::execution::par_unseq,
-            spawnIndices.begin(), spawnIndices.end(),
-            [&](const size_t idx) {
-                thread_local std::mt19937 localGen(std::random_device{}());
-                const Vector3 currentPos = grid.getPositionForIndex(idx);
-
-                if (const auto available = getAvailableNeighborPositions(currentPos); !available.empty()) {
-                    std::uniform_int_distribution<> posDis(0, available.size() - 1);
-                    const Vector3 newPos = available[posDis(localGen)];
-                    std::lock_guard lock(positionsMutex);
-                    newPositions.push_back(newPos);
-                }
-            }
-        );
+    [[nodiscard]] float getSpawnChance() const {
+        return simulation.getSpawnChance();
+    }
 
-        for (const auto &newPos: newPositions) {
-            addOctahedron(newPos);
+    // One tick of the single colony, with the visibility update included
+    void trySpawningNewOctahedra(const std::function<void()> &tick) {
+        if (simulation.tick() > 0 && tick) {
+            tick();
         }
+    }
 
-        if (!newPositions.empty()) {
-            updateVisibilityForNewCells(newPositions);
-        }
-        if (tick && !newPositions.empty()) {
+    // One round in every well, with the visibility pass included
+    void trySpawningInPlate(const std::function<void()> &tick) {
+        if (plate->tick() > 0 && tick) {
             tick();
         }
     }
@@ -439,27 +449,10 @@ public:
     void startGenerationThread(std::function<void()> tick = nullptr) {
         if (generationActive) return;
 
-        if (!gridInitialized) {
-            // Lock boundary size so it can't be resized during simulation
-            boundaryManager->lockBoundarySize();
-
-            const float boundaryWidth = boundaryManager->getBoundaryWidth();
-            const float boundaryDepth = boundaryManager->getBoundaryDepth();
-            const float boundaryHeight = boundaryManager->getBoundaryHeight();
-
-            constexpr float gridMargin = 1.2f; // 20% margin
-            const size_t gridLength = static_cast<size_t>(boundaryWidth * gridMargin / OctahedronGrid::SQUARE_DISTANCE)
-                                      + 10;
-            const size_t gridDepth = static_cast<size_t>(
-                                          boundaryDepth * gridMargin / OctahedronGrid::SQUARE_DISTANCE) + 10;
-            const size_t gridHeight = static_cast<size_t>(boundaryHeight * gridMargin / (OctahedronGrid::SQUARE_DISTANCE / 2))
-                                     + 10;
-
-            grid.resizeGrid(gridLength, gridDepth, gridHeight);
-            transforms.reserve(gridLength * gridHeight * gridDepth);
-            gridInitialized = true;
-
-            createInitialOctahedra();
+        if (plate) {
+            plate->initializeLattices();
+        } else {
+            simulation.initializeLattice();
         }
 
         shouldStopThread = false;
@@ -493,12 +486,150 @@ public:
     }
 
 private:
+    // Levels of detail, picked per lattice brick from how tall one cell appears on screen there. Far-away cells are
+    // vertex-bound, so below IMPOSTOR_CELL_PIXELS a cell becomes a camera-facing hexagon, and below BLOCK_CELL_PIXELS
+    // the whole brick becomes one box around its visible cells, colored by their mean neighbor count.
+    static constexpr float IMPOSTOR_CELL_PIXELS = 4.0f;
+    static constexpr float BLOCK_CELL_PIXELS = 1.0f;
+
+    // Cells are only ever translated, so they keep just their positions; the coarser levels need full matrices
+    struct DrawLists {
+        std::array<std::vector<Vector3>, 15> cells;
+        std::array<std::vector<Matrix>, 15> impostors;
+        std::array<std::vector<Matrix>, 15> blocks;
+    };
+
+    [[nodiscard]] const Mesh &getCellMesh() const {
+        return baseModel.meshes[0];
+    }
+
+    static void drawInstanced(const Mesh &mesh, const Material &material, const std::vector<Matrix> &matrices) {
+        constexpr size_t MAX_BATCH_SIZE = 100000;
+        for (size_t offset = 0; offset < matrices.size(); offset += MAX_BATCH_SIZE) {
+            const size_t batchSize = std::min(MAX_BATCH_SIZE, matrices.size() - offset);
+            DrawMeshInstanced(mesh, material, matrices.data() + offset, static_cast<int>(batchSize));
+        }
+    }
+
+    [[nodiscard]] static std::vector<Matrix> toTranslations(const std::vector<Vector3> &positions) {
+        std::vector<Matrix> matrices;
+        matrices.reserve(positions.size());
+        for (const Vector3 &position: positions) {
+            matrices.push_back(MatrixTranslate(position.x, position.y, position.z));
+        }
+        return matrices;
+    }
+
+    // The lattice layers a slab, in a colony's own coordinates, can reach: all of them unless it is horizontal
+    [[nodiscard]] static std::pair<int, int> getSlabLayers(const Slab &slab) {
+        const Vector3 &normal = slab.getNormal();
+        if (normal.x != 0.0f || normal.z != 0.0f) {
+            // Far past any lattice, without overflowing once a brick's origin is subtracted
+            return {std::numeric_limits<int>::min() / 2, std::numeric_limits<int>::max() / 2};
+        }
+        const float low = std::min(slab.getLow() / normal.y, slab.getHigh() / normal.y);
+        const float high = std::max(slab.getLow() / normal.y, slab.getHigh() / normal.y);
+        constexpr float layerHeight = Grid::SQUARE_DISTANCE * 0.5f;
+        return {static_cast<int>(std::ceil(low / layerHeight)), static_cast<int>(std::floor(high / layerHeight))};
+    }
+
+    // Visible cells of one colony shifted by offset, or its starting positions as a preview before it has cells. Cells
+    // are gathered per lattice brick, and bricks outside the frustum, without visible cells, or hidden behind the
+    // previous frame's depth in occluders are skipped whole. With a slab only the cells inside it are kept, along with
+    // the buried ones its faces cut open.
+    static void gatherMatrices(const Simulation &colony, const Vector3 &offset, const Frustum &frustum,
+                               const DepthPyramid *occluders, const ScreenProjection &projection, const Slab *slab,
+                               DrawLists &lists) {
+        auto &neighborCountPositions = lists.cells;
+        const Transforms &transforms = colony.getTransforms();
+        const Grid &grid = colony.getGrid();
+
+        if (transforms.size() == 0) {
+            for (const auto &position: colony.getStartingPositions()) {
+                const Vector3 shifted = Vector3Add(position, offset);
+                if (slab && !slab->contains(shifted)) continue;
+                neighborCountPositions[0].push_back(shifted);
+            }
+            return;
+        }
+
+        // Read once: the generation thread may append cells while this runs
+        const size_t cellCount = transforms.size();
+        // A cell with a neighbor outside the slab is exposed by the cut, and neighbors are at most a square distance
+        // away
+        const auto isShown = [&](const Index i, const Vector3 &position) {
+            if (i >= cellCount) return false;
+            if (!slab) return transforms.isVisible(i);
+            const float depth = slab->depth(Vector3Add(position, offset));
+            return depth >= 0.0f && (depth < Grid::SQUARE_DISTANCE || transforms.isVisible(i));
+        };
+
+        const auto onChunk = [&](const BoundingBox &localBounds, const auto &forEachCell) {
+            const BoundingBox bounds{Vector3Add(localBounds.min, offset), Vector3Add(localBounds.max, offset)};
+            if (!frustum.intersects(bounds) || (slab && !slab->intersects(bounds))) return;
+            if (occluders && occluders->hides(bounds)) return;
+
+            const Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+            const float cellPixels = projection.pixelSize(OCTAHEDRON_WORLD_SIZE, center);
+            if (cellPixels >= IMPOSTOR_CELL_PIXELS) {
+                forEachCell([&](const Index i, const Vector3 &position) {
+                    if (!isShown(i, position)) return;
+                    const int neighborCount = std::clamp(transforms.getNeighborCount(i), 0, 14);
+                    neighborCountPositions[neighborCount].push_back(Vector3Add(position, offset));
+                });
+            } else if (cellPixels >= BLOCK_CELL_PIXELS) {
+                forEachCell([&](const Index i, const Vector3 &position) {
+                    if (!isShown(i, position)) return;
+                    const int neighborCount = std::clamp(transforms.getNeighborCount(i), 0, 14);
+                    Matrix impostor = projection.getBillboardRotation();
+                    impostor.m12 = position.x + offset.x;
+                    impostor.m13 = position.y + offset.y;
+                    impostor.m14 = position.z + offset.z;
+                    lists.impostors[neighborCount].push_back(impostor);
+                });
+            } else {
+                Vector3 low = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                               std::numeric_limits<float>::max()};
+                Vector3 high = Vector3Negate(low);
+                int neighborSum = 0;
+                int visibleCells = 0;
+                forEachCell([&](const Index i, const Vector3 &position) {
+                    if (!isShown(i, position)) return;
+                    low = Vector3Min(low, position);
+                    high = Vector3Max(high, position);
+                    neighborSum += std::clamp(transforms.getNeighborCount(i), 0, 14);
+                    visibleCells++;
+                });
+                if (visibleCells == 0) return;
+
+                // Box around the cell centers, grown by one cell
+                const Vector3 size = Vector3AddValue(Vector3Subtract(high, low), OCTAHEDRON_WORLD_SIZE);
+                const Vector3 middle = Vector3Add(Vector3Scale(Vector3Add(low, high), 0.5f), offset);
+                Matrix block = MatrixScale(size.x, size.y, size.z);
+                block.m12 = middle.x;
+                block.m13 = middle.y;
+                block.m14 = middle.z;
+                lists.blocks[(neighborSum + visibleCells / 2) / visibleCells].push_back(block);
+            }
+        };
+
+        if (slab) {
+            const auto [firstLayer, lastLayer] = getSlabLayers(slab->translated(offset));
+            grid.forEachChunkInLayers(firstLayer, lastLayer, onChunk);
+        } else {
+            grid.forEachChunk(onChunk);
+        }
+    }
+
     void generationThreadFunc(const std::function<void()> &tick) {
         constexpr float minimumTickInterval = 0.01f;
         while (!shouldStopThread) {
             auto start = std::chrono::high_resolution_clock::now();
-            trySpawningNewOctahedra(tick);
-            updateVisibility();
+            if (plate) {
+                trySpawningInPlate(tick);
+            } else {
+                trySpawningNewOctahedra(tick);
+            }
             if (shouldStopThread) break;
             auto end = std::chrono::high_resolution_clock::now();
             std::chrono::duration<float> duration = end - start;
@@ -511,21 +642,26 @@ private:
         }
     }
 
-    TransformData transforms;
-    OctahedronGrid grid;
+    Simulation simulation;
+    std::unique_ptr<Plate> plate;
     Model baseModel;
     Material material;
-    std::array<Model, 15> coloredModels;
-    std::mt19937 gen;
+    std::array<Material, 15> countMaterials;
+    Mesh impostorMesh = {};
+    Mesh blockMesh = {};
+    std::unique_ptr<GpuInstancer> gpuInstancer;
+    std::unique_ptr<OffsetInstancer> offsetInstancer;
+    std::unique_ptr<DepthReadback> depthReadback;
+    std::optional<Mesh> offsetMesh;
+    std::unique_ptr<SurfaceMesher> surfaceMesher;
+    std::unique_ptr<VolumeRenderer> volumeRenderer;
+    std::optional<Slab> clipSlab;
+    Material surfaceMaterial = {};
+    bool surfaceRendering = false;
 
     std::thread generationThread;
     std::atomic<bool> generationActive;
     std::atomic<bool> shouldStopThread;
-    std::shared_ptr<BoundaryManager> boundaryManager;
-
-    bool gridInitialized;
-    float spawnChance = 1.0f; // Default spawn chance
-    float octahedraSpacing;
-    int octahedraLayers;
-    std::vector<Vector3> startingPositions;
 };
+
+using TruncatedOctahedraManager = BasicTruncatedOctahedraManager<>;
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "raylib.h"
+
+// The cell shape, worked out at compile time and shared by everything that draws, meshes or exports cells.
+//
+// Coordinates are in UNIT (sqrt(2)) around the cell center. Every corner is an arrangement of (0, +-1, +-2), so corners
+// land on integers; neighboring sites are 4 units apart along x and z, and layers 2 units apart.
+//
+// Faces are the 6 squares, towards +x, -x, +y, -y, +z and -z, then the 8 hexagons towards (+-1, +-1, +-1). A face
+// lists its corners counter-clockwise seen from outside, and the lattice offset of the neighbor across it.
+// - A square's neighbor along y is two layers up or down.
+// - A hexagon's neighbor is one layer up or down, half a site towards -x and -z from even layers and towards +x and +z
+//   from odd ones.
+struct TruncatedOctahedron {
+    struct Point {
+        int x;
+        int y;
+        int z;
+
+        bool operator==(const Point &) const = default;
+    };
+
+    struct Face {
+        // Outward, and as an integer direction rather than a unit vector
+        Point direction;
+        Vector3 normal;
+        int cornerCount;
+        // Indices into CORNERS
+        std::array<uint8_t, 6> corners;
+        // Offset in sites and layers to the cell across the face, from even and from odd layers
+        std::array<Point, 2> neighborOffsets;
+    };
+
+    static constexpr float UNIT = 1.41421356f;
+    static constexpr int CORNER_COUNT = 24;
+    static constexpr int FACE_COUNT = 14;
+    // 2 per square and 4 per hexagon, fanned from each face's first corner
+    static constexpr int TRIANGLE_COUNT = 44;
+
+    static const std::array<Point, CORNER_COUNT> CORNERS;
+    static const std::array<Face, FACE_COUNT> FACES;
+    // Triangles over CORNERS, face by face
+    static const std::array<uint16_t, 3 * TRIANGLE_COUNT> INDICES;
+
+    // Every corner is sqrt(5) units from the center, so its direction doubles as a smooth normal
+    [[nodiscard]] static constexpr Vector3 cornerNormal(const Point &corner) {
+        constexpr float inverseLength = 0.447213595f;
+        return {
+            static_cast<float>(corner.x) * inverseLength, static_cast<float>(corner.y) * inverseLength,
+            static_cast<float>(corner.z) * inverseLength
+        };
+    }
+
+    [[nodiscard]] static constexpr Vector3 toWorld(const Point &point) {
+        return {
+            static_cast<float>(point.x) * UNIT, static_cast<float>(point.y) * UNIT,
+            static_cast<float>(point.z) * UNIT
+        };
+    }
+
+private:
+    [[nodiscard]] static constexpr std::array<Point, CORNER_COUNT> makeCorners() {
+        std::array<Point, CORNER_COUNT> corners{};
+        int next = 0;
+        for (const int a: {-1, 1}) {
+            for (const int b: {-2, 2}) {
+                corners[next++] = {0, a, b};
+                corners[next++] = {0, b, a};
+                corners[next++] = {a, 0, b};
+                corners[next++] = {b, 0, a};
+                corners[next++] = {a, b, 0};
+                corners[next++] = {b, a, 0};
+            }
+        }
+        return corners;
+    }
+
+    [[nodiscard]] static constexpr std::array<Face, FACE_COUNT> makeFaces() {
+        const std::array<Point, CORNER_COUNT> corners = makeCorners();
+        std::array<Point, FACE_COUNT> directions = {{
+            {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+        }};
+        int next = 6;
+        for (const int y: {1, -1}) {
+            for (const int z: {1, -1}) {
+                for (const int x: {1, -1}) {
+                    directions[next++] = {x, y, z};
+                }
+            }
+        }
+
+        constexpr float inverseSqrt3 = 0.577350269f;
+        std::array<Face, FACE_COUNT> faces{};
+        for (int f = 0; f < FACE_COUNT; f++) {
+            const Point &d = directions[f];
+            const bool square = f < 6;
+            // A face is the corners furthest along its direction; its center lies on the direction
+            const int reach = square ? 2 : 3;
+            const Point center = square ? Point{2 * d.x, 2 * d.y, 2 * d.z} : d;
+            const float scale = square ? 1.0f : inverseSqrt3;
+
+            Face &face = faces[f];
+            face.direction = d;
+            face.normal = {
+                static_cast<float>(d.x) * scale, static_cast<float>(d.y) * scale, static_cast<float>(d.z) * scale
+            };
+
+            std::array<uint8_t, 6> members{};
+            int count = 0;
+            for (int c = 0; c < CORNER_COUNT; c++) {
+                if (dot(corners[c], d) == reach) members[count++] = static_cast<uint8_t>(c);
+            }
+
+            // Walk the edges (2 units squared long) from the first corner, turning counter-clockwise about d
+            face.cornerCount = count;
+            face.corners[0] = members[0];
+            for (int k = 1; k < count; k++) {
+                const Point &previous = corners[face.corners[k - 1]];
+                for (int m = 0; m < count; m++) {
+                    const Point &candidate = corners[members[m]];
+                    const Point edge = minus(candidate, previous);
+                    if (dot(edge, edge) == 2 && dot(cross(minus(previous, center), minus(candidate, center)), d) > 0) {
+                        face.corners[k] = members[m];
+                        break;
+                    }
+                }
+            }
+
+            if (square) {
+                const Point offset = {d.x, 2 * d.y, d.z};
+                face.neighborOffsets = {offset, offset};
+            } else {
+                face.neighborOffsets = {
+                    Point{(d.x - 1) / 2, d.y, (d.z - 1) / 2}, Point{(d.x + 1) / 2, d.y, (d.z + 1) / 2}
+                };
+            }
+        }
+        return faces;
+    }
+
+    [[nodiscard]] static constexpr std::array<uint16_t, 3 * TRIANGLE_COUNT> makeIndices() {
+        const std::array<Face, FACE_COUNT> faces = makeFaces();
+        std::array<uint16_t, 3 * TRIANGLE_COUNT> indices{};
+        int next = 0;
+        for (const Face &face: faces) {
+            for (int c = 1; c + 1 < face.cornerCount; c++) {
+                indices[next++] = face.corners[0];
+                indices[next++] = face.corners[c];
+                indices[next++] = face.corners[c + 1];
+            }
+        }
+        return indices;
+    }
+
+    [[nodiscard]] static constexpr int dot(const Point &a, const Point &b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    [[nodiscard]] static constexpr Point minus(const Point &a, const Point &b) {
+        return {a.x - b.x, a.y - b.y, a.z - b.z};
+    }
+
+    [[nodiscard]] static constexpr Point cross(const Point &a, const Point &b) {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+};
+
+inline constexpr std::array<TruncatedOctahedron::Point, TruncatedOctahedron::CORNER_COUNT>
+        TruncatedOctahedron::CORNERS = makeCorners();
+inline constexpr std::array<TruncatedOctahedron::Face, TruncatedOctahedron::FACE_COUNT>
+        TruncatedOctahedron::FACES = makeFaces();
+inline constexpr std::array<uint16_t, 3 * TruncatedOctahedron::TRIANGLE_COUNT>
+        TruncatedOctahedron::INDICES = makeIndices();
+
+// Every face is a closed walk over distinct corners, and every corner lies on three faces
+static_assert([] {
+    std::array<int, TruncatedOctahedron::CORNER_COUNT> faceCounts{};
+    for (const auto &face: TruncatedOctahedron::FACES) {
+        for (int a = 0; a < face.cornerCount; a++) {
+            for (int b = a + 1; b < face.cornerCount; b++) {
+                if (face.corners[a] == face.corners[b]) return false;
+            }
+            faceCounts[face.corners[a]]++;
+        }
+    }
+    for (const int count: faceCounts) {
+        if (count != 3) return false;
+    }
+    return true;
+}());
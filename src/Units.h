@@ -0,0 +1,7 @@
+#pragma once
+
+// Constants for unit conversion
+// An octahedron is 0.0866mm wide, and in our 3D world it's 2.0f * 2.82842712475f
+constexpr float OCTAHEDRON_REAL_SIZE_MM = 0.0866f;
+constexpr float OCTAHEDRON_WORLD_SIZE = 2.0f * 2.82842712475f;
+constexpr float MM_TO_WORLD_SCALE = OCTAHEDRON_WORLD_SIZE / OCTAHEDRON_REAL_SIZE_MM;
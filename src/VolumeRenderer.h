@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include "CellIndex.h"
+#include "OctahedronGrid.h"
+
+// Draws a bounded colony by ray-marching its lattice in a fragment shader (volume_raymarch.fs), so a frame costs one
+// walk per covered pixel however many cells there are. The box around the lattice is drawn with its back faces; each
+// fragment casts a ray from the camera and steps from cell to cell through the faces of the truncated octahedra until
+// it reaches an occupied site, which it lights like lighting.fs and colors by its neighbor count.
+//
+// rlgl has no 3D textures, so the lattice goes up as a 2D atlas with one 64x64 tile per 16^3 brick: the brick's 16
+// layers in a 4x4 arrangement of 16x16 slices, one byte per site holding 0 when empty and 1 + the neighbor count when
+// occupied. A second texture holds each brick's largest value, and rays jump straight through bricks where it is 0.
+// Only the bricks around those whose occupancy changed are rebuilt and uploaded.
+template<typename Index = CellIndex>
+class BasicVolumeRenderer {
+public:
+    using Grid = BasicOctahedronGrid<Index>;
+
+    // shader is volume_raymarch.vs with volume_raymarch.fs; the caller keeps ownership and sets its lights
+    BasicVolumeRenderer(const Shader &shader, const std::array<Color, 15> &colors)
+        : shader(shader), box(GenMeshCube(1.0f, 1.0f, 1.0f)) {
+        sitesLoc = GetShaderLocation(shader, "sites");
+        bricksLoc = GetShaderLocation(shader, "bricks");
+        layoutLoc = GetShaderLocation(shader, "gridLayout");
+        brickCountsLoc = GetShaderLocation(shader, "brickCounts");
+        tilesPerRowLoc = GetShaderLocation(shader, "tilesPerRow");
+        siteSpacingLoc = GetShaderLocation(shader, "siteSpacing");
+        boxMinLoc = GetShaderLocation(shader, "boxMin");
+        boxMaxLoc = GetShaderLocation(shader, "boxMax");
+
+        std::array<Vector4, 15> normalized;
+        std::ranges::transform(colors, normalized.begin(), ColorNormalize);
+        SetShaderValueV(shader, GetShaderLocation(shader, "neighborColors"), normalized.data(), SHADER_UNIFORM_VEC4,
+                        static_cast<int>(normalized.size()));
+    }
+
+    BasicVolumeRenderer(const BasicVolumeRenderer &) = delete;
+    BasicVolumeRenderer &operator=(const BasicVolumeRenderer &) = delete;
+
+    ~BasicVolumeRenderer() {
+        releaseTextures();
+        UnloadMesh(box);
+    }
+
+    // Brings the textures up to date with grid and draws it. Returns false without drawing when the grid cannot be
+    // shown this way: unbounded, or with more bricks than one atlas holds.
+    bool draw(const Grid &grid) {
+        if (grid.isUnbounded() || !update(grid)) return false;
+
+        // Around every site center, odd layers' half-step included, and past every cell by more than a cell's reach so
+        // rays enter the box through empty sites
+        constexpr float spacing = Grid::SQUARE_DISTANCE;
+        const Vector3 boxMin = Vector3SubtractValue(
+            {static_cast<float>(layout.firstColumn) * spacing, 0.0f, 0.0f}, spacing);
+        const Vector3 boxMax = Vector3AddValue({
+            (static_cast<float>(layout.firstColumn + layout.length) - 0.5f) * spacing,
+            static_cast<float>(layout.height - 1) * spacing * 0.5f,
+            (static_cast<float>(layout.width) - 0.5f) * spacing
+        }, spacing);
+        const std::array<int, 4> layoutValues = {layout.firstColumn, layout.length, layout.width, layout.height};
+        const std::array<int, 3> brickCounts = {layout.bricksX, layout.bricksY, layout.bricksZ};
+
+        // Flush raylib's pending immediate-mode geometry before drawing around its batching
+        rlDrawRenderBatchActive();
+
+        rlEnableShader(shader.id);
+        rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MVP],
+                           MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+        rlSetUniform(layoutLoc, layoutValues.data(), RL_SHADER_UNIFORM_IVEC4, 1);
+        rlSetUniform(brickCountsLoc, brickCounts.data(), RL_SHADER_UNIFORM_IVEC3, 1);
+        rlSetUniform(tilesPerRowLoc, &tilesPerRow, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(siteSpacingLoc, &Grid::SQUARE_DISTANCE, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(boxMinLoc, &boxMin, RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(boxMaxLoc, &boxMax, RL_SHADER_UNIFORM_VEC3, 1);
+        constexpr int sitesSlot = 0;
+        constexpr int bricksSlot = 1;
+        rlActiveTextureSlot(sitesSlot);
+        rlEnableTexture(sitesTexture);
+        rlSetUniform(sitesLoc, &sitesSlot, RL_SHADER_UNIFORM_INT, 1);
+        rlActiveTextureSlot(bricksSlot);
+        rlEnableTexture(bricksTexture);
+        rlSetUniform(bricksLoc, &bricksSlot, RL_SHADER_UNIFORM_INT, 1);
+
+        // Back faces, so the box still covers the screen when the camera is inside it
+        rlSetCullFace(RL_CULL_FACE_FRONT);
+        if (rlEnableVertexArray(box.vaoId)) {
+            rlDrawVertexArrayElements(0, box.triangleCount * 3, nullptr);
+            rlDisableVertexArray();
+        }
+        rlSetCullFace(RL_CULL_FACE_BACK);
+
+        rlDisableTexture();
+        rlActiveTextureSlot(sitesSlot);
+        rlDisableTexture();
+        rlDisableShader();
+        return true;
+    }
+
+    // Bytes the two textures take on the GPU
+    [[nodiscard]] size_t getTextureBytes() const {
+        return static_cast<size_t>(tilesPerRow) * tileRows * (TILE_SITES + 1);
+    }
+
+    // Frees the textures; the next draw uploads everything again
+    void releaseTextures() {
+        if (sitesTexture != 0) rlUnloadTexture(sitesTexture);
+        if (bricksTexture != 0) rlUnloadTexture(bricksTexture);
+        sitesTexture = bricksTexture = 0;
+        layout = {};
+    }
+
+private:
+    static constexpr int TILE_SIZE = Grid::BRICK_SIZE * 4;
+    static constexpr int TILE_SITES = TILE_SIZE * TILE_SIZE;
+    // 256 tiles of 64 texels make 16384, the texture size every desktop GPU since OpenGL 4 allows
+    static constexpr int MAX_TILES_PER_ROW = 256;
+    static constexpr int MAX_TILE_ROWS = 256;
+    // Tiles rebuilt in parallel before going up, which bounds the staging memory when everything is rebuilt at once
+    static constexpr size_t UPLOAD_BATCH = 1024;
+
+    // Rebuilds and uploads the bricks around every change since the last call. False when the grid does not fit.
+    bool update(const Grid &grid) {
+        const typename Grid::DenseLayout gridLayout = grid.getDenseLayout();
+        const size_t brickCount = static_cast<size_t>(gridLayout.bricksX) * gridLayout.bricksY * gridLayout.bricksZ;
+        if (brickCount == 0) return false;
+
+        // Rebuild everything on the first draw and whenever the grid dropped or replaced its bricks
+        const uint64_t resets = grid.getResetCount();
+        const bool restart = gridLayout != layout || resets != seenResetCount || sitesTexture == 0;
+        if (restart) {
+            if (!allocateTextures(gridLayout, brickCount)) return false;
+            seenResetCount = resets;
+        }
+
+        std::vector<size_t> dirty;
+        const auto markAround = [&](const int originX, const int originY, const int originZ) {
+            // Neighbor counts reach one site into the bricks around a change
+            const int bx = (originX - layout.firstColumn) >> Grid::BRICK_SHIFT;
+            const int by = originY >> Grid::BRICK_SHIFT;
+            const int bz = originZ >> Grid::BRICK_SHIFT;
+            for (int y = std::max(by - 1, 0); y <= std::min(by + 1, layout.bricksY - 1); y++) {
+                for (int z = std::max(bz - 1, 0); z <= std::min(bz + 1, layout.bricksZ - 1); z++) {
+                    for (int x = std::max(bx - 1, 0); x <= std::min(bx + 1, layout.bricksX - 1); x++) {
+                        const size_t brickIndex = (static_cast<size_t>(y) * layout.bricksZ + z) * layout.bricksX + x;
+                        if (!dirtyBricks[brickIndex]) {
+                            dirtyBricks[brickIndex] = true;
+                            dirty.push_back(brickIndex);
+                        }
+                    }
+                }
+            }
+        };
+        grid.takeChangedBricks(Grid::OccupancyReader::VolumeRenderer, markAround, restart);
+        if (dirty.empty()) return true;
+
+        std::vector<std::array<uint8_t, TILE_SITES>> tiles(std::min(dirty.size(), UPLOAD_BATCH));
+        for (size_t first = 0; first < dirty.size(); first += UPLOAD_BATCH) {
+            const size_t count = std::min(UPLOAD_BATCH, dirty.size() - first);
+            tbb::parallel_for(size_t{0}, count, [&](const size_t i) {
+                brickMaximum[dirty[first + i]] = buildTile(grid, dirty[first + i], tiles[i]);
+            });
+            for (size_t i = 0; i < count; i++) {
+                const size_t brickIndex = dirty[first + i];
+                dirtyBricks[brickIndex] = false;
+                rlUpdateTexture(sitesTexture, static_cast<int>(brickIndex % tilesPerRow) * TILE_SIZE,
+                                static_cast<int>(brickIndex / tilesPerRow) * TILE_SIZE, TILE_SIZE, TILE_SIZE,
+                                PIXELFORMAT_UNCOMPRESSED_GRAYSCALE, tiles[i].data());
+            }
+        }
+        // At most one byte per brick, so the whole summary goes up again
+        rlUpdateTexture(bricksTexture, 0, 0, tilesPerRow, tileRows, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE,
+                        brickMaximum.data());
+        return true;
+    }
+
+    bool allocateTextures(const typename Grid::DenseLayout &gridLayout, const size_t brickCount) {
+        releaseTextures();
+        // Rows a multiple of 4 bytes wide, so uploads need no unpack alignment
+        const size_t columns = std::min<size_t>((brickCount + 3) & ~size_t{3}, MAX_TILES_PER_ROW);
+        const size_t rows = (brickCount + columns - 1) / columns;
+        if (rows > MAX_TILE_ROWS) {
+            if (!reportedTooLarge) {
+                std::cerr << "Lattice of " << brickCount << " bricks is too large to ray-march, drawing cells instead"
+                          << std::endl;
+                reportedTooLarge = true;
+            }
+            return false;
+        }
+
+        tilesPerRow = static_cast<int>(columns);
+        tileRows = static_cast<int>(rows);
+        sitesTexture = rlLoadTexture(nullptr, tilesPerRow * TILE_SIZE, tileRows * TILE_SIZE,
+                                     PIXELFORMAT_UNCOMPRESSED_GRAYSCALE, 1);
+        bricksTexture = rlLoadTexture(nullptr, tilesPerRow, tileRows, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE, 1);
+        if (sitesTexture == 0 || bricksTexture == 0) {
+            std::cerr << "Could not allocate the lattice textures, drawing cells instead" << std::endl;
+            releaseTextures();
+            return false;
+        }
+        layout = gridLayout;
+        brickMaximum.assign(columns * rows, 0);
+        dirtyBricks.assign(brickCount, false);
+        return true;
+    }
+
+    // Fills tile with the brick's sites in atlas order and returns the largest value
+    [[nodiscard]] uint8_t buildTile(const Grid &grid, const size_t brickIndex,
+                                    std::array<uint8_t, TILE_SITES> &tile) const {
+        const int originX = layout.firstColumn + (static_cast<int>(brickIndex % layout.bricksX) << Grid::BRICK_SHIFT);
+        const int originY = static_cast<int>(brickIndex / (static_cast<size_t>(layout.bricksX) * layout.bricksZ))
+                            << Grid::BRICK_SHIFT;
+        const int originZ = static_cast<int>(brickIndex / layout.bricksX % layout.bricksZ) << Grid::BRICK_SHIFT;
+
+        tile.fill(0);
+        uint8_t maximum = 0;
+        grid.forEachOccupiedSite(originX, originY, originZ, [&](const int x, const int y, const int z) {
+            const int lx = x - originX;
+            const int ly = y - originY;
+            const int lz = z - originZ;
+            const auto value = static_cast<uint8_t>(1 + std::clamp(grid.countOccupiedNeighbors(x, y, z), 0, 14));
+            tile[((ly >> 2) * Grid::BRICK_SIZE + lz) * TILE_SIZE + (ly & 3) * Grid::BRICK_SIZE + lx] = value;
+            maximum = std::max(maximum, value);
+        });
+        return maximum;
+    }
+
+    Shader shader;
+    Mesh box;
+    int sitesLoc = -1;
+    int bricksLoc = -1;
+    int layoutLoc = -1;
+    int brickCountsLoc = -1;
+    int tilesPerRowLoc = -1;
+    int siteSpacingLoc = -1;
+    int boxMinLoc = -1;
+    int boxMaxLoc = -1;
+
+    typename Grid::DenseLayout layout = {};
+    uint64_t seenResetCount = 0;
+    unsigned int sitesTexture = 0;
+    unsigned int bricksTexture = 0;
+    int tilesPerRow = 0;
+    int tileRows = 0;
+    std::vector<uint8_t> brickMaximum;
+    std::vector<bool> dirtyBricks;
+    bool reportedTooLarge = false;
+};
+
+using VolumeRenderer = BasicVolumeRenderer<>;
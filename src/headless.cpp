@@ -0,0 +1,751 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ConfluencePredictor.h"
+#include "DomainDecomposition.h"
+#include "EnsembleRunner.h"
+#include "FrameRecorder.h"
+#include "HeadlessRun.h"
+#include "NeighborColors.h"
+#include "PlateSimulation.h"
+#include "SoftwareRasterizer.h"
+#include "SurfaceMesher.h"
+#include "SweepRunner.h"
+
+// Command line driver for running simulations without a window
+//
+//   cell_sim_headless sweep [options]
+//   cell_sim_headless ensemble [options]
+//   cell_sim_headless calibrate [options]
+//   cell_sim_headless predict [options]
+//   cell_sim_headless plate [options]
+//   cell_sim_headless decompose [options]
+//   cell_sim_headless surface [options]
+//   cell_sim_headless render [options]
+
+namespace {
+    // --name value pairs and bare --flags, in any order
+    class CommandLine {
+    public:
+        CommandLine(const int argc, char **argv, const int first) {
+            for (int i = first; i < argc; i++) {
+                std::string arg = argv[i];
+                if (!arg.starts_with("--")) {
+                    std::cerr << "Unexpected argument " << arg << std::endl;
+                    valid = false;
+                    continue;
+                }
+                arg = arg.substr(2);
+                if (i + 1 < argc && !std::string(argv[i + 1]).starts_with("--")) {
+                    options[arg] = argv[++i];
+                } else {
+                    options[arg] = "";
+                }
+            }
+        }
+
+        [[nodiscard]] bool isValid() const {
+            return valid;
+        }
+
+        [[nodiscard]] bool has(const std::string &name) const {
+            used.push_back(name);
+            return options.contains(name);
+        }
+
+        [[nodiscard]] std::string get(const std::string &name, const std::string &fallback) const {
+            used.push_back(name);
+            const auto it = options.find(name);
+            return it != options.end() ? it->second : fallback;
+        }
+
+        template<typename T>
+        bool read(const std::string &name, T &value) const {
+            used.push_back(name);
+            const auto it = options.find(name);
+            if (it == options.end()) return true;
+            try {
+                if constexpr (std::is_integral_v<T>) {
+                    value = static_cast<T>(std::stoll(it->second));
+                } else {
+                    value = static_cast<T>(std::stod(it->second));
+                }
+                return true;
+            } catch (const std::exception &) {
+                std::cerr << "Invalid value for --" << name << ": " << it->second << std::endl;
+                return false;
+            }
+        }
+
+        bool readAxis(const std::string &name, SweepAxis &axis) const {
+            used.push_back(name);
+            const auto it = options.find(name);
+            if (it == options.end()) return true;
+            if (const auto parsed = SweepAxis::parse(it->second)) {
+                axis = *parsed;
+                return true;
+            }
+            std::cerr << "Invalid values for --" << name << ": " << it->second << std::endl;
+            return false;
+        }
+
+        // Reports options that no command asked for, which are almost always typos
+        [[nodiscard]] bool allUsed() const {
+            bool ok = true;
+            for (const auto &[name, value]: options) {
+                if (std::ranges::find(used, name) == used.end()) {
+                    std::cerr << "Unknown option --" << name << std::endl;
+                    ok = false;
+                }
+            }
+            return ok;
+        }
+
+    private:
+        std::map<std::string, std::string> options;
+        mutable std::vector<std::string> used;
+        bool valid = true;
+    };
+
+    bool readRunParameters(const CommandLine &args, RunParameters &params) {
+        if (args.has("shape")) {
+            const auto shape = parseBoundaryPreset(args.get("shape", ""));
+            if (!shape) {
+                std::cerr << "Unknown shape " << args.get("shape", "")
+                          << " (expected box, round-well, hanging-drop or channel)" << std::endl;
+                return false;
+            }
+            params.shape = *shape;
+        }
+        if (args.has("seeding")) {
+            const auto strategy = parseSeedingStrategy(args.get("seeding", ""));
+            if (!strategy) {
+                std::cerr << "Unknown seeding " << args.get("seeding", "")
+                          << " (expected hexagonal, uniform, poisson or clustered)" << std::endl;
+                return false;
+            }
+            params.seeding.strategy = *strategy;
+        }
+        // Loaded once here and shared by every run
+        if (args.has("seed-file")) {
+            const std::string path = args.get("seed-file", "");
+            if (path.ends_with(".csv")) {
+                params.seeding.pointList = SeedPointList::loadFromCsv(path);
+                params.seeding.strategy = SeedingStrategy::PointList;
+            } else {
+                params.seeding.densityMap = SeedDensityMap::loadFromImage(path);
+                params.seeding.strategy = SeedingStrategy::DensityImage;
+            }
+            if (!params.seeding.pointList && !params.seeding.densityMap) return false;
+        }
+        return args.read("cluster-size", params.seeding.seedsPerCluster) &&
+               args.read("cluster-radius", params.seeding.clusterRadius) &&
+               args.read("confluence", params.confluencePercent) &&
+               args.read("max-ticks", params.maxTicks) &&
+               args.read("stall-ticks", params.stallTicks) &&
+               args.read("seed", params.seed) &&
+               args.read("grain", params.grainSize);
+    }
+
+    // The swept parameters as plain values, for commands that run a single parameter set
+    bool readPointParameters(const CommandLine &args, RunParameters &params) {
+        return args.read("length-mm", params.lengthMm) &&
+               args.read("width-mm", params.widthMm) &&
+               args.read("layers", params.layers) &&
+               args.read("split-hours", params.cellSplitHours) &&
+               args.read("spawn-chance", params.spawnChance) &&
+               args.read("spacing", params.spacing);
+    }
+
+    // --table FILE loads calibration tables; without it predictions use the analytic fallback
+    bool loadPredictor(const CommandLine &args, ConfluencePredictor &predictor) {
+        if (!args.has("table")) return true;
+        return predictor.loadTable(args.get("table", ""));
+    }
+
+    void printUsage() {
+        std::cerr <<
+                "Usage: cell_sim_headless <command> [options]\n"
+                "\n"
+                "Commands:\n"
+                "  sweep    run a parameter grid or Latin-hypercube design and write one CSV row per run\n"
+                "  ensemble run replicates of one parameter set and write confidence intervals per tick\n"
+                "  calibrate measure ticks-to-confluence tables for the spacing predictor\n"
+                "  predict  solve the seeding spacing for a target time from calibration tables\n"
+                "  plate    grow one colony per well of a multi-well plate and write one CSV row per well\n"
+                "  decompose grow one large colony split into slabs over several worker processes\n"
+                "  surface  grow one colony and export its outer surface as a Wavefront OBJ mesh\n"
+                "  render   grow one colony and render its surface to images without a window\n"
+                "\n"
+                "Swept parameters take a list (8,12,16), an evenly spaced grid (8:24:5) or a range (8:24):\n"
+                "  --length-mm, --width-mm, --layers, --split-hours, --spawn-chance, --spacing\n"
+                "\n"
+                "Sweep options:\n"
+                "  --lhs N              sample N Latin-hypercube points instead of the full grid\n"
+                "  --replicates N       runs per point, each with its own seed (default 1)\n"
+                "  --shape NAME         box, round-well, hanging-drop or channel (default box)\n"
+                "  --seeding NAME       hexagonal, uniform, poisson or clustered starting cells (default hexagonal)\n"
+                "  --seed-file FILE     seed from a CSV of x,z or x,y,z millimetres, or a grayscale density image\n"
+                "  --cluster-size N     seeds per cluster for clustered seeding (default 12)\n"
+                "  --cluster-radius R   spread of a cluster in world units (default 15)\n"
+                "  --confluence PCT     stop a run once this share of the boundary is filled (default 85)\n"
+                "  --max-ticks N        stop a run after N ticks (default 1000)\n"
+                "  --stall-ticks N      stop a run after N ticks without divisions (default 50)\n"
+                "  --seed S             base seed; run i uses S + i (default 1)\n"
+                "  --grain N            cells per task in the per-cell loops (default 2048)\n"
+                "  --workers N          concurrent runs (default: available cores / cores-per-worker)\n"
+                "  --cores-per-worker N threads per run (default 1)\n"
+                "  --no-pin             do not bind workers to cores\n"
+                "  --threads            run workers as threads instead of separate processes\n"
+                "  --output FILE        results table (default sweep_results.csv)\n"
+                "  --ticks-output FILE  also write per-tick cell counts and timings\n"
+                "  --target-hours H     instead of --spacing, seed each run to reach its confluence target after H hours\n"
+                "  --table FILE         calibration tables for --target-hours (default: analytic estimate)\n"
+                "\n"
+                "Ensemble options (parameters take single values; shape, seeding, confluence, tick limits and seed as\n"
+                "above):\n"
+                "  --replicates N       number of replicate colonies (default 100)\n"
+                "  --workers N          worker threads (default: all cores)\n"
+                "  --output FILE        end-of-run summary (default ensemble_summary.csv)\n"
+                "  --ticks-output FILE  per-tick statistics (default ensemble_ticks.csv)\n"
+                "\n"
+                "Calibrate options (--layers, --spawn-chance and --spacing are swept as above):\n"
+                "  --replicates N       runs averaged per point (default 3)\n"
+                "  --workers, --cores-per-worker, --no-pin, --threads, --max-ticks, --seed as for sweep\n"
+                "  --output FILE        calibration table (default confluence_table.csv)\n"
+                "\n"
+                "Predict options:\n"
+                "  --table FILE         calibration tables (default: analytic estimate)\n"
+                "  --target-hours H     time by which the confluence target should be reached (default 120)\n"
+                "  --split-hours, --spawn-chance, --layers, --confluence as single values\n"
+                "\n"
+                "Plate options (parameters take single values except the footprint, which the wells set; seeding,\n"
+                "confluence, tick limits and seed as for sweep, well i seeded with S + i):\n"
+                "  --format N           6, 24, 96 or 384 wells (default 96)\n"
+                "  --workers N          worker threads shared by all wells (default: all cores)\n"
+                "  --output FILE        per-well results (default plate_results.csv)\n"
+                "\n"
+                "Decompose options (parameters take single values; shape, seeding, confluence, tick limits and seed as\n"
+                "for sweep):\n"
+                "  --workers N          slab worker processes (default 2)\n"
+                "  --cores-per-worker N threads per worker (default 1)\n"
+                "  --no-pin             do not bind workers to cores\n"
+                "  --ring-kb N          halo exchange buffer per direction and worker (default 1024)\n"
+                "  --check              also run the colony undecomposed and compare the results\n"
+                "  --output FILE        per-slab results (default decompose_slabs.csv)\n"
+                "\n"
+                "Surface options (parameters take single values; shape, seeding, confluence, tick limits and seed as\n"
+                "for sweep):\n"
+                "  --output FILE        surface mesh (default colony_surface.obj)\n"
+                "\n"
+                "Render options (parameters take single values; shape, seeding, confluence, tick limits and seed as\n"
+                "for sweep):\n"
+                "  --every N            render every Nth tick (default 1)\n"
+                "  --width N, --height N image size in pixels (default 1280 x 720)\n"
+                "  --camera-path FILE   CSV of tick,px,py,pz,tx,ty,tz[,fovy] keyframes (default: orbit the boundary)\n"
+                "  --output DIR         PNG frames (default frames)\n"
+                "  --raw FILE           write raw RGB24 frames to FILE, or - for stdout, instead of PNGs\n"
+                "  --queue N            frames waiting to be written before new ones are dropped (default 16)\n";
+    }
+
+    int runSweep(const CommandLine &args) {
+        SweepSpec spec;
+        SweepOptions options;
+        int lhsSamples = 0;
+        if (!readRunParameters(args, spec.base) ||
+            !args.readAxis("length-mm", spec.lengthMm) ||
+            !args.readAxis("width-mm", spec.widthMm) ||
+            !args.readAxis("layers", spec.layers) ||
+            !args.readAxis("split-hours", spec.cellSplitHours) ||
+            !args.readAxis("spawn-chance", spec.spawnChance) ||
+            !args.readAxis("spacing", spec.spacing) ||
+            !args.read("replicates", spec.replicates) ||
+            !args.read("lhs", lhsSamples) ||
+            !args.read("workers", options.workers) ||
+            !args.read("cores-per-worker", options.coresPerWorker)) {
+            return 1;
+        }
+        float targetHours = 0.0f;
+        ConfluencePredictor predictor;
+        if (!args.read("target-hours", targetHours) || !loadPredictor(args, predictor)) {
+            return 1;
+        }
+        options.pinWorkers = !args.has("no-pin");
+        options.useProcesses = !args.has("threads");
+        const std::string outputPath = args.get("output", "sweep_results.csv");
+        const std::string ticksPath = args.get("ticks-output", "");
+        options.recordTicks = !ticksPath.empty();
+        if (!args.allUsed()) return 1;
+
+        spec.replicates = std::max(1, spec.replicates);
+        std::vector<RunParameters> runs = lhsSamples > 0 ? spec.sampleLatinHypercube(lhsSamples) : spec.expandGrid();
+        if (targetHours > 0.0f) {
+            // Seed every run so that it is predicted to reach its confluence target at the same time
+            for (RunParameters &run: runs) {
+                run.spacing = predictor.solveSpacing(targetHours, run.cellSplitHours, run.confluencePercent,
+                                                     run.spawnChance, run.layers);
+            }
+        }
+
+        SweepRunner runner(options);
+        std::cerr << "Sweeping " << runs.size() << " runs on " << runner.getWorkerCount() << " workers" << std::endl;
+        const std::vector<SweepRun> results = runner.run(runs);
+
+        std::ofstream output(outputPath);
+        if (!output) {
+            std::cerr << "Could not write " << outputPath << std::endl;
+            return 1;
+        }
+        SweepRunner::writeResultsCsv(output, results);
+
+        if (!ticksPath.empty()) {
+            std::ofstream ticksOutput(ticksPath);
+            if (!ticksOutput) {
+                std::cerr << "Could not write " << ticksPath << std::endl;
+                return 1;
+            }
+            SweepRunner::writeTicksCsv(ticksOutput, results);
+        }
+
+        const auto failed = std::ranges::count_if(results, [](const SweepRun &run) { return !run.completed; });
+        std::cerr << "Wrote " << results.size() << " runs to " << outputPath;
+        if (failed > 0) std::cerr << " (" << failed << " failed)";
+        std::cerr << std::endl;
+        return failed > 0 ? 2 : 0;
+    }
+
+    int runEnsembleCommand(const CommandLine &args) {
+        RunParameters params;
+        int replicates = 100;
+        int workers = 0;
+        if (!readRunParameters(args, params) ||
+            !readPointParameters(args, params) ||
+            !args.read("replicates", replicates) ||
+            !args.read("workers", workers)) {
+            return 1;
+        }
+        const std::string outputPath = args.get("output", "ensemble_summary.csv");
+        const std::string ticksPath = args.get("ticks-output", "ensemble_ticks.csv");
+        if (!args.allUsed()) return 1;
+        if (replicates < 1 || params.maxTicks < 1) {
+            std::cerr << "Need at least one replicate and one tick" << std::endl;
+            return 1;
+        }
+
+        const EnsembleStatistics statistics = runEnsemble(params, replicates, workers);
+
+        std::ofstream output(outputPath);
+        std::ofstream ticksOutput(ticksPath);
+        if (!output || !ticksOutput) {
+            std::cerr << "Could not write " << (output ? ticksPath : outputPath) << std::endl;
+            return 1;
+        }
+        statistics.writeSummaryCsv(output);
+        statistics.writeTicksCsv(ticksOutput);
+
+        const StreamingSummary &hours = statistics.getHoursToConfluence();
+        std::cerr << hours.getMoments().getCount() << "/" << statistics.getReplicateCount()
+                  << " replicates reached " << params.confluencePercent << "% confluence";
+        if (hours.getMoments().getCount() > 0) {
+            std::cerr << " after " << hours.getMoments().getMean() << " +- " << hours.getMoments().getConfidence95()
+                      << " hours";
+        }
+        std::cerr << std::endl;
+        return 0;
+    }
+
+    // Runs every (layers, spawn chance, spacing) point to full confluence on the reference footprint and records when
+    // the mean confluence curve crosses each 5% level
+    int runCalibrate(const CommandLine &args) {
+        SweepSpec spec;
+        SweepOptions options;
+        spec.replicates = 3;
+        spec.base.maxTicks = 5000;
+        spec.layers = *SweepAxis::parse("1,2,3");
+        spec.spawnChance = *SweepAxis::parse("0.1,0.25,0.5,0.75,1");
+        spec.spacing = *SweepAxis::parse("6:60:10");
+        if (!args.read("max-ticks", spec.base.maxTicks) ||
+            !args.read("seed", spec.base.seed) ||
+            !args.readAxis("layers", spec.layers) ||
+            !args.readAxis("spawn-chance", spec.spawnChance) ||
+            !args.readAxis("spacing", spec.spacing) ||
+            !args.read("replicates", spec.replicates) ||
+            !args.read("workers", options.workers) ||
+            !args.read("cores-per-worker", options.coresPerWorker)) {
+            return 1;
+        }
+        options.pinWorkers = !args.has("no-pin");
+        options.useProcesses = !args.has("threads");
+        options.recordTicks = true;
+        const std::string outputPath = args.get("output", "confluence_table.csv");
+        if (!args.allUsed()) return 1;
+
+        spec.replicates = std::max(1, spec.replicates);
+        spec.base.confluencePercent = 100.0f;
+        spec.base.stopAtConfluence = false;
+        const std::vector<RunParameters> runs = spec.expandGrid();
+
+        SweepRunner runner(options);
+        std::cerr << "Calibrating " << runs.size() / spec.replicates << " points x " << spec.replicates
+                  << " replicates on " << runner.getWorkerCount() << " workers" << std::endl;
+        const std::vector<SweepRun> results = runner.run(runs);
+
+        // expandGrid keeps the replicates of a point next to each other
+        ConfluencePredictor predictor;
+        for (size_t first = 0; first < results.size(); first += spec.replicates) {
+            const auto replicateRuns = std::span(results).subspan(first, spec.replicates);
+            size_t longest = 0;
+            int completed = 0;
+            for (const SweepRun &run: replicateRuns) {
+                if (!run.completed || run.ticks.empty()) continue;
+                completed++;
+                longest = std::max(longest, run.ticks.size());
+            }
+            // Runs that stopped early (full or stalled) hold their final confluence
+            std::vector<float> meanConfluence(longest, 0.0f);
+            for (const SweepRun &run: replicateRuns) {
+                if (!run.completed || run.ticks.empty()) continue;
+                for (size_t tick = 0; tick < longest; tick++) {
+                    meanConfluence[tick] += run.ticks[std::min(tick, run.ticks.size() - 1)].confluence;
+                }
+            }
+            if (completed == 0) {
+                std::cerr << "No completed runs for calibration point " << first / spec.replicates << std::endl;
+                return 2;
+            }
+            for (float &confluence: meanConfluence) {
+                confluence /= static_cast<float>(completed);
+            }
+
+            const RunParameters &point = results[first].params;
+            predictor.addCalibrationPoint(point.layers, point.spawnChance, point.spacing,
+                                          ConfluencePredictor::ticksFromCurve(meanConfluence));
+        }
+
+        std::ofstream output(outputPath);
+        if (!output) {
+            std::cerr << "Could not write " << outputPath << std::endl;
+            return 1;
+        }
+        predictor.writeTable(output);
+        std::cerr << "Wrote calibration table to " << outputPath << std::endl;
+        return 0;
+    }
+
+    int runPredict(const CommandLine &args) {
+        RunParameters params;
+        float targetHours = 120.0f;
+        ConfluencePredictor predictor;
+        if (!args.read("target-hours", targetHours) ||
+            !args.read("split-hours", params.cellSplitHours) ||
+            !args.read("spawn-chance", params.spawnChance) ||
+            !args.read("layers", params.layers) ||
+            !args.read("confluence", params.confluencePercent) ||
+            !loadPredictor(args, predictor)) {
+            return 1;
+        }
+        if (!args.allUsed()) return 1;
+
+        const float spacing = predictor.solveSpacing(targetHours, params.cellSplitHours, params.confluencePercent,
+                                                     params.spawnChance, params.layers);
+        const float hours = predictor.predictHours(spacing, params.spawnChance, params.layers,
+                                                   params.confluencePercent, params.cellSplitHours);
+        std::cout << "spacing " << spacing << " (world units), predicted " << params.confluencePercent
+                  << "% confluence ";
+        if (hours == ConfluencePredictor::NEVER_REACHED) {
+            std::cout << "never reached";
+        } else {
+            std::cout << "after " << hours << " hours";
+        }
+        std::cout << (predictor.hasTable() ? "" : " (analytic estimate)") << std::endl;
+        return 0;
+    }
+
+    // Grows every well of a plate side by side until each has reached the confluence target, filled up or stalled
+    int runPlate(const CommandLine &args) {
+        RunParameters params;
+        int workers = 0;
+        if (!readRunParameters(args, params) ||
+            !args.read("layers", params.layers) ||
+            !args.read("split-hours", params.cellSplitHours) ||
+            !args.read("spawn-chance", params.spawnChance) ||
+            !args.read("spacing", params.spacing) ||
+            !args.read("workers", workers)) {
+            return 1;
+        }
+        const std::string formatName = args.get("format", "96");
+        const std::string outputPath = args.get("output", "plate_results.csv");
+        if (!args.allUsed()) return 1;
+        const PlateFormat *format = findPlateFormat(formatName);
+        if (!format) {
+            std::cerr << "Unknown plate format " << formatName << " (expected 6, 24, 96 or 384)" << std::endl;
+            return 1;
+        }
+
+        PlateSimulation plate(*format, params.seed, workers > 0 ? workers : tbb::task_arena::automatic);
+        plate.setOctahedraLayers(params.layers);
+        plate.setOctahedraSpacing(params.spacing);
+        plate.setSpawnChance(params.spawnChance);
+        plate.setSeedingOptions(params.seeding);
+        plate.generateStartingPositions();
+        plate.initializeLattices();
+
+        const size_t wellCount = plate.getWellCount();
+        std::vector<size_t> initialCells(wellCount);
+        std::vector<int> ticksToConfluence(wellCount, -1);
+        for (size_t well = 0; well < wellCount; well++) {
+            initialCells[well] = plate.getWell(well).getCount();
+        }
+
+        std::cerr << "Growing " << wellCount << " wells of a " << format->name << " plate" << std::endl;
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        int ticks = 0;
+        int idleTicks = 0;
+        while (ticks < params.maxTicks && idleTicks < params.stallTicks) {
+            const size_t inserted = plate.tick();
+            ticks++;
+            idleTicks = inserted == 0 ? idleTicks + 1 : 0;
+
+            bool done = true;
+            for (size_t well = 0; well < wellCount; well++) {
+                const auto &simulation = plate.getWell(well);
+                if (ticksToConfluence[well] < 0 && simulation.getConfluence() >= params.confluencePercent) {
+                    ticksToConfluence[well] = ticks;
+                }
+                done = done && (ticksToConfluence[well] >= 0 || simulation.getCount() >= simulation.getCapacity());
+            }
+            if (done) break;
+        }
+        const double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        std::ofstream output(outputPath);
+        if (!output) {
+            std::cerr << "Could not write " << outputPath << std::endl;
+            return 1;
+        }
+        output << "well,initial_cells,final_cells,capacity,final_confluence,ticks_to_confluence,hours_to_confluence\n";
+        int reached = 0;
+        for (size_t well = 0; well < wellCount; well++) {
+            const auto &simulation = plate.getWell(well);
+            const int wellTicks = ticksToConfluence[well];
+            reached += wellTicks >= 0 ? 1 : 0;
+            output << plate.getWellLabel(well) << ',' << initialCells[well] << ',' << simulation.getCount() << ','
+                   << simulation.getCapacity() << ',' << simulation.getConfluence() << ',' << wellTicks << ','
+                   << (wellTicks >= 0 ? static_cast<float>(wellTicks) * params.cellSplitHours : -1.0f) << '\n';
+        }
+
+        std::cerr << reached << "/" << wellCount << " wells reached " << params.confluencePercent << "% confluence in "
+                  << ticks << " ticks (" << totalMs / 1000.0 << " s)" << std::endl;
+        return 0;
+    }
+
+    // Grows one colony, keeping its surface mesh current after every tick by re-meshing only the bricks that changed,
+    // and writes the final surface
+    int runSurface(const CommandLine &args) {
+        RunParameters params;
+        if (!readRunParameters(args, params) || !readPointParameters(args, params)) return 1;
+        const std::string outputPath = args.get("output", "colony_surface.obj");
+        if (!args.allUsed()) return 1;
+
+        using Clock = std::chrono::steady_clock;
+        SurfaceMesher mesher;
+        double meshMs = 0.0;
+        const RunResult result = runHeadless(params, [&](const TickSample &, const ColonySimulation &simulation) {
+            const auto start = Clock::now();
+            mesher.update(simulation.getGrid());
+            meshMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        });
+
+        std::ofstream output(outputPath);
+        if (!output) {
+            std::cerr << "Could not write " << outputPath << std::endl;
+            return 1;
+        }
+        mesher.writeObj(output);
+
+        std::cerr << result.finalCells << " cells after " << result.ticks << " ticks: " << mesher.getTriangleCount()
+                  << " surface triangles in " << mesher.getChunkCount() << " chunks (" << mesher.getRemeshedChunkCount()
+                  << " chunk re-meshes, " << meshMs << " ms) written to " << outputPath << std::endl;
+        return 0;
+    }
+
+    // Grows one colony and renders its surface every few ticks on the CPU, so frames can be recorded on machines
+    // without a display. Frames are written on a separate thread; if it falls behind, frames are dropped rather than
+    // holding up the simulation.
+    int runRender(const CommandLine &args) {
+        RunParameters params;
+        int every = 1;
+        int width = 1280;
+        int height = 720;
+        int queueCapacity = 16;
+        if (!readRunParameters(args, params) ||
+            !readPointParameters(args, params) ||
+            !args.read("every", every) ||
+            !args.read("width", width) ||
+            !args.read("height", height) ||
+            !args.read("queue", queueCapacity)) {
+            return 1;
+        }
+        if (every < 1 || width < 1 || height < 1) {
+            std::cerr << "--every, --width and --height must be positive" << std::endl;
+            return 1;
+        }
+        std::optional<CameraPath> path;
+        if (args.has("camera-path")) {
+            path = CameraPath::loadFromCsv(args.get("camera-path", ""));
+            if (!path) return 1;
+        }
+        const bool raw = args.has("raw");
+        const std::string outputPath = raw ? args.get("raw", "-") : args.get("output", "frames");
+        if (!args.allUsed()) return 1;
+
+        const std::unique_ptr<FrameEncoder> encoder = raw
+                                                          ? FrameEncoder::toRawStream(outputPath, queueCapacity)
+                                                          : FrameEncoder::toPngSequence(outputPath, queueCapacity);
+        if (!encoder) return 1;
+
+        using Clock = std::chrono::steady_clock;
+        SurfaceMesher mesher;
+        SoftwareRasterizer rasterizer(width, height);
+        std::vector<SoftwareRasterizer::Triangle> triangles;
+        // The viewer's four lights
+        const std::array<Vector3, 4> lights = {
+            Vector3{-400, 3, -400}, Vector3{400, 3, 400}, Vector3{-400, 3, 400}, Vector3{400, 3, -400}
+        };
+        double renderMs = 0.0;
+        const RunResult result = runHeadless(params, [&](const TickSample &sample, const ColonySimulation &simulation) {
+            if (sample.tick % every != 0) return;
+            const auto start = Clock::now();
+            if (!path) {
+                path = CameraPath::orbit(simulation.getBoundaryManager()->getBounds(), params.maxTicks);
+            }
+
+            mesher.update(simulation.getGrid());
+            triangles.clear();
+            mesher.forEachTriangle([&](const std::array<Vector3, 3> &corners, const Vector3 &normal,
+                                       const int neighborCount) {
+                triangles.push_back({corners, normal, NEIGHBOR_COLORS[std::min(neighborCount, 14)]});
+            });
+            rasterizer.render(path->at(static_cast<float>(sample.tick)), triangles, lights, BLACK);
+            encoder->submit({sample.tick, width, height, rasterizer.getPixels()});
+            renderMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        });
+        const bool complete = encoder->finish();
+
+        std::cerr << result.finalCells << " cells after " << result.ticks << " ticks: " << encoder->getWrittenCount()
+                  << " frames written to " << outputPath << ", " << encoder->getDroppedCount() << " dropped, "
+                  << encoder->getFailedCount() << " failed (" << renderMs << " ms rendering)" << std::endl;
+        return complete ? 0 : 2;
+    }
+
+    int runDecompose(const CommandLine &args) {
+#if defined(CELL_SIM_DECOMPOSITION)
+        RunParameters params;
+        DecompositionOptions options;
+        size_t ringKb = options.ringBytes / 1024;
+        if (!readRunParameters(args, params) ||
+            !readPointParameters(args, params) ||
+            !args.read("workers", options.workers) ||
+            !args.read("cores-per-worker", options.coresPerWorker) ||
+            !args.read("ring-kb", ringKb)) {
+            return 1;
+        }
+        options.pinWorkers = !args.has("no-pin");
+        options.ringBytes = ringKb * 1024;
+        options.coresPerWorker = std::max(1, options.coresPerWorker);
+        const bool check = args.has("check");
+        const std::string outputPath = args.get("output", "decompose_slabs.csv");
+        if (!args.allUsed()) return 1;
+
+        std::cerr << "Decomposing a " << params.lengthMm << " x " << params.widthMm << " mm colony over "
+                  << options.workers << " workers" << std::endl;
+        const DecomposedRun run = runDecomposed(params, options);
+        if (!run.completed) {
+            std::cerr << "Decomposed run failed" << std::endl;
+            return 2;
+        }
+
+        std::ofstream output(outputPath);
+        if (!output) {
+            std::cerr << "Could not write " << outputPath << std::endl;
+            return 1;
+        }
+        output << "slab,first_column,end_column,capacity,initial_cells,final_cells,compute_ms,exchange_ms\n";
+        for (size_t slab = 0; slab < run.slabs.size(); slab++) {
+            const SlabSummary &summary = run.slabs[slab];
+            output << slab << ',' << summary.columns.firstColumn << ',' << summary.columns.endColumn << ','
+                   << summary.capacity << ',' << summary.initialCells << ',' << summary.finalCells << ','
+                   << summary.computeMs << ',' << summary.exchangeMs << '\n';
+        }
+
+        const RunResult &result = run.result;
+        std::cerr << result.finalCells << " cells (" << result.finalConfluence << "% confluence) after "
+                  << result.ticks << " ticks, " << result.meanTickMs << " ms per tick, " << result.totalMs
+                  << " ms total" << std::endl;
+
+        if (check) {
+            const RunResult single = runHeadless(params);
+            const bool same = single.initialCells == result.initialCells && single.finalCells == result.finalCells &&
+                              single.capacity == result.capacity && single.ticks == result.ticks &&
+                              single.ticksToConfluence == result.ticksToConfluence;
+            std::cerr << "Undecomposed run: " << single.finalCells << " cells after " << single.ticks << " ticks, "
+                      << single.meanTickMs << " ms per tick" << (same ? " (identical)" : " (MISMATCH)") << std::endl;
+            if (!same) return 3;
+        }
+        return 0;
+#else
+        (void) args;
+        std::cerr << "Decomposed runs need fork and shared memory, which this platform lacks" << std::endl;
+        return 1;
+#endif
+    }
+}
+
+int main(const int argc, char **argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    const std::string command = argv[1];
+    const CommandLine args(argc, argv, 2);
+    if (!args.isValid()) {
+        printUsage();
+        return 1;
+    }
+
+    if (command == "sweep") {
+        return runSweep(args);
+    }
+    if (command == "ensemble") {
+        return runEnsembleCommand(args);
+    }
+    if (command == "calibrate") {
+        return runCalibrate(args);
+    }
+    if (command == "predict") {
+        return runPredict(args);
+    }
+    if (command == "plate") {
+        return runPlate(args);
+    }
+    if (command == "decompose") {
+        return runDecompose(args);
+    }
+    if (command == "surface") {
+        return runSurface(args);
+    }
+    if (command == "render") {
+        return runRender(args);
+    }
+
+    printUsage();
+    return command == "help" || command == "--help" ? 0 : 1;
+}
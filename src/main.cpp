@@ -9,6 +9,9 @@
 #include "MeshGenerator.h"
 #include "TruncatedOctahedraManager.h"
 #include "BoundaryManager.h"
+#include "ConfluencePredictor.h"
+#include "PlateSimulation.h"
+#include "Units.h"
 #define RLIGHTS_IMPLEMENTATION
 #include "rlgl.h"
 #include "rlights.h"
@@ -26,25 +29,52 @@
 #define GLSL_VERSION            100
 #endif
 
-// Constants for unit conversion
-// An octahedron is 0.0866mm wide, and in our 3D world it's 2.0f * 2.82842712475f
-constexpr float OCTAHEDRON_REAL_SIZE_MM = 0.0866f;
-constexpr float OCTAHEDRON_WORLD_SIZE = 2.0f * 2.82842712475f;
-constexpr float MM_TO_WORLD_SCALE = OCTAHEDRON_WORLD_SIZE / OCTAHEDRON_REAL_SIZE_MM;
-
-
+// Seeding spacing at which the colony is predicted to fill completionPercent of the boundary after targetSimTime hours
 float calculateOptimalSpacing(
+    const ConfluencePredictor &predictor,
     const float targetSimTime,
     const float cellSplitTime,
     const float completionPercent,
-    const float spawnChance
+    const float spawnChance,
+    const int layers
 ) {
-    const float effectiveCellSplitTime = cellSplitTime / spawnChance;
-    const float distance = (targetSimTime / effectiveCellSplitTime);
-    return std::max(OCTAHEDRON_WORLD_SIZE, distance);
+    return predictor.solveSpacing(targetSimTime, cellSplitTime, completionPercent, spawnChance, layers);
+}
+
+// A shader for one of the other draw paths, lit like the instancing shader: it needs its own copy of every light with
+// that shader's uniform locations
+struct LitShader {
+    Shader shader = {};
+    Light lights[MAX_LIGHTS] = {};
+};
+
+LitShader loadLitShader(const char *vsFileName, const char *fsFileName, const Light (&lights)[MAX_LIGHTS]) {
+    LitShader lit;
+    lit.shader = LoadShader(vsFileName, fsFileName);
+    lit.shader.locs[SHADER_LOC_VECTOR_VIEW] = GetShaderLocation(lit.shader, "viewPos");
+    constexpr float ambient[4] = {0.2f, 0.2f, 0.2f, 1.0f};
+    SetShaderValue(lit.shader, GetShaderLocation(lit.shader, "ambient"), ambient, SHADER_UNIFORM_VEC4);
+    for (int i = 0; i < MAX_LIGHTS; i++) {
+        lit.lights[i] = lights[i];
+        lit.lights[i].enabledLoc = GetShaderLocation(lit.shader, TextFormat("lights[%i].enabled", i));
+        lit.lights[i].typeLoc = GetShaderLocation(lit.shader, TextFormat("lights[%i].type", i));
+        lit.lights[i].positionLoc = GetShaderLocation(lit.shader, TextFormat("lights[%i].position", i));
+        lit.lights[i].targetLoc = GetShaderLocation(lit.shader, TextFormat("lights[%i].target", i));
+        lit.lights[i].colorLoc = GetShaderLocation(lit.shader, TextFormat("lights[%i].color", i));
+    }
+    return lit;
+}
+
+void updateLitShader(LitShader &lit, const float (&cameraPos)[3], const Light (&lights)[MAX_LIGHTS]) {
+    if (lit.shader.id == 0) return;
+    SetShaderValue(lit.shader, lit.shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
+    for (int i = 0; i < MAX_LIGHTS; i++) {
+        lit.lights[i].position = lights[i].position;
+        UpdateLightValues(lit.shader, lit.lights[i]);
+    }
 }
 
-int main() {
+int main(const int argc, char **argv) {
     constexpr int screenWidth = 800 * 2;
     constexpr int screenHeight = 450 * 2;
     InitWindow(screenWidth, screenHeight, "Stem Cell Simulator");
@@ -86,8 +116,6 @@ int main() {
     
     // Don't disable cursor for GUI interaction
     // DisableCursor();
-    rlFrustum(100000.0f, 100000.0f, 100000.0f, 100000.0f, 100000.0f, 100000.0f);
-    rlSetClipPlanes(0.1f, 10000.0f);
 
     Material material = LoadMaterialDefault();
     material.shader = shader;
@@ -102,9 +130,55 @@ int main() {
     const Model model = LoadModelFromMesh(MeshGenerator::genTruncatedOctahedron());
     model.materials[0] = material;
 
+    // Calibration tables from `cell_sim_headless calibrate`; without them spacing comes from the analytic estimate
+    ConfluencePredictor spacingPredictor;
+    spacingPredictor.loadTable("../data/confluence_table.csv");
+
     TruncatedOctahedraManager octaManager(model, material);
     auto boundaryManager = octaManager.getBoundaryManager();
 
+    // Full-detail cells are translations only, so they are drawn with one offset per instance rather than a matrix.
+    // --packed-cells draws them flat-shaded from a packed mesh: exact face normals and a third of the vertex data.
+    const bool packedCells = std::ranges::any_of(std::span(argv + 1, argv + argc), [](const char *arg) {
+        return std::string_view(arg) == "--packed-cells";
+    });
+    LitShader offsetShader = loadLitShader(
+            packedCells ? "../data/shaders/lighting_offsets_packed.vs" : "../data/shaders/lighting_offsets.vs",
+            "../data/shaders/lighting_offsets.fs", lights);
+    const Mesh packedMesh = packedCells ? MeshGenerator::genPackedTruncatedOctahedron() : Mesh{};
+    octaManager.enableOffsetInstancing(offsetShader.shader, packedCells ? &packedMesh : nullptr);
+
+    // With OpenGL 4.3 the single colony's instance list can be built on the GPU (G toggles it)
+    LitShader gpuShader;
+    constexpr const char *instanceListShader = "../data/shaders/instance_list.comp";
+    if (GpuInstancer::isSupported()) {
+        gpuShader = loadLitShader("../data/shaders/lighting_gpu_instances.vs", "../data/shaders/lighting.fs", lights);
+        octaManager.enableGpuInstancing(gpuShader.shader, instanceListShader);
+    }
+
+    // Bricks hidden behind the previous frame's cells are skipped when depth can be read back
+    octaManager.enableOcclusionCulling();
+
+    // M switches the single colony to its surface mesh, drawn with per-vertex colors; O exports that surface
+    LitShader surfaceShader = loadLitShader("../data/shaders/lighting.vs", "../data/shaders/lighting.fs", lights);
+    Material surfaceMaterial = LoadMaterialDefault();
+    surfaceMaterial.shader = surfaceShader.shader;
+    surfaceMaterial.maps[MATERIAL_MAP_DIFFUSE].color = WHITE;
+    constexpr const char *surfaceExportPath = "colony_surface.obj";
+
+    // V ray-marches the single colony's lattice instead, for colonies too large to draw cell by cell
+    LitShader volumeShader =
+            loadLitShader("../data/shaders/volume_raymarch.vs", "../data/shaders/volume_raymarch.fs", lights);
+
+    // C cycles the cross-section: off, a slab of lattice layers, then a slab facing the camera as it was when picked.
+    // Page up and down move it, [ and ] change its thickness in layers or site spacings.
+    enum class CrossSection { Off, Layers, Plane };
+    CrossSection crossSection = CrossSection::Off;
+    int sectionLayer = 0;
+    int sectionThickness = 1;
+    Vector3 sectionNormal = {0.0f, 1.0f, 0.0f};
+    float sectionOffset = 0.0f;
+
     const float LIGHT_ROTATION_SPEED = 0.5f;
 
     // Time tracking variables
@@ -112,6 +186,7 @@ int main() {
     float simulationProgress = 0.0f;
     bool freeCameraMode = false;
     int hourCount = 0;
+    int plateFormat = -1; // index into PLATE_FORMATS, -1 for a single colony
 
     // Initialize GUI values based on initial boundary size
     float worldToMm = 1.0f / MM_TO_WORLD_SCALE;
@@ -178,6 +253,89 @@ int main() {
                 sizeChanged = true;
             }
 
+            // Without a boundary the colony grows freely on an unbounded lattice
+            if (IsKeyPressed(KEY_B)) {
+                octaManager.toggleBoundaryEnabled();
+                sizeChanged = true;
+            }
+
+            static int lastBoundaryShape = guiState.boundaryShapeActive;
+            if (guiState.boundaryShapeActive != lastBoundaryShape) {
+                const BoundaryPreset previousPreset = boundaryManager->getBoundaryPreset();
+                boundaryManager->setBoundaryPreset(static_cast<BoundaryPreset>(guiState.boundaryShapeActive));
+                if (boundaryManager->getBoundaryPreset() != previousPreset) sizeChanged = true;
+            }
+            // Presets are refused once the lattice is locked, and a dropped mask makes the shape custom; show the shape
+            // actually in use
+            guiState.boundaryShapeActive = static_cast<int>(boundaryManager->getBoundaryPreset());
+            lastBoundaryShape = guiState.boundaryShapeActive;
+
+            // The selector lists the generated patterns in SeedingStrategy order, then "From file", which uses the last
+            // seed file dropped on the window
+            constexpr int seedFromFile = static_cast<int>(SeedingStrategy::DensityImage);
+            static int lastSeeding = guiState.seedingActive;
+            if (guiState.seedingActive != lastSeeding) {
+                SeedingOptions options = octaManager.getSeedingOptions();
+                if (guiState.seedingActive < seedFromFile) {
+                    options.strategy = static_cast<SeedingStrategy>(guiState.seedingActive);
+                } else if (options.pointList || options.densityMap) {
+                    options.strategy = options.pointList ? SeedingStrategy::PointList : SeedingStrategy::DensityImage;
+                } else {
+                    std::cerr << "Drop a seed CSV or density image on the window to seed from a file" << std::endl;
+                    guiState.seedingActive = lastSeeding;
+                }
+                octaManager.setSeedingOptions(std::move(options));
+                lastSeeding = guiState.seedingActive;
+            }
+
+            // Dropping a CSV of seed coordinates or a density image on the window seeds from it; any other file is
+            // read as a voxel mask and replaces the boundary
+            if (IsFileDropped()) {
+                const FilePathList droppedFiles = LoadDroppedFiles();
+                if (droppedFiles.count > 0) {
+                    const char *path = droppedFiles.paths[0];
+                    SeedingOptions options = octaManager.getSeedingOptions();
+                    bool seedFileLoaded = false;
+                    if (IsFileExtension(path, ".csv")) {
+                        if (auto list = SeedPointList::loadFromCsv(path)) {
+                            options = {SeedingStrategy::PointList, options.seedsPerCluster, options.clusterRadius,
+                                       nullptr, std::move(list)};
+                            seedFileLoaded = true;
+                        }
+                    } else if (IsFileExtension(path, ".png;.bmp;.jpg;.jpeg")) {
+                        if (auto map = SeedDensityMap::loadFromImage(path)) {
+                            options = {SeedingStrategy::DensityImage, options.seedsPerCluster, options.clusterRadius,
+                                       std::move(map), nullptr};
+                            seedFileLoaded = true;
+                        }
+                    } else if (auto mask = VoxelMaskShape::loadFromFile(path)) {
+                        boundaryManager->setCustomShape(std::move(mask));
+                        sizeChanged = true;
+                    }
+
+                    if (seedFileLoaded) {
+                        octaManager.setSeedingOptions(std::move(options));
+                        guiState.seedingActive = lastSeeding = seedFromFile;
+                    }
+                }
+                UnloadDroppedFiles(droppedFiles);
+            }
+
+            // P cycles through the plate formats and back to the single colony. The camera moves to overlook the
+            // whole plate.
+            if (IsKeyPressed(KEY_P)) {
+                plateFormat = plateFormat + 1 < static_cast<int>(PLATE_FORMATS.size()) ? plateFormat + 1 : -1;
+                octaManager.setPlateFormat(plateFormat >= 0 ? &PLATE_FORMATS[plateFormat] : nullptr);
+                if (const auto *plate = octaManager.getPlate()) {
+                    const Vector3 size = plate->getPlateSize();
+                    camera.target = Vector3{size.x / 2, 0.0f, size.z / 2};
+                    camera.position = Vector3{size.x / 2, std::max(size.x, size.z) * 0.9f, -size.z * 0.3f};
+                } else {
+                    camera.position = Vector3{-200.0f, 400.0f, -200.0f};
+                    camera.target = Vector3{200.0f, 120.0f, 200.0f};
+                }
+            }
+
             if (sizeChanged) {
                 octaManager.generateStartingPositions();
             }
@@ -196,10 +354,12 @@ int main() {
             if (paramsChanged || sizeChanged) {
                 float spawnChance = octaManager.getSpawnChance();
                 float spacing = calculateOptimalSpacing(
+                    spacingPredictor,
                     static_cast<float>(guiState.simulationTimeSpinnerValue),
                     static_cast<float>(guiState.cellSplitSpinnerValue),
-                    static_cast<float>(guiState.completedAtSpinnerValue) / 100.0f,
-                    spawnChance
+                    static_cast<float>(guiState.completedAtSpinnerValue),
+                    spawnChance,
+                    guiState.layerSpinnerValue
                 );
 
                 octaManager.setOctahedraSpacing(spacing);
@@ -218,34 +378,33 @@ int main() {
             simulationProgress = 0.0f;
             float spawnChance = octaManager.getSpawnChance();
             float spacing = calculateOptimalSpacing(
+                spacingPredictor,
                 static_cast<float>(guiState.simulationTimeSpinnerValue),
                 static_cast<float>(guiState.cellSplitSpinnerValue),
-                static_cast<float>(guiState.completedAtSpinnerValue) / 100.0f,
-                spawnChance
+                static_cast<float>(guiState.completedAtSpinnerValue),
+                spawnChance,
+                guiState.layerSpinnerValue
             );
 
             octaManager.setOctahedraSpacing(spacing);
             auto simulationTickCallback = [&]() {
                 hourCount += guiState.cellSplitSpinnerValue;
                 strcpy(guiState.progressLabelText, ("Progress: hour " + std::to_string(hourCount)).c_str());
-                size_t cellCount = octaManager.getCount();
-                float boundaryVolume = boundaryManager->getBoundaryWidth() *
-                                      boundaryManager->getBoundaryDepth() *
-                                      boundaryManager->getBoundaryHeight();
-
-                float cellVolume = OCTAHEDRON_WORLD_SIZE * OCTAHEDRON_WORLD_SIZE * OCTAHEDRON_WORLD_SIZE;
-                float maxPossibleCells = boundaryVolume / cellVolume;
-                size_t targetCellCount = maxPossibleCells * (guiState.completedAtSpinnerValue / 100.0f);
-                if (targetCellCount > 0) {
-                    simulationProgress = (static_cast<float>(cellCount) / (static_cast<float>(targetCellCount) * 2))
-                                         * (static_cast<float>(guiState.simulationTimeSpinnerValue) / 100.0f);
-                    simulationProgress = std::min(simulationProgress, 1.0f);
-                    guiState.progressBarValue = simulationProgress;
-                    if (simulationProgress >= 1.0f && simulationRunning) {
-                        simulationRunning = false;
-                        octaManager.stopGenerationThread();
-                        //strcpy(guiState.progressLabelText, "Progress: Complete!");
-                    }
+                // Progress is the filled share of the boundary's sites against the completion threshold. An unbounded
+                // colony has nothing to fill, so it runs for the simulation time instead.
+                if (octaManager.getCapacity() > 0) {
+                    simulationProgress = octaManager.getConfluence() /
+                                         static_cast<float>(guiState.completedAtSpinnerValue);
+                } else {
+                    simulationProgress = static_cast<float>(hourCount) /
+                                         static_cast<float>(guiState.simulationTimeSpinnerValue);
+                }
+                simulationProgress = std::min(simulationProgress, 1.0f);
+                guiState.progressBarValue = simulationProgress;
+                if (simulationProgress >= 1.0f && simulationRunning) {
+                    simulationRunning = false;
+                    octaManager.stopGenerationThread();
+                    //strcpy(guiState.progressLabelText, "Progress: Complete!");
                 }
             };
 
@@ -265,6 +424,64 @@ int main() {
             octaManager.resetOctahedra();
         }
 
+        if (IsKeyPressed(KEY_G) && gpuShader.shader.id != 0) {
+            if (octaManager.isGpuInstancing()) {
+                octaManager.disableGpuInstancing();
+            } else {
+                octaManager.enableGpuInstancing(gpuShader.shader, instanceListShader);
+            }
+        }
+        if (IsKeyPressed(KEY_M)) {
+            octaManager.setSurfaceRendering(octaManager.isSurfaceRendering() ? nullptr : &surfaceMaterial);
+            octaManager.disableVolumeRendering();
+        }
+        if (IsKeyPressed(KEY_V)) {
+            if (octaManager.isVolumeRendering()) {
+                octaManager.disableVolumeRendering();
+            } else {
+                octaManager.enableVolumeRendering(volumeShader.shader);
+                octaManager.setSurfaceRendering(nullptr);
+            }
+        }
+        if (IsKeyPressed(KEY_O) && octaManager.exportSurface(surfaceExportPath)) {
+            std::cerr << "Wrote the colony surface to " << surfaceExportPath << std::endl;
+        }
+
+        if (IsKeyPressed(KEY_C)) {
+            sectionThickness = 1;
+            if (crossSection == CrossSection::Off) {
+                crossSection = CrossSection::Layers;
+                const BoundingBox scene = octaManager.getSceneBounds();
+                sectionLayer = TruncatedOctahedraManager::getLayerAt((scene.min.y + scene.max.y) * 0.5f);
+            } else if (crossSection == CrossSection::Layers) {
+                crossSection = CrossSection::Plane;
+                sectionNormal = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+                sectionOffset = Vector3DotProduct(sectionNormal, camera.target);
+            } else {
+                crossSection = CrossSection::Off;
+            }
+        }
+        if (crossSection != CrossSection::Off) {
+            const int step = IsKeyPressed(KEY_PAGE_UP) ? 1 : IsKeyPressed(KEY_PAGE_DOWN) ? -1 : 0;
+            if (crossSection == CrossSection::Layers) {
+                sectionLayer += step;
+            } else {
+                sectionOffset += static_cast<float>(step) * OctahedronGrid::SQUARE_DISTANCE;
+            }
+            if (IsKeyPressed(KEY_RIGHT_BRACKET)) sectionThickness++;
+            if (IsKeyPressed(KEY_LEFT_BRACKET)) sectionThickness = std::max(1, sectionThickness - 1);
+        }
+        if (crossSection == CrossSection::Layers) {
+            const Slab slab = TruncatedOctahedraManager::getLayerSlab(sectionLayer, sectionLayer + sectionThickness - 1);
+            octaManager.setClipSlab(&slab);
+        } else if (crossSection == CrossSection::Plane) {
+            const float halfThickness = static_cast<float>(sectionThickness) * OctahedronGrid::SQUARE_DISTANCE * 0.5f;
+            const Slab slab(sectionNormal, sectionOffset - halfThickness, sectionOffset + halfThickness);
+            octaManager.setClipSlab(&slab);
+        } else {
+            octaManager.setClipSlab(nullptr);
+        }
+
         // Toggle free camera mode with Tab key
         if (IsKeyPressed(KEY_TAB)) {
             freeCameraMode = !freeCameraMode;
@@ -310,6 +527,24 @@ int main() {
         const float cameraPos[3] = {camera.position.x, camera.position.y, camera.position.z};
         SetShaderValue(shader, shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
         for (const auto &light: lights) UpdateLightValues(shader, light);
+        updateLitShader(offsetShader, cameraPos, lights);
+        updateLitShader(gpuShader, cameraPos, lights);
+        updateLitShader(surfaceShader, cameraPos, lights);
+        updateLitShader(volumeShader, cameraPos, lights);
+
+        // Keep the far plane just past the scene, however large the well, and the near plane as far out as depth
+        // precision allows for that range
+        const BoundingBox scene = octaManager.getSceneBounds();
+        float farthest = 0.0f;
+        for (const float x: {scene.min.x, scene.max.x}) {
+            for (const float y: {scene.min.y, scene.max.y}) {
+                for (const float z: {scene.min.z, scene.max.z}) {
+                    farthest = std::max(farthest, Vector3Distance(camera.position, {x, y, z}));
+                }
+            }
+        }
+        const float farPlane = std::max(1000.0f, farthest * 1.1f);
+        rlSetClipPlanes(std::max(0.1f, farPlane / 100000.0f), farPlane);
 
         BeginDrawing(); {
             ClearBackground(DARKGRAY);
@@ -329,6 +564,38 @@ int main() {
                          GetScreenWidth() - 300, 10, 16, RAYWHITE);
             }
 
+            if (!octaManager.isBoundaryEnabled()) {
+                DrawText("Boundary disabled: unbounded growth (press B to toggle)",
+                         GetScreenWidth() - 480, 100, 16, RAYWHITE);
+            }
+
+            if (octaManager.isVolumeRendering()) {
+                DrawText("Ray-marching the lattice (press V for cells)", GetScreenWidth() - 480, 160, 16, RAYWHITE);
+            } else if (octaManager.isSurfaceRendering()) {
+                DrawText(TextFormat("Surface mesh: %zu triangles (press M for cells, O to export)",
+                                    octaManager.getSurfaceTriangleCount()),
+                         GetScreenWidth() - 480, 160, 16, RAYWHITE);
+            } else if (octaManager.isGpuInstancing()) {
+                DrawText("Instances built on the GPU (press G for the CPU path)",
+                         GetScreenWidth() - 480, 160, 16, RAYWHITE);
+            }
+
+            if (crossSection == CrossSection::Layers) {
+                DrawText(TextFormat("Cross-section: layers %i-%i (PgUp/PgDn to move, [ ] thickness, C for a plane)",
+                                    sectionLayer, sectionLayer + sectionThickness - 1),
+                         GetScreenWidth() - 480, 190, 16, RAYWHITE);
+            } else if (crossSection == CrossSection::Plane) {
+                DrawText(TextFormat("Cross-section: %i sites thick facing the camera (PgUp/PgDn, [ ], C to end)",
+                                    sectionThickness),
+                         GetScreenWidth() - 480, 190, 16, RAYWHITE);
+            }
+
+            if (const auto *plate = octaManager.getPlate()) {
+                DrawText(TextFormat("%s plate: %zu wells, %.1f%% confluent (press P to change)",
+                                    plate->getFormat().name, plate->getWellCount(), plate->getConfluence()),
+                         GetScreenWidth() - 480, 130, 16, RAYWHITE);
+            }
+
             DrawText(TextFormat("Cells: %zu", octaManager.getCount() * 26), //each octahedron has is 15 cells
                      GetScreenWidth() - 200, 40, 20, RAYWHITE);
             DrawText(TextFormat("Octahedra: %zu", octaManager.getCount()),
@@ -337,6 +604,14 @@ int main() {
         EndDrawing();
     }
 
+    // Their buffers belong to the GL context
+    octaManager.releaseGraphics();
+    UnloadShader(offsetShader.shader);
+    if (packedCells) UnloadMesh(packedMesh);
+    if (gpuShader.shader.id != 0) UnloadShader(gpuShader.shader);
+    UnloadShader(surfaceShader.shader);
+    UnloadShader(volumeShader.shader);
+
     CloseWindow();
     return 0;
 }